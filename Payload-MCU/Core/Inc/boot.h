@@ -0,0 +1,65 @@
+/*
+ * boot.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Records how long each stage of bringing up the payload takes.
+ */
+
+#ifndef INC_BOOT_H_
+#define INC_BOOT_H_
+
+#include <stdint.h>
+
+typedef enum {
+	BOOT_STAGE_CAN = 0,      // CAN wrapper. first, so the node answers quickly.
+	BOOT_STAGE_TIMERS,       // telemetry timer configuration.
+	BOOT_STAGE_WARM_STATE,   // configuration restored from before a reset.
+	BOOT_STAGE_I2C,          // I2C peripheral.
+	BOOT_STAGE_EXPANDERS,    // IO expanders and the outputs behind them.
+	BOOT_STAGE_I2C_SPEED,    // I2C speed self-test.
+	BOOT_STAGE_TELEMETRY,    // telemetry timer started.
+	BOOT_STAGE_ADC,          // on-board ADC. brought up on first use.
+	BOOT_STAGE_SELF_TEST,    // sensor math kernels checked against their reference.
+	NUM_BOOT_STAGES
+} BootStageID;
+
+typedef enum {
+	BOOT_STAGE_PENDING = 0,  // not started yet.
+	BOOT_STAGE_RUNNING,
+	BOOT_STAGE_OK,
+	BOOT_STAGE_FAILED,
+	BOOT_STAGE_DEFERRED      // will be retried later.
+} BootStageStatus;
+
+typedef struct
+{
+	uint32_t start;    // microseconds since boot, on the local clock.
+	uint32_t end;      // microseconds since boot, on the local clock.
+	uint8_t status;    // see BootStageStatus.
+	uint8_t attempts;
+} BootStageRecord;
+
+/**
+ * @brief Marks the start of an attempt at a boot stage.
+ */
+void Boot_Stage_Begin(BootStageID stage);
+
+/**
+ * @brief Marks the end of an attempt at a boot stage.
+ */
+void Boot_Stage_End(BootStageID stage, BootStageStatus status);
+
+/**
+ * @brief Gets the timeline of boot stages.
+ *
+ * @return Array of NUM_BOOT_STAGES records, indexed by BootStageID.
+ */
+const BootStageRecord *Boot_Get_Timeline();
+
+/**
+ * @brief Prints the timeline of boot stages.
+ */
+void Boot_Print_Timeline();
+
+#endif /* INC_BOOT_H_ */
@@ -0,0 +1,87 @@
+/*
+ * bulk.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Moves blocks of data larger than a CAN frame to CDH, e.g. burst
+ *           captures and flash logs.
+ *
+ *  A transfer is sent as the following frames. Byte 0 of each is the
+ *  transfer id, whose upper nibble is the BulkSource and lower nibble a serial.
+ *
+ *  CMD_CDH_PROCESS_BULK_START
+ *  	bytes 1-4	size of the block in bytes, uint32_t.
+ *
+ *  CMD_CDH_PROCESS_BULK_DATA, laid out like a telemetry report:
+ *  	bytes 1-2	packet #, uint16_t.
+ *  	bytes 3-6	the BULK_PACKET_SIZE bytes at packet # * BULK_PACKET_SIZE,
+ *  				zero padded past the end of the block.
+ *
+ *  CMD_CDH_PROCESS_BULK_END, sent as packet # (number of data packets)
+ *  	bytes 1-4	CRC-32 of the block, uint32_t. see CRC_Compute.
+ *
+ *  CDH answers with CMD_PLD_BULK_ACK:
+ *  	bytes 1-2	the first packet # not yet received.
+ *  	bytes 3-6	bit n asks for packet (bytes 1-2) + n to be resent.
+ *
+ *  At most BULK_WINDOW packets past the first unacknowledged one are in
+ *  flight. If no new packet is acknowledged in time, sending restarts from
+ *  the first unacknowledged packet. The transfer is complete once the end frame
+ *  is acknowledged.
+ */
+
+#ifndef INC_BULK_H_
+#define INC_BULK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BULK_PACKET_SIZE 4
+#define BULK_WINDOW 32
+// the end frame is acknowledged by asking for the packet after it, which
+// must still fit the 16 bit packet # of CMD_PLD_BULK_ACK.
+#define BULK_MAX_SIZE ((UINT16_MAX - 1) * BULK_PACKET_SIZE)
+
+typedef enum {
+	BULK_SOURCE_NONE = 0,
+	BULK_SOURCE_BURST,
+	BULK_SOURCE_LOG
+} BulkSource;
+
+/**
+ * @brief Starts sending a block. Cancels the transfer in progress, if any.
+ *
+ * The block is read while it is sent, so it must stay unchanged until the
+ * transfer is complete or cancelled.
+ *
+ * @param source	What the block holds.
+ * @param data		The block. May be in flash.
+ * @param size		The size of the block in bytes. At most BULK_MAX_SIZE.
+ * @return			true on success. false if the arguments are invalid.
+ */
+bool Bulk_Start(BulkSource source, const void *data, uint32_t size);
+
+/**
+ * @brief Sends the next frames of the transfer, and resends any that were
+ *        lost. Call from the main loop.
+ */
+void Bulk_Update();
+
+/**
+ * @brief Handles a CMD_PLD_BULK_ACK from CDH.
+ */
+void Bulk_On_Ack(uint8_t transfer_id, uint16_t next_packet, uint32_t resend);
+
+/**
+ * @brief Stops the transfer in progress if it is from the given source.
+ */
+void Bulk_Cancel(BulkSource source);
+
+/**
+ * @brief Gets the source of the transfer in progress.
+ *
+ * @return The source, or BULK_SOURCE_NONE when idle.
+ */
+BulkSource Bulk_Get_Source();
+
+#endif /* INC_BULK_H_ */
@@ -0,0 +1,74 @@
+/*
+ * crc.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: CRC-32 (IEEE 802.3) of buffers in RAM or flash.
+ *
+ *  The CRC peripheral is used once CRC_Init has checked it against the
+ *  software implementation. Large buffers can be fed to it by DMA while the
+ *  CPU does other work. Building with CRC_USE_HARDWARE set to 0, e.g. for a
+ *  host build, leaves only the software implementation.
+ */
+
+#ifndef INC_CRC_H_
+#define INC_CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifndef CRC_USE_HARDWARE
+#define CRC_USE_HARDWARE 1
+#endif
+
+/**
+ * @brief Enables the CRC peripheral if it matches the software CRC on a set
+ *        of test buffers, and prints how fast each is.
+ *
+ * CRCs computed before this, or if the check fails, use software.
+ *
+ * @return true if the peripheral is in use. false otherwise.
+ */
+bool CRC_Init();
+
+/**
+ * @brief Computes the CRC-32 (IEEE 802.3) of a buffer.
+ *
+ * Uses the CRC peripheral, unless it is unavailable or busy with a DMA
+ * computation.
+ *
+ * @param data	The data to checksum.
+ * @param size	The number of bytes to checksum.
+ * @return		The CRC.
+ */
+uint32_t CRC_Compute(const void *data, size_t size);
+
+/**
+ * @brief Computes the CRC-32 of a buffer in software only.
+ */
+uint32_t CRC_Compute_Software(const void *data, size_t size);
+
+/**
+ * @brief Starts computing the CRC of a buffer with the CRC peripheral, fed
+ *        by DMA. The buffer must stay unchanged until the CRC is collected.
+ *
+ * @return true on success. false if the peripheral is unavailable or busy.
+ */
+bool CRC_Start(const void *data, size_t size);
+
+/**
+ * @brief Collects the CRC started by CRC_Start once it is ready.
+ *
+ * @param out	Where to store the CRC.
+ * @return		true if the CRC was stored. false if it is still running, or
+ * 				nothing was started.
+ */
+bool CRC_Poll(uint32_t *out);
+
+/**
+ * @brief Stops the CRC started by CRC_Start, if any, without collecting it.
+ */
+void CRC_Abort();
+
+#endif /* INC_CRC_H_ */
@@ -0,0 +1,81 @@
+/*
+ * error_log.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Counts runtime errors and reports them to CDH without flooding
+ *           the bus.
+ *
+ *  Recording an error only bumps its counter, so it is cheap and safe from
+ *  interrupts. Repeats of an error are coalesced into one report with a
+ *  count and the times of the first and last occurrence. Reports are sent
+ *  from the main loop, at most once per second for each error and a few per
+ *  second overall.
+ *
+ *  Each report is a CMD_CDH_PROCESS_RUNTIME_ERROR frame: byte 0 is the
+ *  ErrorID, bytes 1-2 the occurrences since the last report, and bytes 3-4
+ *  and 5-6 the ms since the first and last of them.
+ */
+
+#ifndef INC_ERROR_LOG_H_
+#define INC_ERROR_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+	ERROR_CAN_WRAPPER_INIT = 0,
+	ERROR_CAN_TRANSMIT,
+	ERROR_UNKNOWN_COMMAND,           // arg: the command.
+	ERROR_I2C_TRANSFER,              // arg: I2C error << 16 | segment << 8 | address.
+	ERROR_I2C_BUS_STUCK,
+	ERROR_INVALID_WELL_ID,           // arg: the well.
+	ERROR_TCA9539_INIT,
+	ERROR_TCA9539_INVALID_EXPANDER,  // arg: the expander.
+	ERROR_TCA9539_INVALID_PIN,       // arg: the pin.
+	ERROR_TCA9539_TRANSFER,          // arg: device << 8 | port.
+	ERROR_TCA9539_SET_PIN,           // arg: the well, or the bitmap of wells.
+	ERROR_TCA9548_INVALID_CHANNEL,   // arg: the channel or mask.
+	ERROR_TCA9548_SET_CHANNEL,       // arg: the mask.
+	ERROR_SENSOR_READ,               // arg: type << 8 | well.
+	ERROR_SENSOR_IMPLAUSIBLE,        // arg: type << 8 | well.
+	ERROR_SENSOR_QUARANTINED,        // arg: type << 8 | well.
+	ERROR_HEATER_HELD,               // arg: the bitmap of wells held off.
+	ERROR_ADC_CALIBRATION,           // arg: HAL status.
+	ERROR_ADC_START,                 // arg: HAL status.
+	ERROR_ADC_POLL,                  // arg: HAL status.
+	ERROR_ADC_GET_VALUE,             // arg: HAL status.
+	ERROR_FLASH_WRITE,
+	ERROR_FLASH_LOG_WRITE,           // arg: records lost.
+	ERROR_BULK_TIMEOUT,              // arg: the transfer id.
+	ERROR_STACK_LOW,                 // arg: bytes left.
+	ERROR_FAULT,                     // arg: the FaultType.
+	ERROR_INVALID_ARGUMENT,          // arg: the command.
+	ERROR_SELF_TEST,
+	NUM_ERRORS
+} ErrorID;
+
+/**
+ * @brief Records an error. Safe to call from interrupts.
+ *
+ * @param arg	Detail kept for the last occurrence. see ErrorID.
+ */
+void Error_Log_Put(ErrorID id, uint32_t arg);
+
+/**
+ * @brief Reports errors recorded since they were last reported, as far as
+ *        the rate limits allow. Called from the main loop.
+ */
+void Error_Log_Update();
+
+/**
+ * @brief Gets how many times an error occurred since boot.
+ */
+uint32_t Error_Log_Get_Count(ErrorID id);
+
+/**
+ * @brief Prints how many times each error occurred since boot.
+ */
+void Error_Log_Print();
+
+#endif /* INC_ERROR_LOG_H_ */
@@ -0,0 +1,80 @@
+/*
+ * fault.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Records the state of the CPU when a fault occurs, so resets in the
+ *           field can be diagnosed without a debugger.
+ *
+ *  The fault handlers save the stacked registers, the fault status registers
+ *  and a backtrace to a checksummed record in RAM that survives the reset,
+ *  then reset straight away rather than waiting for the watchdog. The record
+ *  is reported on the next boot.
+ */
+
+#ifndef INC_FAULT_H_
+#define INC_FAULT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FAULT_BACKTRACE_DEPTH 8
+
+typedef enum {
+	FAULT_NONE = 0,
+	FAULT_HARD,
+	FAULT_MEM_MANAGE,
+	FAULT_BUS,
+	FAULT_USAGE,
+	FAULT_ERROR_HANDLER // Error_Handler was called.
+} FaultType;
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t type;       // a FaultType.
+	uint32_t r0;         // registers stacked on exception entry.
+	uint32_t r1;
+	uint32_t r2;
+	uint32_t r3;
+	uint32_t r12;
+	uint32_t lr;
+	uint32_t pc;
+	uint32_t xpsr;
+	uint32_t sp;         // stack pointer before the exception.
+	uint32_t exc_return;
+	uint32_t cfsr;       // configurable fault status.
+	uint32_t hfsr;       // hard fault status.
+	uint32_t mmfar;      // memory management fault address.
+	uint32_t bfar;       // bus fault address.
+	uint32_t uptime;     // HAL tick when the fault occurred.
+	uint32_t backtrace[FAULT_BACKTRACE_DEPTH]; // likely return addresses, innermost first. 0 if unused.
+	uint32_t crc;        // covers everything above.
+} FaultRecord;
+
+/**
+ * @brief Enables the memory management, bus and usage fault handlers, so
+ *        those faults are recorded as such rather than as hard faults.
+ */
+void Fault_Init();
+
+/**
+ * @brief Reports the record of a fault before the last reset, if there is one,
+ *        over CAN and to the flash log. Each record is only reported once.
+ *
+ * Needs CAN, the CRC and the flash log to be initialised.
+ *
+ * @return true if a fault was reported. false otherwise.
+ */
+bool Fault_Report();
+
+/**
+ * @brief Records a call to Error_Handler, then resets.
+ *
+ * @param caller	Where Error_Handler was called from. Taken with
+ * 					__builtin_return_address(0) in Error_Handler itself, as
+ * 					in here it would only point back into Error_Handler.
+ */
+void Fault_Capture_Error(uint32_t caller) __attribute__((noreturn));
+
+#endif /* INC_FAULT_H_ */
@@ -0,0 +1,115 @@
+/*
+ * i2c_bus.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Shared access to I2C1 that keeps a dead device or a stuck bus from
+ *           stalling everything else on it.
+ *
+ *  Every transfer is timed. The timeout of each transfer is derived from the
+ *  latency seen so far for that device, so a hung slave costs a few ms rather
+ *  than 100. Devices that keep failing are quarantined for an exponentially
+ *  growing period, and a bus held low is cleared by clocking out the slave
+ *  that holds it.
+ */
+
+#ifndef INC_I2C_BUS_H_
+#define INC_I2C_BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// segment of devices not behind the multiplexer.
+#define I2C_SEGMENT_ROOT 0xFF
+
+typedef enum {
+	I2C_SPEED_STANDARD = 0, // 100 kHz.
+	I2C_SPEED_FAST,         // 400 kHz.
+	I2C_SPEED_FAST_PLUS,    // 1 MHz.
+	NUM_I2C_SPEEDS
+} I2CSpeed;
+
+/*
+ * Devices are identified by the multiplexer channel they are behind, or
+ * I2C_SEGMENT_ROOT, and their 7-bit address. The same address can be used
+ * by different devices on different segments.
+ *
+ * None of these select the multiplexer channel. That is up to the caller.
+ */
+
+/**
+ * @brief Writes to a device.
+ *
+ * @return true on success. false on error, or if the device is quarantined.
+ */
+bool I2C_Bus_Transmit(uint8_t segment, uint8_t address, const uint8_t *data, uint16_t size);
+
+/**
+ * @brief Reads from a device.
+ *
+ * @return true on success. false on error, or if the device is quarantined.
+ */
+bool I2C_Bus_Receive(uint8_t segment, uint8_t address, uint8_t *data, uint16_t size);
+
+/**
+ * @brief Checks whether a device acknowledges its address.
+ *
+ * @return true if the device responded. false otherwise.
+ */
+bool I2C_Bus_Probe(uint8_t segment, uint8_t address);
+
+/**
+ * @brief Checks whether a device is currently being skipped.
+ */
+bool I2C_Bus_Is_Quarantined(uint8_t segment, uint8_t address);
+
+/**
+ * @brief Sets the speed used for the devices on a segment.
+ *
+ * Timings are computed for the current I2C1 kernel clock, and the bus is
+ * retimed whenever consecutive transfers are on segments at different speeds.
+ * Transfers to the multiplexer itself use the root segment's speed.
+ *
+ * @return true on success. false if the segment is invalid.
+ */
+bool I2C_Bus_Set_Speed(uint8_t segment, I2CSpeed speed);
+
+/**
+ * @brief Gets the speed used for the devices on a segment.
+ */
+I2CSpeed I2C_Bus_Get_Speed(uint8_t segment);
+
+/**
+ * @brief Gets the SCL frequency of a speed, in Hz.
+ */
+uint32_t I2C_Bus_Get_Frequency(I2CSpeed speed);
+
+/**
+ * @brief Forgets the latency and failures of every device, e.g. after a speed
+ *        change or a test that was expected to fail.
+ */
+void I2C_Bus_Reset_Health();
+
+/**
+ * @brief Counts bus faults (timeouts, bus errors, arbitration loss and
+ *        recoveries), after which the state of devices on the bus is uncertain.
+ *
+ * Drivers that cache device state can compare this to detect faults.
+ */
+uint32_t I2C_Bus_Get_Fault_Count();
+
+/**
+ * @brief Frees the bus from a slave holding SDA low, then re-initialises I2C1.
+ *
+ * Called automatically when a failed transfer leaves the bus busy.
+ *
+ * @return true if the bus is free afterwards. false otherwise.
+ */
+bool I2C_Bus_Recover();
+
+/**
+ * @brief Prints the latency, timeout and failure count of every known device.
+ */
+void I2C_Bus_Print_Health();
+
+#endif /* INC_I2C_BUS_H_ */
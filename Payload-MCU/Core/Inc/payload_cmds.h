@@ -0,0 +1,42 @@
+/*
+ * payload_cmds.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Command IDs used by the payload that aren't in can-wrapper-module
+ *           yet.
+ *
+ *  CDH must use the same values. Once the IDs land in the submodule and its
+ *  gitlink is bumped, delete this file: each define here then clashes with
+ *  the submodule's enum of the same name, so a stale copy won't compile.
+ */
+
+#ifndef INC_PAYLOAD_CMDS_H_
+#define INC_PAYLOAD_CMDS_H_
+
+// commands to the payload.
+#define CMD_PLD_SET_LED_PROGRAM       0xA0
+#define CMD_PLD_SET_HEATER_BUDGET     0xA1
+#define CMD_PLD_SET_WELL_PRIORITY     0xA2
+#define CMD_PLD_SET_CALIBRATION       0xA3
+#define CMD_PLD_SET_CALIBRATION_POINT 0xA4
+#define CMD_PLD_SYNC_TIME             0xA5
+#define CMD_PLD_START_BURST           0xA6
+#define CMD_PLD_BULK_ACK              0xA7
+#define CMD_PLD_DOWNLINK_LOG          0xA8
+#define CMD_PLD_GET_STACK_USAGE       0xA9
+#define CMD_PLD_GET_BOOT_TIMELINE     0xAA
+#define CMD_PLD_PRINT_DEBUG_INFO      0xAB
+
+// reports to CDH.
+#define CMD_CDH_PROCESS_HEATER_BUDGET 0xB0
+#define CMD_CDH_PROCESS_SENSOR_HEALTH 0xB1
+#define CMD_CDH_PROCESS_FAULT_REPORT  0xB2
+#define CMD_CDH_PROCESS_STACK_USAGE   0xB3
+#define CMD_CDH_PROCESS_BOOT_TIMELINE 0xB4
+#define CMD_CDH_PROCESS_BURST_INFO    0xB5
+#define CMD_CDH_PROCESS_BULK_START    0xB6
+#define CMD_CDH_PROCESS_BULK_DATA     0xB7
+#define CMD_CDH_PROCESS_BULK_END      0xB8
+
+#endif /* INC_PAYLOAD_CMDS_H_ */
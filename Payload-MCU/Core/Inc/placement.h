@@ -0,0 +1,23 @@
+/*
+ * placement.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Places variables in the memory sections set up by the linker
+ *           script.
+ *
+ *  Main RAM is for state used on hot paths. Large buffers go in RAM2, in the
+ *  section of their subsystem, which the linker script holds to a budget.
+ */
+
+#ifndef INC_PLACEMENT_H_
+#define INC_PLACEMENT_H_
+
+// zeroed at startup, in RAM2. subsystem is one of burst, log or trace, or
+// anything else for the shared "other" budget. must not have an initialiser.
+#define RAM2_BSS(subsystem) __attribute__((section(".ram2_bss." #subsystem)))
+
+// left untouched by the startup code, so it survives resets.
+#define NOINIT __attribute__((section(".noinit")))
+
+#endif /* INC_PLACEMENT_H_ */
@@ -0,0 +1,39 @@
+/*
+ * profile.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Cycle-accurate timing of short code paths with the DWT cycle
+ *           counter.
+ */
+
+#ifndef INC_PROFILE_H_
+#define INC_PROFILE_H_
+
+#include "main.h"
+
+#include <stdint.h>
+
+/**
+ * @brief Starts the DWT cycle counter if it is not running already.
+ */
+static inline void Profile_Init()
+{
+	if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+	{
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+}
+
+/**
+ * @brief Gets the CPU cycle count. Wraps every ~53 s at 80 MHz, so only the
+ *        difference of two counts is meaningful.
+ */
+static inline uint32_t Profile_Cycles()
+{
+	return DWT->CYCCNT;
+}
+
+#endif /* INC_PROFILE_H_ */
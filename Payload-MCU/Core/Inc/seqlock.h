@@ -0,0 +1,98 @@
+/*
+ * seqlock.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Publishes a value from one context to readers in others without
+ *           disabling interrupts.
+ *
+ *  The value is kept twice, and a sequence number says which copy readers
+ *  should take. The writer steers readers to the second copy while it
+ *  updates the first, then back to the first while it updates the second.
+ *  A reader copies out the copy it was steered to, and reads again if the
+ *  sequence number moved in the meantime, as that copy may then have been
+ *  written under it.
+ *
+ *  So a reader never waits on the writer. A reader that interrupts a write
+ *  takes the copy that isn't being written, and gets it on the first try. A
+ *  reader that is interrupted by a write reads again once the write is done.
+ *
+ *  There must only be one writer at a time: a single ISR, or the main loop
+ *  with no ISR writing.
+ */
+
+#ifndef INC_SEQLOCK_H_
+#define INC_SEQLOCK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef struct
+{
+	volatile uint32_t sequence; // bit 0 is the copy readers should take.
+} Seqlock;
+
+// a dmb on the Cortex-M4, and whatever the host needs in tests.
+#define SEQLOCK_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+// two copies of a value of the given type, behind a seqlock. zero
+// initialised, both copies hold the same value.
+#define SEQLOCK(type) struct { Seqlock lock; type copies[2]; }
+
+#define SEQLOCK_WRITE(shared, value) \
+	Seqlock_Write(&(shared)->lock, (shared)->copies, (value), sizeof((shared)->copies[0]))
+
+#define SEQLOCK_READ(shared, out) \
+	Seqlock_Read(&(shared)->lock, (shared)->copies, (out), sizeof((shared)->copies[0]))
+
+/**
+ * @brief Updates both copies of a value.
+ *
+ * @param copies	The two copies, one after the other.
+ * @param size		Of one copy.
+ */
+static inline void Seqlock_Write(Seqlock *lock, void *copies, const void *value, size_t size)
+{
+	uint8_t *bytes = copies;
+	uint32_t sequence = lock->sequence & ~1u;
+
+	// the barriers keep the copies from being written outside their window.
+	lock->sequence = sequence + 1;
+	SEQLOCK_BARRIER();
+	memcpy(&bytes[0], value, size);
+	SEQLOCK_BARRIER();
+	lock->sequence = sequence + 2;
+	SEQLOCK_BARRIER();
+	memcpy(&bytes[size], value, size);
+	SEQLOCK_BARRIER();
+}
+
+/**
+ * @brief Copies out a value, consistent with a single write.
+ *
+ * @param copies	The two copies, one after the other.
+ * @param size		Of one copy.
+ * @return			Number of retries, for profiling. 0 unless a write
+ *					interrupted the read.
+ */
+static inline uint32_t Seqlock_Read(const Seqlock *lock, const void *copies, void *out, size_t size)
+{
+	const uint8_t *bytes = copies;
+	uint32_t retries = 0;
+
+	while (1)
+	{
+		uint32_t sequence = lock->sequence;
+		SEQLOCK_BARRIER();
+		memcpy(out, &bytes[(sequence & 1) * size], size);
+		SEQLOCK_BARRIER();
+
+		if (lock->sequence == sequence)
+			return retries;
+
+		retries++;
+	}
+}
+
+#endif /* INC_SEQLOCK_H_ */
@@ -0,0 +1,149 @@
+/*
+ * spsc_ring.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Lock-free queue from one producer to one consumer, e.g. from an
+ *           ISR to the main loop.
+ *
+ *  The producer only writes the head and the consumer only writes the tail,
+ *  so neither has to disable interrupts. Both are free-running counts, and
+ *  the capacity is a power of two, so an index is the count masked and the
+ *  fill level is their difference, even across a wrap.
+ *
+ *  Each side publishes its count with a release store and reads the other's
+ *  with an acquire load, so the elements are written before the consumer
+ *  sees them, and read before the producer can overwrite them. On the
+ *  Cortex-M4 each is a dmb next to the access.
+ *
+ *  Declare a ring with SPSC_RING, and use the SPSC_RING_ macros on it. A
+ *  zero initialised ring is empty, so static rings need no setup.
+ */
+
+#ifndef INC_SPSC_RING_H_
+#define INC_SPSC_RING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// the Cortex-M4 has no data cache, so there is nothing to gain by padding the
+// producer's and consumer's fields apart. a build for a cached core can set
+// its line size instead.
+#ifndef SPSC_RING_LINE_SIZE
+#define SPSC_RING_LINE_SIZE 4
+#endif
+
+#define SPSC_RING_ALIGNED __attribute__((aligned(SPSC_RING_LINE_SIZE)))
+
+typedef struct
+{
+	// written by the producer only.
+	SPSC_RING_ALIGNED uint32_t head;          // elements pushed so far.
+	uint32_t high_water;                      // highest fill level so far.
+	uint32_t dropped;                         // elements refused because the ring was full.
+
+	// written by the consumer only.
+	SPSC_RING_ALIGNED uint32_t tail;          // elements popped so far.
+} SpscRing;
+
+// a ring of elements of the given type. fails to compile unless capacity is
+// a power of two.
+#define SPSC_RING(type, capacity) struct { \
+	SpscRing ring; \
+	SPSC_RING_ALIGNED type elements[capacity]; \
+	unsigned : (((capacity) & ((capacity) - 1)) == 0 ? 0 : -1); }
+
+#define SPSC_RING_CAPACITY(shared) (sizeof((shared)->elements) / sizeof((shared)->elements[0]))
+
+// fails to compile unless pointer points to the ring's element type.
+#define SPSC_RING_CHECK_TYPE(shared, pointer) ((void)sizeof(struct { char c; \
+	unsigned : __builtin_types_compatible_p(__typeof__(*(pointer)), __typeof__((shared)->elements[0])) ? 0 : -1; }))
+
+#define SPSC_RING_PUSH(shared, items, count) \
+	(SPSC_RING_CHECK_TYPE(shared, items), \
+	Spsc_Ring_Push(&(shared)->ring, (shared)->elements, sizeof((shared)->elements[0]), \
+			SPSC_RING_CAPACITY(shared), (items), (count)))
+
+#define SPSC_RING_POP(shared, out, max) \
+	(SPSC_RING_CHECK_TYPE(shared, out), \
+	Spsc_Ring_Pop(&(shared)->ring, (shared)->elements, sizeof((shared)->elements[0]), \
+			SPSC_RING_CAPACITY(shared), (out), (max)))
+
+#define SPSC_RING_COUNT(shared) Spsc_Ring_Count(&(shared)->ring)
+
+/**
+ * @brief Appends elements, as many as fit. Producer only.
+ *
+ * @param elements	The ring's storage.
+ * @param size		Of one element.
+ * @param capacity	Of the ring, in elements. A power of two.
+ * @return			Number of elements pushed. Those that didn't fit are
+ *					counted as dropped.
+ */
+static inline uint32_t Spsc_Ring_Push(SpscRing *ring, void *elements, size_t size, uint32_t capacity,
+		const void *items, uint32_t count)
+{
+	uint32_t head = ring->head;
+	uint32_t used = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if (count > capacity - used)
+	{
+		ring->dropped += count - (capacity - used);
+		count = capacity - used;
+	}
+
+	// in up to two pieces, either side of the end of the storage.
+	uint32_t start = head & (capacity - 1);
+	uint32_t first = count < capacity - start ? count : capacity - start;
+	memcpy((uint8_t *)elements + start * size, items, first * size);
+	memcpy(elements, (const uint8_t *)items + first * size, (count - first) * size);
+
+	// the elements must be written before the consumer can see them.
+	__atomic_store_n(&ring->head, head + count, __ATOMIC_RELEASE);
+
+	if (used + count > ring->high_water)
+		ring->high_water = used + count;
+
+	return count;
+}
+
+/**
+ * @brief Removes the oldest elements, up to max. Consumer only.
+ *
+ * @param elements	The ring's storage.
+ * @param size		Of one element.
+ * @param capacity	Of the ring, in elements. A power of two.
+ * @return			Number of elements popped.
+ */
+static inline uint32_t Spsc_Ring_Pop(SpscRing *ring, const void *elements, size_t size, uint32_t capacity,
+		void *out, uint32_t max)
+{
+	// only read the elements once the head says they are there.
+	uint32_t tail = ring->tail;
+	uint32_t count = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+
+	if (count > max)
+		count = max;
+
+	uint32_t start = tail & (capacity - 1);
+	uint32_t first = count < capacity - start ? count : capacity - start;
+	memcpy(out, (const uint8_t *)elements + start * size, first * size);
+	memcpy((uint8_t *)out + first * size, elements, (count - first) * size);
+
+	// the elements must be read before the producer can overwrite them.
+	__atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+
+	return count;
+}
+
+/**
+ * @brief Gets the number of elements waiting. Exact from the consumer; from
+ *        the producer, the consumer may have popped some since.
+ */
+static inline uint32_t Spsc_Ring_Count(const SpscRing *ring)
+{
+	return __atomic_load_n(&ring->head, __ATOMIC_RELAXED) - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+}
+
+#endif /* INC_SPSC_RING_H_ */
@@ -0,0 +1,68 @@
+/*
+ * stack_monitor.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Measures how much of the stack is used, to catch an overflow
+ *           before it shows up as random resets.
+ *
+ *  The stack reservation is painted with a known pattern at boot. The deepest
+ *  point the stack has reached is where the paint stops. Interrupt handlers
+ *  also record how deep the stack was when they were entered.
+ */
+
+#ifndef INC_STACK_MONITOR_H_
+#define INC_STACK_MONITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+	STACK_ISR_SYSTICK = 0,
+	STACK_ISR_CAN1_RX0,
+	STACK_ISR_TIM2,
+	NUM_STACK_ISRS
+} StackISR;
+
+/**
+ * @brief Paints the unused part of the stack reservation. Call as early as
+ *        possible.
+ */
+void Stack_Monitor_Init();
+
+/**
+ * @brief Records the stack depth on entry to an interrupt handler. Call
+ *        first thing in the handler.
+ */
+void Stack_Monitor_Sample(StackISR isr);
+
+/**
+ * @brief Finds the deepest point the stack has reached, and reports an error
+ *        the first time it gets close to the end of the reservation.
+ *
+ * @return true if the stack has stayed within its reservation. false otherwise.
+ */
+bool Stack_Monitor_Check();
+
+/**
+ * @brief Gets the most stack used so far, in bytes, as of the last check.
+ */
+uint32_t Stack_Monitor_Get_Peak();
+
+/**
+ * @brief Gets the size of the stack reservation, in bytes.
+ */
+uint32_t Stack_Monitor_Get_Size();
+
+/**
+ * @brief Gets the deepest the stack was on entry to an interrupt handler,
+ *        in bytes.
+ */
+uint32_t Stack_Monitor_Get_ISR_Peak(StackISR isr);
+
+/**
+ * @brief Prints the stack use overall and on entry to each handler.
+ */
+void Stack_Monitor_Print();
+
+#endif /* INC_STACK_MONITOR_H_ */
@@ -0,0 +1,67 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Encodes sensor snapshots into telemetry report frames.
+ *
+ *  Each report carries the time its sweep started, so CDH can tell when a
+ *  reading was taken rather than when it arrived.
+ *
+ *  Each sensor has a frame slot whose command, telemetry key and packet #
+ *  are filled in once at initialisation. Encoding a snapshot only writes the
+ *  sequence number and reading of each valid sensor into its slot, so no
+ *  message is built or copied per reading.
+ *
+ *  Each type's readings are followed by a CMD_CDH_PROCESS_SENSOR_HEALTH
+ *  frame: byte 0 is the SensorType, bytes 1-2 the bitmap of quarantined
+ *  wells, bytes 3-4 the bitmap of suspect wells and bytes 5-6 the stamp.
+ *  Quarantined sensors send no readings, so this is how CDH can tell a dead
+ *  sensor from a lost frame.
+ *
+ *  The report ends with a CMD_CDH_PROCESS_HEATER_BUDGET frame covering the
+ *  time since the last one: byte 0 is the average heater power as a
+ *  percentage of the budget, byte 1 the most heaters on at once, byte 2 the
+ *  heaters the budget allows, bytes 3-4 the bitmap of wells whose heater was
+ *  held off and bytes 5-6 the stamp.
+ */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include "sensors.h"
+#include "tuk/tuk.h"
+
+#include <stdint.h>
+
+#define TELEMETRY_MAX_FRAMES (NUM_SENSOR_TYPES * (16 + 1) + 1)
+
+/**
+ * @brief Fills in the fixed fields of every frame slot.
+ */
+void Telemetry_Init();
+
+/**
+ * @brief Encodes the valid readings of a snapshot, thermistors first, each
+ *        type in well order and followed by its health frame, then the
+ *        heater budget frame.
+ *
+ * The frames stay valid until the next call. They are not copied, so they
+ * must be handed to the CAN wrapper before then.
+ *
+ * @param snapshot	The readings to encode.
+ * @param sequences	The next sequence number of each sensor type. Advanced by
+ * 					one per frame of that type.
+ * @param frames	Where to store pointers to the encoded frames, in order.
+ * @return			The number of frames encoded.
+ */
+uint32_t Telemetry_Encode(const SensorSnapshot *snapshot, uint8_t sequences[NUM_SENSOR_TYPES],
+		CANMessage *frames[TELEMETRY_MAX_FRAMES]);
+
+/**
+ * @brief Prints how long encoding took, in CPU cycles, and how old the
+ *        readings were once encoded.
+ */
+void Telemetry_Print_Stats();
+
+#endif /* INC_TELEMETRY_H_ */
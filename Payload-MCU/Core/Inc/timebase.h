@@ -0,0 +1,60 @@
+/*
+ * timebase.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: A microsecond clock shared with CDH, for stamping telemetry.
+ *
+ *  The local clock is the DWT cycle counter, extended past its 53 s wrap.
+ *  CDH sends its own time periodically. The offset to it is stepped out on
+ *  every sync, and the rate difference measured between syncs is corrected
+ *  continuously, so the clocks stay close in between.
+ */
+
+#ifndef INC_TIMEBASE_H_
+#define INC_TIMEBASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Starts the local clock from 0. Until the first sync, time is
+ *        counted from here.
+ */
+void Timebase_Init();
+
+/**
+ * @brief Gets the current time, in microseconds, on CDH's clock once synced.
+ *
+ * Safe to call from interrupts. Must be called at least once per wrap of the
+ * cycle counter, which the telemetry timer interrupt guarantees.
+ */
+uint32_t Timebase_Now();
+
+/**
+ * @brief Gets the time since Timebase_Init on the local clock, in
+ *        microseconds. Syncs don't move it, so the difference of two reads is
+ *        the time that passed in between.
+ *
+ * Safe to call from interrupts. Wraps every ~71 minutes.
+ */
+uint32_t Timebase_Local_Micros();
+
+/**
+ * @brief Aligns the clock with CDH's.
+ *
+ * @param remote_time	CDH's time when it sent the sync, in microseconds.
+ */
+void Timebase_Sync(uint32_t remote_time);
+
+/**
+ * @brief Checks whether a sync has been received since boot.
+ */
+bool Timebase_Is_Synced();
+
+/**
+ * @brief Prints the last sync error and the rate correction in use.
+ */
+void Timebase_Print_Status();
+
+#endif /* INC_TIMEBASE_H_ */
@@ -0,0 +1,58 @@
+/*
+ * warm_state.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Keeps the state of running experiments across resets.
+ *
+ *  The state is held in a RAM section that the startup code leaves untouched,
+ *  so it survives watchdog and software resets. It is also mirrored to flash
+ *  so it survives power cycles, at the cost of being slightly out of date.
+ *
+ *  Configuration is not part of it: it is kept in the config store (see
+ *  config_store.h) as soon as it changes.
+ */
+
+#ifndef INC_WARM_STATE_H_
+#define INC_WARM_STATE_H_
+
+#include "led_programs.h"
+
+#include <stdint.h>
+
+typedef enum {
+	WARM_STATE_NONE = 0, // no valid state. start cold.
+	WARM_STATE_RAM,      // restored from RAM after a reset.
+	WARM_STATE_FLASH     // restored from the flash mirror after a power cycle.
+} WarmStateSource;
+
+typedef struct
+{
+	LEDProgramState led_programs[16];
+	uint16_t heaters;            // bit n is the heater of well n.
+	uint16_t leds;               // bit n is the LED of well n.
+	uint8_t temp_sequence;
+	uint8_t light_sequence;
+	uint16_t reserved[3];
+} WarmState;
+
+/**
+ * @brief Retrieves the most recent valid state.
+ *
+ * The RAM copy is preferred. The flash mirror is used if the RAM copy was
+ * lost, e.g. after a power cycle.
+ *
+ * @param out	Where to store the state. Untouched if none is found.
+ * @return		Where the state was found.
+ */
+WarmStateSource Warm_State_Load(WarmState *out);
+
+/**
+ * @brief Records the current state.
+ *
+ * The RAM copy is updated immediately. The flash mirror is only updated every
+ * few minutes.
+ */
+void Warm_State_Store(const WarmState *state);
+
+#endif /* INC_WARM_STATE_H_ */
@@ -0,0 +1,79 @@
+/*
+ * boot.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Records how long each stage of bringing up the payload takes.
+ */
+
+#include "boot.h"
+#include "timebase.h"
+
+#include <stdint.h>
+#include "tuk/debug/print.h"
+
+static const char *const STAGE_NAMES[] = {
+		"CAN",
+		"Timers",
+		"Warm State",
+		"I2C",
+		"Expanders",
+		"I2C Speed",
+		"Telemetry",
+		"ADC",
+		"Self Test",
+};
+
+static const char *const STATUS_NAMES[] = {
+		"pending",
+		"running",
+		"ok",
+		"failed",
+		"deferred",
+};
+
+static BootStageRecord s_timeline[NUM_BOOT_STAGES];
+
+#define PRINT_SUBJECT "Boot"
+
+void Boot_Stage_Begin(BootStageID stage)
+{
+	if (stage >= NUM_BOOT_STAGES)
+		return;
+
+	BootStageRecord *record = &s_timeline[stage];
+
+	// keep the time of the first attempt so retries show up as one long stage.
+	if (record->attempts == 0)
+		record->start = Timebase_Local_Micros();
+
+	record->status = BOOT_STAGE_RUNNING;
+	if (record->attempts < UINT8_MAX)
+		record->attempts++;
+}
+
+void Boot_Stage_End(BootStageID stage, BootStageStatus status)
+{
+	if (stage >= NUM_BOOT_STAGES)
+		return;
+
+	s_timeline[stage].end = Timebase_Local_Micros();
+	s_timeline[stage].status = status;
+}
+
+const BootStageRecord *Boot_Get_Timeline()
+{
+	return s_timeline;
+}
+
+void Boot_Print_Timeline()
+{
+	for (int i = 0; i < NUM_BOOT_STAGES; i++)
+	{
+		const BootStageRecord *record = &s_timeline[i];
+
+		PRINT_INFO("%-10s %-8s start: %8lu us, took: %8lu us, attempts: %u",
+				STAGE_NAMES[i], STATUS_NAMES[record->status],
+				record->start, record->end - record->start, record->attempts);
+	}
+}
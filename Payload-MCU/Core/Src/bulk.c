@@ -0,0 +1,242 @@
+/*
+ * bulk.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Moves blocks of data larger than a CAN frame to CDH.
+ */
+
+#include "bulk.h"
+#include "crc.h"
+#include "error_log.h"
+#include "pp.h"
+#include "main.h"
+#include "tuk/tuk.h"
+#include "payload_cmds.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+static const uint32_t ACK_TIMEOUT = 500;     // in ms. without progress, resend from the first unacknowledged packet.
+static const uint32_t MAX_TIMEOUTS = 10;     // consecutive timeouts before giving up.
+static const uint32_t FRAMES_PER_UPDATE = 4; // most frames to queue per update.
+
+// resend requests are a 32-bit mask.
+CASSERT(BULK_WINDOW <= 32, bulk)
+
+static BulkSource s_source = BULK_SOURCE_NONE;
+static uint8_t s_serial = 0;
+static uint8_t s_id;
+static const uint8_t *s_data;
+static uint32_t s_size;
+static uint32_t s_crc;
+static bool s_crc_ready;          // s_crc is computed. it is computed by DMA while the data is sent.
+static uint32_t s_num_packets;     // data packets. the end frame is packet s_num_packets.
+static bool s_start_sent;
+static uint32_t s_acked;           // first packet not yet acknowledged.
+static uint32_t s_next;            // next packet not sent yet.
+static uint32_t s_resend;          // bit n resends packet s_acked + n.
+static uint32_t s_last_progress;   // HAL tick of the last acknowledgement or timeout.
+static uint32_t s_timeouts;        // consecutive timeouts.
+
+static bool send_start();
+static bool send_packet(uint32_t packet);
+static void finish();
+
+#define PRINT_SUBJECT "Bulk"
+
+bool Bulk_Start(BulkSource source, const void *data, uint32_t size)
+{
+	if (source == BULK_SOURCE_NONE || data == NULL || size == 0 || size > BULK_MAX_SIZE)
+	{
+		PRINT_ERROR("invalid transfer: source %d, %lu bytes.", source, size);
+		return false;
+	}
+
+	if (s_source != BULK_SOURCE_NONE)
+	{
+		PRINT_INFO("cancelling transfer %02X.", s_id);
+	}
+
+	s_source = source;
+	s_id = (uint8_t)((source << 4) | (s_serial++ & 0x0F));
+	s_data = data;
+	s_size = size;
+	// the CRC is only needed for the end frame. compute it in the background.
+	CRC_Abort();
+	s_crc_ready = !CRC_Start(data, size);
+	if (s_crc_ready)
+		s_crc = CRC_Compute(data, size);
+	s_num_packets = (size + BULK_PACKET_SIZE - 1) / BULK_PACKET_SIZE;
+	s_start_sent = false;
+	s_acked = 0;
+	s_next = 0;
+	s_resend = 0;
+	s_last_progress = HAL_GetTick();
+	s_timeouts = 0;
+
+	PRINT_INFO("starting transfer %02X: %lu bytes in %lu packets.", s_id, size, s_num_packets);
+
+	return true;
+}
+
+void Bulk_Update()
+{
+	if (s_source == BULK_SOURCE_NONE)
+		return;
+
+	uint32_t now = HAL_GetTick();
+	if (now - s_last_progress >= ACK_TIMEOUT)
+	{
+		if (++s_timeouts > MAX_TIMEOUTS)
+		{
+			PRINT_ERROR("transfer %02X timed out at packet %lu of %lu.", s_id, s_acked, s_num_packets);
+			Error_Log_Put(ERROR_BULK_TIMEOUT, s_id);
+			finish();
+			return;
+		}
+
+		// go back to the first packet CDH is missing. CDH may also have
+		// missed the start if it hasn't acknowledged anything.
+		s_next = s_acked;
+		s_resend = 0;
+		if (s_acked == 0)
+			s_start_sent = false;
+		s_last_progress = now;
+	}
+
+	if (!s_start_sent)
+	{
+		if (!send_start())
+			return;
+		s_start_sent = true;
+	}
+
+	for (uint32_t sent = 0; sent < FRAMES_PER_UPDATE; sent++)
+	{
+		if (s_resend != 0)
+		{
+			uint32_t n = __builtin_ctz(s_resend);
+			if (!send_packet(s_acked + n))
+				return;
+			s_resend &= ~(1UL << n);
+		}
+		else if (s_next <= s_num_packets && s_next < s_acked + BULK_WINDOW)
+		{
+			if (!send_packet(s_next))
+				return;
+			s_next++;
+		}
+		else
+		{
+			return;
+		}
+	}
+}
+
+void Bulk_On_Ack(uint8_t transfer_id, uint16_t next_packet, uint32_t resend)
+{
+	if (s_source == BULK_SOURCE_NONE || transfer_id != s_id)
+		return; // stale. e.g. for a cancelled transfer.
+
+	if (next_packet > s_num_packets + 1)
+	{
+		PRINT_ERROR("invalid acknowledgement of packet %u in transfer %02X.", next_packet, s_id);
+		return;
+	}
+
+	if (next_packet < s_acked)
+		return; // overtaken by a later one.
+
+	// only new packets are progress. acknowledging the same packet again,
+	// e.g. while the end frame is lost, mustn't hold off the timeout.
+	if (next_packet > s_acked)
+	{
+		s_last_progress = HAL_GetTick();
+		s_timeouts = 0;
+	}
+
+	s_acked = next_packet;
+	if (s_next < s_acked)
+		s_next = s_acked; // acknowledged after a timeout sent us back.
+
+	if (s_acked > s_num_packets)
+	{
+		PRINT_INFO("transfer %02X complete.", s_id);
+		finish();
+		return;
+	}
+
+	// only resend packets that were sent in the first place.
+	uint32_t sent = s_next - s_acked;
+	if (sent < 32)
+		resend &= (1UL << sent) - 1;
+	s_resend = resend;
+}
+
+void Bulk_Cancel(BulkSource source)
+{
+	if (s_source != BULK_SOURCE_NONE && s_source == source)
+	{
+		PRINT_INFO("cancelling transfer %02X.", s_id);
+		finish();
+	}
+}
+
+BulkSource Bulk_Get_Source()
+{
+	return s_source;
+}
+
+static bool send_start()
+{
+	CANMessage msg;
+	msg.cmd = CMD_CDH_PROCESS_BULK_START;
+	SET_ARG(msg, 0, uint8_t, s_id);
+	SET_ARG(msg, 1, uint32_t, s_size);
+
+	return CANWrapper_Transmit(NODE_CDH, &msg) == CAN_WRAPPER_HAL_OK;
+}
+
+/**
+ * @brief Sends a data packet, or the end frame.
+ *
+ * @return true on success. false if the CAN wrapper didn't take the frame.
+ */
+static bool send_packet(uint32_t packet)
+{
+	CANMessage msg;
+	SET_ARG(msg, 0, uint8_t, s_id);
+
+	if (packet == s_num_packets)
+	{
+		if (!s_crc_ready && !CRC_Poll(&s_crc))
+			return false; // try again once it's ready.
+		s_crc_ready = true;
+
+		msg.cmd = CMD_CDH_PROCESS_BULK_END;
+		SET_ARG(msg, 1, uint32_t, s_crc);
+	}
+	else
+	{
+		uint32_t offset = packet * BULK_PACKET_SIZE;
+		uint32_t length = s_size - offset < BULK_PACKET_SIZE ? s_size - offset : BULK_PACKET_SIZE;
+
+		msg.cmd = CMD_CDH_PROCESS_BULK_DATA;
+		SET_ARG(msg, 1, uint16_t, (uint16_t)packet);
+		memset(&msg.data[3], 0, BULK_PACKET_SIZE);
+		memcpy(&msg.data[3], &s_data[offset], length);
+	}
+
+	return CANWrapper_Transmit(NODE_CDH, &msg) == CAN_WRAPPER_HAL_OK;
+}
+
+static void finish()
+{
+	if (!s_crc_ready)
+		CRC_Abort();
+
+	s_source = BULK_SOURCE_NONE;
+	s_data = NULL;
+}
@@ -5,25 +5,51 @@
  *      Author: Logan Furedi
  */
 
+#include <board_topology.h>
+#include <boot.h>
+#include <bulk.h>
+#include <burst.h>
+#include <calibration.h>
 #include <can.h>
+#include <config_store.h>
+#include <crc.h>
+#include <error_log.h>
 #include <cmsis_gcc.h>
+#include <fault.h>
+#include <flash_log.h>
+#include <heater_budget.h>
 #include <heaters.h>
+#include <i2c.h>
+#include <i2c_speed_test.h>
+#include <led_programs.h>
 #include <leds.h>
+#include <math.h>
 #include <max6822.h>
+#include <payload_cmds.h>
 #include <photocells.h>
 #include <power.h>
+#include <sensor_health.h>
+#include <sensor_math.h>
+#include <sensors.h>
+#include <spsc_ring.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stm32l452xx.h>
 #include <stm32l4xx_hal_def.h>
 #include <stm32l4xx_hal_tim.h>
+#include <stack_monitor.h>
 #include <string.h>
 #include <sys/_stdint.h>
 #include <tca9539.h>
+#include <tca9548.h>
+#include <tcs.h>
+#include <telemetry.h>
 #include <thermistors.h>
 #include <tim.h>
+#include <timebase.h>
 #include <tmp235.h>
+#include <warm_state.h>
 #include <well_id.h>
 #include "core.h"
 #include "tuk/tuk.h"
@@ -33,23 +59,54 @@ typedef enum {
 	ACTIVE
 } State;
 
+static const uint32_t WARM_STATE_PERIOD = 100;      // in ms.
+static const uint32_t EXPANDER_RETRY_PERIOD = 1000; // in ms.
+static const uint32_t STACK_CHECK_PERIOD = 1000;    // in ms.
+static const I2CSpeed I2C_MAX_SPEED = I2C_SPEED_FAST_PLUS;
+
+// mux channels that can't be enabled together, from the wiring.
+static const uint8_t MUX_CONFLICTS[TCA9548_NUM_CHANNELS] = BOARD_MUX_CONFLICT_TABLE;
+
+CASSERT(BOARD_NUM_MUX_CHANNELS == TCA9548_NUM_CHANNELS, core)
+
 static State s_state = IDLE;
-static uint8_t s_temp_sequence = 0;
-static uint8_t s_light_sequence = 0;
+static uint8_t s_sequences[NUM_SENSOR_TYPES] = {0}; // next telemetry sequence #, by sensor type.
+static uint32_t s_last_warm_state = 0;       // HAL tick of the last warm state capture.
+static bool s_expanders_ready = false;       // expanders are up and outputs restored.
+static uint32_t s_last_expander_attempt = 0; // HAL tick of the last expander bring-up.
+static uint32_t s_last_stack_check = 0;      // HAL tick of the last stack scan.
+static WarmState s_warm_state;               // state found at boot.
+static WarmStateSource s_warm_source = WARM_STATE_NONE;
+static SPSC_RING(uint32_t, 8) s_ticks;       // TIM2 ticks not yet reported, by local time.
+static uint32_t s_merged_ticks = 0;          // ticks that came while another was pending.
+static uint32_t s_worst_tick_delay = 0;      // longest from a tick to its report, in us.
 
 static void on_message_received(CANMessage msg, NodeID sender, bool is_ack);
 static void on_error_occured(CANWrapper_ErrorInfo error);
-static void report_well_temp_data(WellID well_id);
-static void report_well_light_data(WellID well_id);
-//static void process_errors(ErrorBuffer *p_error_buffer);
+static void report_telemetry();
 static void print_well_info();
+static bool bring_up_expanders();
+static uint32_t get_max_telemetry_period();
+static void restore_config();
+static void restore_warm_counters(const WarmState *state);
+static void restore_warm_outputs(const WarmState *state);
+static void capture_warm_state(WarmState *out);
+static void report_boot_timeline();
+static void report_stack_usage();
 
 #define PRINT_SUBJECT "Core"
 
 void Core_Init()
 {
-	bool success;
 	CANWrapper_StatusTypeDef cw_status;
+	HAL_StatusTypeDef status;
+
+	// paint the stack before anything gets deep into it.
+	Stack_Monitor_Init();
+	Fault_Init();
+
+	// the boot timeline is measured on the local clock.
+	Timebase_Init();
 
 	s_state = IDLE;
 
@@ -57,12 +114,8 @@ void Core_Init()
 
 	DebugLogger_Init();
 
-	success = TCA9539_Init();
-	if (!success)
-	{
-		PRINT_ERROR("failed to initialise IO Expander driver.");
-		//PUT_ERROR(ERR_PLD_TCA9539_INIT);
-	}
+	// bring up CAN first so the node answers as soon as possible.
+	Boot_Stage_Begin(BOOT_STAGE_CAN);
 
 	CANWrapper_InitTypeDef cw_init = {
 			.node_id = NODE_PAYLOAD,
@@ -76,18 +129,82 @@ void Core_Init()
 	if (cw_status != CAN_WRAPPER_HAL_OK)
 	{
 		PRINT_ERROR("failed to initialise CAN wrapper.");
-		//PUT_ERROR(ERR_CAN_WRAPPER_INIT, cw_status);
+		Error_Log_Put(ERROR_CAN_WRAPPER_INIT, cw_status);
+		Boot_Stage_End(BOOT_STAGE_CAN, BOOT_STAGE_FAILED);
 	}
 	else
 	{
 		// TODO: disable CAN in this case?
+		Boot_Stage_End(BOOT_STAGE_CAN, BOOT_STAGE_OK);
 	}
-/*
-	if (ErrorBuffer_Has_Error(&s_error_buffer)) // TODO: replace with error code
+
+	Boot_Stage_Begin(BOOT_STAGE_TIMERS);
+	MX_TIM2_Init();
+	Boot_Stage_End(BOOT_STAGE_TIMERS, BOOT_STAGE_OK);
+
+	// resume running experiments if we are coming back from a reset.
+	// outputs are restored once the expanders are up.
+	Boot_Stage_Begin(BOOT_STAGE_WARM_STATE);
+	CRC_Init();
+	Config_Init();
+	restore_config();
+	s_warm_source = Warm_State_Load(&s_warm_state);
+	if (s_warm_source != WARM_STATE_NONE)
+	{
+		restore_warm_counters(&s_warm_state);
+	}
+	else
+	{
+		PRINT_INFO("no saved state found. Starting cold.");
+	}
+	Flash_Log_Init();
+	Calibration_Init();
+	Fault_Report();
+	Boot_Stage_End(BOOT_STAGE_WARM_STATE, BOOT_STAGE_OK);
+
+	Boot_Stage_Begin(BOOT_STAGE_I2C);
+	MX_I2C1_Init();
+	TCA9548_Init(MUX_CONFLICTS);
+	Boot_Stage_End(BOOT_STAGE_I2C, BOOT_STAGE_OK);
+
+	// a missing expander is retried from Core_Update instead of holding up boot.
+	s_last_expander_attempt = HAL_GetTick();
+	bring_up_expanders();
+
+	// segments that fail at a higher speed stay at the fastest one that works.
+	Boot_Stage_Begin(BOOT_STAGE_I2C_SPEED);
+	I2C_Speed_Test_Run(I2C_MAX_SPEED);
+	Boot_Stage_End(BOOT_STAGE_I2C_SPEED, BOOT_STAGE_OK);
+
+	// a mismatch is reported, not acted on: the kernels have no fallback at
+	// run time.
+	Boot_Stage_Begin(BOOT_STAGE_SELF_TEST);
+	if (!Sensor_Math_Self_Test())
+	{
+		Error_Log_Put(ERROR_SELF_TEST, 0);
+		Boot_Stage_End(BOOT_STAGE_SELF_TEST, BOOT_STAGE_FAILED);
+	}
+	else
+	{
+		Boot_Stage_End(BOOT_STAGE_SELF_TEST, BOOT_STAGE_OK);
+	}
+
+	TCS_Init();
+
+	Boot_Stage_Begin(BOOT_STAGE_TELEMETRY);
+	Telemetry_Init();
+	status = HAL_TIM_Base_Start_IT(&htim2);
+	if (status != HAL_OK)
+	{
+		PRINT_ERROR("failed to start telemetry timer. (HAL error code: %d)", status);
+		Boot_Stage_End(BOOT_STAGE_TELEMETRY, BOOT_STAGE_FAILED);
+	}
+	else
 	{
-		process_errors(&s_error_buffer);
+		Boot_Stage_End(BOOT_STAGE_TELEMETRY, BOOT_STAGE_OK);
 	}
-*/
+
+	Boot_Print_Timeline();
 }
 
 void Core_Update()
@@ -96,12 +213,62 @@ void Core_Update()
 
 	CANWrapper_Poll_Messages();
 	CANWrapper_Poll_Errors();
-/*
-	if (ErrorBuffer_Has_Error(&s_error_buffer))
+
+	if (!s_expanders_ready)
 	{
-		process_errors(&s_error_buffer);
+		if (HAL_GetTick() - s_last_expander_attempt >= EXPANDER_RETRY_PERIOD)
+		{
+			s_last_expander_attempt = HAL_GetTick();
+			bring_up_expanders();
+		}
 	}
-	*/
+	else
+	{
+		LED_Programs_Update();
+
+		// the thermistors share the multiplexer with a burst capture.
+		TCS_Update(Burst_Get_State() != BURST_CAPTURING);
+
+		// only capture once the outputs have been restored, so a reset while
+		// the expanders are missing doesn't lose the saved state.
+		if (HAL_GetTick() - s_last_warm_state >= WARM_STATE_PERIOD)
+		{
+			s_last_warm_state = HAL_GetTick();
+
+			WarmState warm_state;
+			capture_warm_state(&warm_state);
+			Warm_State_Store(&warm_state);
+		}
+	}
+
+	if (HAL_GetTick() - s_last_stack_check >= STACK_CHECK_PERIOD)
+	{
+		s_last_stack_check = HAL_GetTick();
+		Stack_Monitor_Check();
+	}
+
+	Burst_Update();
+	Bulk_Update();
+	Calibration_Update();
+
+	// a sweep would move the multiplexer off the captured sensor. ticks that
+	// piled up meanwhile are reported as one.
+	if (SPSC_RING_COUNT(&s_ticks) != 0 && Burst_Get_State() != BURST_CAPTURING)
+	{
+		uint32_t ticks[SPSC_RING_CAPACITY(&s_ticks)];
+		uint32_t count = SPSC_RING_POP(&s_ticks, ticks, SPSC_RING_CAPACITY(&s_ticks));
+
+		uint32_t delay = Timebase_Local_Micros() - ticks[0];
+		if (delay > s_worst_tick_delay)
+		{
+			s_worst_tick_delay = delay;
+		}
+
+		s_merged_ticks += count - 1;
+		report_telemetry();
+	}
+
+	Error_Log_Update();
 }
 
 void Core_Halt()
@@ -126,6 +293,11 @@ static void on_message_received(CANMessage msg, NodeID sender, bool is_ack)
 	{
 	case CMD_COMM_RESET:
 	{
+		// make sure the experiments resume exactly where they left off.
+		WarmState warm_state;
+		capture_warm_state(&warm_state);
+		Warm_State_Store(&warm_state);
+
 		// trigger a hardware reset.
 		MAX6822_Manual_Reset();
 		Core_Halt(); // wait for the reset.
@@ -148,15 +320,31 @@ static void on_message_received(CANMessage msg, NodeID sender, bool is_ack)
 		success = Heaters_Set_Heater(well_id, power);
 		break;
 	}
+	*/
 	case CMD_PLD_SET_SETPOINT:
 	{
 		uint8_t well_id = GET_ARG(msg, 0, uint8_t);
 		float temp      = GET_ARG(msg, 1, float);
 
-		// TODO: update the target temperature of one of the wells in the TCS.
+		// NaN turns regulation off. the TCS works in hundredths of a degree,
+		// and anything that doesn't fit, infinities included, is refused
+		// rather than wrapped. INT16_MIN itself is TCS_SETPOINT_OFF.
+		float hundredths = temp * 100.0f;
+		if (isnan(temp))
+		{
+			success = TCS_Set_Setpoint(well_id, TCS_SETPOINT_OFF);
+		}
+		else if (hundredths > (float)TCS_SETPOINT_OFF && hundredths < (float)INT16_MAX + 1.0f)
+		{
+			success = TCS_Set_Setpoint(well_id, (int16_t)hundredths);
+		}
+		else
+		{
+			PRINT_ERROR("setpoint out of range for well %d.", well_id);
+			Error_Log_Put(ERROR_INVALID_ARGUMENT, msg.cmd);
+		}
 		break;
 	}
-	*/
 	/*
 	case CMD_PLD_GET_WELL_LIGHT:
 	{
@@ -193,34 +381,149 @@ static void on_message_received(CANMessage msg, NodeID sender, bool is_ack)
 	{
 		uint32_t period = GET_ARG(msg, 0, uint32_t);
 
-		// set interrupt timer period.
+		if (period == 0 || period > get_max_telemetry_period())
+		{
+			PRINT_ERROR("invalid telemetry interval: %lu cycles.", period);
+			Error_Log_Put(ERROR_INVALID_ARGUMENT, msg.cmd);
+			break;
+		}
+
+		// set interrupt timer period. the counter would otherwise run on to
+		// its 32 bit wrap if it is already past the new period.
 		__HAL_TIM_SET_AUTORELOAD(&htim2, period);
+		if (__HAL_TIM_GET_COUNTER(&htim2) >= period)
+		{
+			__HAL_TIM_SET_COUNTER(&htim2, 0);
+		}
+		Config_Set(CONFIG_KEY_TELEMETRY_INTERVAL, &period, sizeof(period));
+
+		success = true;
+		break;
+	}
+	case CMD_PLD_SYNC_TIME:
+	{
+		Timebase_Sync(GET_ARG(msg, 0, uint32_t));
+
+		success = true;
+		break;
+	}
+	case CMD_PLD_START_BURST:
+	{
+		uint8_t type = GET_ARG(msg, 0, uint8_t);
+		uint8_t well_id = GET_ARG(msg, 1, uint8_t);
+		uint16_t count = GET_ARG(msg, 2, uint16_t);
+
+		success = Burst_Start(type, well_id, count);
+		break;
+	}
+	case CMD_PLD_BULK_ACK:
+	{
+		uint8_t transfer_id = GET_ARG(msg, 0, uint8_t);
+		uint16_t next_packet = GET_ARG(msg, 1, uint16_t);
+		uint32_t resend = GET_ARG(msg, 3, uint32_t);
+
+		Bulk_On_Ack(transfer_id, next_packet, resend);
+
+		success = true;
+		break;
+	}
+	case CMD_PLD_DOWNLINK_LOG:
+	{
+		uint8_t pages_back = GET_ARG(msg, 0, uint8_t);
+
+		uint32_t address = Flash_Log_Get_Page(pages_back);
+		success = address != 0 && Bulk_Start(BULK_SOURCE_LOG, (const void *)address, FLASH_PAGE_SIZE);
+		break;
+	}
+	case CMD_PLD_GET_STACK_USAGE:
+	{
+		report_stack_usage();
+
+		success = true;
+		break;
+	}
+	case CMD_PLD_SET_LED_PROGRAM:
+	{
+		uint8_t well_id = GET_ARG(msg, 0, uint8_t);
+
+		LEDProgram program = {
+				.on_time  = GET_ARG(msg, 1, uint16_t),
+				.off_time = GET_ARG(msg, 3, uint16_t),
+				.repeats  = GET_ARG(msg, 5, uint8_t)
+		};
+
+		// phase is sent in 1/256ths of a cycle to fit in the message.
+		uint32_t period = (uint32_t)program.on_time + program.off_time;
+		program.phase = (period * GET_ARG(msg, 6, uint8_t)) >> 8;
+
+		success = LED_Programs_Set(well_id, &program);
+		break;
+	}
+	case CMD_PLD_SET_HEATER_BUDGET:
+	{
+		Heater_Budget_Set_Limit(GET_ARG(msg, 0, uint16_t));
+
+		success = true;
+		break;
+	}
+	case CMD_PLD_SET_WELL_PRIORITY:
+	{
+		uint8_t well_id = GET_ARG(msg, 0, uint8_t);
+		uint8_t priority = GET_ARG(msg, 1, uint8_t);
+
+		success = Heater_Budget_Set_Priority(well_id, priority);
+		break;
+	}
+	case CMD_PLD_SET_CALIBRATION:
+	{
+		// type in the high nibble, well in the low one.
+		uint8_t sensor = GET_ARG(msg, 0, uint8_t);
+		int16_t gain = GET_ARG(msg, 1, int16_t);
+		int16_t offset = GET_ARG(msg, 3, int16_t);
+
+		success = Calibration_Set(sensor >> 4, sensor & 0x0F, gain, offset);
+		break;
+	}
+	case CMD_PLD_SET_CALIBRATION_POINT:
+	{
+		uint8_t sensor = GET_ARG(msg, 0, uint8_t);
+		uint8_t index = GET_ARG(msg, 1, uint8_t);
+		uint8_t count = GET_ARG(msg, 2, uint8_t);
 
+		CalibrationPoint point = {
+				.in  = GET_ARG(msg, 3, uint16_t),
+				.out = GET_ARG(msg, 5, uint16_t)
+		};
+
+		success = Calibration_Set_Point(sensor >> 4, sensor & 0x0F, index, count, &point);
+		break;
+	}
+	case CMD_PLD_GET_BOOT_TIMELINE:
+	{
+		report_boot_timeline();
 		success = true;
 		break;
 	}
 	case CMD_PLD_TEST_LEDS:
 	{
-		// TODO
+		success = LED_Programs_Test();
+		break;
+	}
+	case CMD_PLD_PRINT_DEBUG_INFO:
+	{
+		print_well_info();
+		success = true;
 		break;
 	}
 	default:
 	{
 		PRINT_ERROR("unknown command: 0x%02X.", msg.cmd);
-		//PUT_ERROR(ERR_UNKNOWN_COMMAND, (uint8_t)msg.cmd);
+		Error_Log_Put(ERROR_UNKNOWN_COMMAND, msg.cmd);
 		break;
 	}
 	}
 
 	DebugLogger_Pop_Buffer();
-
-	/*
-	if (ErrorBuffer_Has_Error(&cmd_error_buffer))
-	{
-		success = false; // FIXME: either do something with this variable or remove it.
-		process_errors(&cmd_error_buffer);
-	}
-	*/
 }
 
 static void on_error_occured(CANWrapper_ErrorInfo error)
@@ -256,119 +559,230 @@ static void on_error_occured(CANWrapper_ErrorInfo error)
 // callback for timers.
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
-	//ErrorBuffer error_buffer;
-	//ErrorTracker_Push_Buffer(&error_buffer);
-
 	if (htim == &htim2)
 	{
-		// FIXME: these repeated calls can result in an error buffer overflow if they produce errors.
-		for (int i = WELL_0; i <= WELL_15; i++)
-		{
-			report_well_temp_data(i);
-		}
+		// the period is shorter than a wrap of the cycle counter, so the
+		// timebase never misses a wrap even if the main loop stalls.
+		uint32_t now = Timebase_Local_Micros();
+
+		// the sweep runs from Core_Update. HAL_GetTick doesn't advance in here,
+		// as SysTick has a lower priority, so I2C timeouts would never expire.
+		SPSC_RING_PUSH(&s_ticks, &now, 1);
+	}
+}
+
+
+
+// reads every sensor, then sends what was read through CAN.
+static void report_telemetry()
+{
+	SensorSnapshot snapshot;
+	Sensors_Sweep(&snapshot);
+
+	CANMessage *frames[TELEMETRY_MAX_FRAMES];
+	uint32_t count = Telemetry_Encode(&snapshot, s_sequences, frames);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		CANWrapper_Transmit(NODE_CDH, frames[i]);
+	}
+
+	// sensors that failed were recorded in the error log as they were read.
+	Flash_Log_Append(&snapshot);
+}
+
+// prints a fresh reading of every well, then the stats of each module.
+static void print_well_info()
+{
+	// a sweep would move the multiplexer off the captured sensor.
+	if (Burst_Get_State() != BURST_CAPTURING)
+	{
+		SensorSnapshot snapshot;
+		Sensors_Sweep(&snapshot);
+
+		uint16_t *therm_data = snapshot.readings[SENSOR_THERMISTOR];
+		uint16_t *light_data = snapshot.readings[SENSOR_PHOTOCELL];
+
+		PRINT_INFO("_________________________");
+		PRINT_INFO("| WELL  | TEMPS | LIGHT |");
+		PRINT_INFO("|-----------------------|");
 		for (int i = WELL_0; i <= WELL_15; i++)
 		{
-			report_well_light_data(i);
+			PRINT_INFO("| %6d| %6d| %6d|", i, therm_data[i], light_data[i]);
 		}
+		PRINT_INFO("-------------------------");
 	}
 
-	//process_errors(&error_buffer);
-
-	//ErrorTracker_Pop_Buffer();
+	Telemetry_Print_Stats();
+	PRINT_INFO("telemetry ticks: %lu merged, %lu dropped, worst delay %lu us, queue high water %lu of %u.",
+			s_merged_ticks, s_ticks.ring.dropped, s_worst_tick_delay,
+			s_ticks.ring.high_water, SPSC_RING_CAPACITY(&s_ticks));
+	Timebase_Print_Status();
+	Flash_Log_Print_Stats();
+	Config_Print_Stats();
+	Stack_Monitor_Print();
+	Error_Log_Print();
+	Sensor_Health_Print();
+	TCS_Print_Stats();
+	Heater_Budget_Print();
+	Calibration_Print();
 }
 
+// probes the expanders, then initialises them and the outputs behind them.
+static bool bring_up_expanders()
+{
+	Boot_Stage_Begin(BOOT_STAGE_EXPANDERS);
+
+	// a quick probe costs a few ms, where a failed init would cost hundreds.
+	if (!TCA9539_Is_Present(EXPANDER_1) || !TCA9539_Is_Present(EXPANDER_2))
+	{
+		Boot_Stage_End(BOOT_STAGE_EXPANDERS, BOOT_STAGE_DEFERRED);
+		return false;
+	}
 
+	if (!TCA9539_Init())
+	{
+		PRINT_ERROR("failed to initialise IO Expander driver.");
+		Error_Log_Put(ERROR_TCA9539_INIT, 0);
+		Boot_Stage_End(BOOT_STAGE_EXPANDERS, BOOT_STAGE_DEFERRED);
+		return false;
+	}
 
-// function to get temperature data, package it and send it through CAN
-static void report_well_temp_data(WellID well_id)
-{
-	uint16_t temp;
-	bool success = Thermistors_Get_Temp(well_id, &temp);
+	if (s_warm_source != WARM_STATE_NONE)
+	{
+		restore_warm_outputs(&s_warm_state);
+	}
 
-	if (!success)
+	LED_Programs_Init();
+	if (s_warm_source != WARM_STATE_NONE)
 	{
-		PRINT_ERROR("failed to report temperature of well %d: could not get temperature.", well_id);
-		// TODO: Add PUT_ERROR?
-		return;
+		LED_Programs_Restore_States(s_warm_state.led_programs);
 	}
 
-	CANMessage msg;
-	msg.cmd = CMD_CDH_PROCESS_TELEMETRY_REPORT;
-	uint8_t tel_key = CREATE_TELEMETRY_KEY(TEL_WELL_TEMP, well_id);
-	SET_ARG(msg, 0, uint8_t, tel_key);
-	SET_ARG(msg, 1, uint8_t, s_temp_sequence);
-	SET_ARG(msg, 2, uint8_t, 0); // packet #
-	SET_ARG(msg, 3, uint16_t, temp);
+	s_expanders_ready = true;
+	Boot_Stage_End(BOOT_STAGE_EXPANDERS, BOOT_STAGE_OK);
+
+	if (s_warm_source != WARM_STATE_NONE)
+	{
+		PRINT_INFO("restored state from %s %lu us after boot.",
+				s_warm_source == WARM_STATE_RAM ? "RAM" : "flash",
+				Boot_Get_Timeline()[BOOT_STAGE_EXPANDERS].end);
+	}
 
-	s_temp_sequence++;
+	return true;
+}
 
-	CANWrapper_Transmit(NODE_CDH, &msg);
+// TIM2 counts CPU cycles, like the cycle counter behind the timebase, which
+// its interrupt must read more often than the counter wraps. so the period
+// stops 1 ms short of a wrap, for the interrupt to run in.
+static uint32_t get_max_telemetry_period()
+{
+	return UINT32_MAX - SystemCoreClock / 1000;
 }
 
-// function to get light level data, package it and send it through CAN
-static void report_well_light_data(WellID well_id)
+// puts back the saved configuration that core owns. the other modules load
+// their own when they start.
+static void restore_config()
 {
-	uint16_t light;
-	bool success = Photocells_Get_Light_Level(well_id, &light);
+	uint32_t period = __HAL_TIM_GET_AUTORELOAD(&htim2);
 
-	if (!success)
+	uint32_t saved;
+	if (Config_Get(CONFIG_KEY_TELEMETRY_INTERVAL, &saved, sizeof(saved)) == sizeof(saved))
 	{
-		PRINT_ERROR("failed to report temperature of well %d: could not get temperature.", well_id);
-		// TODO: Add PUT_ERROR?
-		return;
+		if (saved != 0 && saved <= get_max_telemetry_period())
+		{
+			period = saved;
+		}
+		else
+		{
+			PRINT_ERROR("ignoring invalid saved telemetry interval: %lu cycles.", saved);
+			Error_Log_Put(ERROR_INVALID_ARGUMENT, CMD_COMM_SET_TELEMETRY_INTERVAL);
+		}
 	}
 
-	CANMessage msg;
-	msg.cmd = CMD_CDH_PROCESS_TELEMETRY_REPORT;
-	uint8_t tel_key = CREATE_TELEMETRY_KEY(TEL_WELL_LUMINOSITY, well_id);
-	SET_ARG(msg, 0, uint8_t, tel_key);
-	SET_ARG(msg, 1, uint8_t, s_light_sequence);
-	SET_ARG(msg, 2, uint8_t, 0); // packet #
-	SET_ARG(msg, 3, uint16_t, light);
+	// the default from CubeMX is a whole wrap.
+	if (period > get_max_telemetry_period())
+	{
+		period = get_max_telemetry_period();
+	}
 
-	s_light_sequence++;
+	__HAL_TIM_SET_AUTORELOAD(&htim2, period);
+}
 
-	CANWrapper_Transmit(NODE_CDH, &msg);
+// puts back the counters of the experiments that were running.
+static void restore_warm_counters(const WarmState *state)
+{
+	s_sequences[SENSOR_THERMISTOR] = state->temp_sequence;
+	s_sequences[SENSOR_PHOTOCELL] = state->light_sequence;
 }
 
-/*
-static void process_errors(ErrorBuffer *p_error_buffer)
+// puts back the heater and LED outputs of the experiments that were running.
+static void restore_warm_outputs(const WarmState *state)
 {
-	if (ErrorBuffer_Has_Error(p_error_buffer))
+	if (!Heaters_Set_All(state->heaters))
 	{
-		CANMessage error_report;
-		error_report.cmd = CMD_CDH_PROCESS_RUNTIME_ERROR;
-		//SET_ARG(error_report, 0, *p_error_buffer); // TODO
-
-		CANWrapper_Transmit(NODE_CDH, &error_report);
-
-		ErrorBuffer_Clear(p_error_buffer);
+		PRINT_ERROR("failed to restore heaters.");
+	}
+	if (!LEDs_Set_All(state->leds))
+	{
+		PRINT_ERROR("failed to restore LEDs.");
 	}
 }
-*/
 
-static void print_well_info()
+static void capture_warm_state(WarmState *out)
 {
-	uint16_t therm_data[16];
-	uint16_t light_data[16];
+	memset(out, 0, sizeof(*out));
+
+	LED_Programs_Get_States(out->led_programs);
+	out->heaters = Heaters_Get_All();
+	out->leds = LEDs_Get_All();
+	out->temp_sequence = s_sequences[SENSOR_THERMISTOR];
+	out->light_sequence = s_sequences[SENSOR_PHOTOCELL];
+}
 
-	uint16_t temp;
+// sends one frame per boot stage.
+static void report_boot_timeline()
+{
+	const BootStageRecord *timeline = Boot_Get_Timeline();
 
-	for (int i = 0; i < 16; i++)
+	for (int i = 0; i < NUM_BOOT_STAGES; i++)
 	{
-		Thermistors_Get_Temp(i, &temp);
-		therm_data[i] = temp;
-
-		Photocells_Get_Light_Level(i, &temp);
-		light_data[i] = temp;
+		const BootStageRecord *record = &timeline[i];
+
+		// times are sent as 24 bit values, which saturate at ~16.7 s.
+		uint32_t start = record->start < 0xFFFFFF ? record->start : 0xFFFFFF;
+		uint32_t duration = record->end - record->start;
+		if (record->end < record->start || duration > 0xFFFFFF)
+			duration = 0xFFFFFF;
+
+		CANMessage msg;
+		msg.cmd = CMD_CDH_PROCESS_BOOT_TIMELINE;
+		SET_ARG(msg, 0, uint8_t, (uint8_t)(i | (record->status << 4)));
+		SET_ARG(msg, 1, uint8_t, (uint8_t)(start));
+		SET_ARG(msg, 2, uint8_t, (uint8_t)(start >> 8));
+		SET_ARG(msg, 3, uint8_t, (uint8_t)(start >> 16));
+		SET_ARG(msg, 4, uint8_t, (uint8_t)(duration));
+		SET_ARG(msg, 5, uint8_t, (uint8_t)(duration >> 8));
+		SET_ARG(msg, 6, uint8_t, (uint8_t)(duration >> 16));
+
+		CANWrapper_Transmit(NODE_CDH, &msg);
 	}
+}
+
+// sends the peak stack use overall, then on entry to each interrupt handler.
+static void report_stack_usage()
+{
+	Stack_Monitor_Check();
 
-	PRINT_INFO("_________________________");
-	PRINT_INFO("| WELL  | TEMPS | LIGHT |");
-	PRINT_INFO("|-----------------------|");
-	for (int i = WELL_0; i <= WELL_15; i++)
+	for (int i = -1; i < NUM_STACK_ISRS; i++)
 	{
-		PRINT_INFO("| %6d| %6d| %6d|", i, therm_data[i], light_data[i]);
+		uint32_t peak = i < 0 ? Stack_Monitor_Get_Peak() : Stack_Monitor_Get_ISR_Peak(i);
+
+		CANMessage msg;
+		msg.cmd = CMD_CDH_PROCESS_STACK_USAGE;
+		SET_ARG(msg, 0, uint8_t, (uint8_t)(i < 0 ? 0xFF : i)); // 0xFF is overall.
+		SET_ARG(msg, 1, uint16_t, (uint16_t)peak);
+		SET_ARG(msg, 3, uint16_t, (uint16_t)Stack_Monitor_Get_Size());
+
+		CANWrapper_Transmit(NODE_CDH, &msg);
 	}
-	PRINT_INFO("-------------------------");
 }
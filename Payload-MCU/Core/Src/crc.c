@@ -0,0 +1,331 @@
+/*
+ * crc.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "crc.h"
+#if CRC_USE_HARDWARE
+#include "main.h"
+#include "profile.h"
+#include "tuk/debug/print.h"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// reflected CRC-32 remainders for every 4-bit value.
+static const uint32_t NIBBLE_TABLE[] = {
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+		0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+		0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+#if CRC_USE_HARDWARE
+
+static const size_t MIN_DMA_SIZE = 256;     // below this, setting up DMA costs more than it saves.
+static const uint32_t MAX_DMA_WORDS = 0xFFFF; // per DMA transfer.
+
+// the self-check runs over the start of flash, at these offsets and sizes,
+// to cover every alignment of the head and tail.
+static const uint32_t CHECK_OFFSETS[] = { 0, 1, 2, 3 };
+static const uint32_t CHECK_SIZES[] = { 0, 1, 3, 4, 7, 64, 1021, 1024 };
+
+static bool s_hardware_ok = false;
+static bool s_dma_busy = false;
+static const uint8_t *s_dma_data;   // the buffer being checksummed by DMA.
+static size_t s_dma_size;
+static const uint8_t *s_dma_next;   // next word for DMA to feed.
+static uint32_t s_dma_words;        // words left for DMA after the current transfer.
+static const uint8_t *s_dma_tail;   // bytes left over after the last whole word.
+static size_t s_dma_tail_size;
+
+static void hardware_begin();
+static void hardware_feed_bytes(const uint8_t *bytes, size_t size);
+static uint32_t hardware_end();
+static uint32_t compute_hardware(const void *data, size_t size);
+static void start_dma(const void *data, size_t size);
+static void start_dma_transfer();
+
+#define PRINT_SUBJECT "CRC"
+
+bool CRC_Init()
+{
+	RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN | RCC_AHB1ENR_DMA1EN;
+	(void)RCC->AHB1ENR; // wait for the clocks to come up.
+
+	Profile_Init();
+
+	const uint8_t *flash = (const uint8_t *)FLASH_BASE;
+
+	for (uint32_t i = 0; i < sizeof(CHECK_OFFSETS) / sizeof(CHECK_OFFSETS[0]); i++)
+	{
+		for (uint32_t j = 0; j < sizeof(CHECK_SIZES) / sizeof(CHECK_SIZES[0]); j++)
+		{
+			const uint8_t *data = flash + CHECK_OFFSETS[i];
+			size_t size = CHECK_SIZES[j];
+
+			uint32_t expected = CRC_Compute_Software(data, size);
+			uint32_t actual = compute_hardware(data, size);
+			if (actual != expected)
+			{
+				PRINT_ERROR("peripheral CRC of %u bytes at +%lu is %08lX, expected %08lX. using software.",
+						size, CHECK_OFFSETS[i], actual, expected);
+				return false;
+			}
+
+			if (size < MIN_DMA_SIZE)
+				continue;
+
+			start_dma(data, size);
+			bool done = false;
+			while (s_dma_busy && !done)
+				done = CRC_Poll(&actual);
+
+			if (!done || actual != expected)
+			{
+				PRINT_ERROR("DMA CRC of %u bytes at +%lu is %08lX, expected %08lX. using software.",
+						size, CHECK_OFFSETS[i], actual, expected);
+				return false;
+			}
+		}
+	}
+
+	// bytes per 1000 cycles, as printf doesn't do floats.
+	size_t bench_size = 4096;
+	uint32_t start = Profile_Cycles();
+	CRC_Compute_Software(flash, bench_size);
+	uint32_t software_cycles = Profile_Cycles() - start;
+
+	start = Profile_Cycles();
+	compute_hardware(flash, bench_size);
+	uint32_t hardware_cycles = Profile_Cycles() - start;
+
+	uint32_t crc;
+	start = Profile_Cycles();
+	start_dma(flash, bench_size);
+	while (!CRC_Poll(&crc));
+	uint32_t dma_cycles = Profile_Cycles() - start;
+
+	PRINT_INFO("bytes/kcycle: software %lu, peripheral %lu, peripheral with DMA %lu.",
+			bench_size * 1000 / software_cycles, bench_size * 1000 / hardware_cycles,
+			bench_size * 1000 / dma_cycles);
+
+	s_hardware_ok = true;
+	return true;
+}
+
+uint32_t CRC_Compute(const void *data, size_t size)
+{
+	if (!s_hardware_ok || s_dma_busy)
+		return CRC_Compute_Software(data, size);
+
+	return compute_hardware(data, size);
+}
+
+bool CRC_Start(const void *data, size_t size)
+{
+	if (!s_hardware_ok || s_dma_busy)
+		return false;
+
+	start_dma(data, size);
+	return true;
+}
+
+bool CRC_Poll(uint32_t *out)
+{
+	if (!s_dma_busy)
+		return false;
+
+	if (DMA1_Channel1->CCR & DMA_CCR_EN)
+	{
+		if (DMA1->ISR & DMA_ISR_TEIF1)
+		{
+			// shouldn't happen. stop using the peripheral, and start over in software.
+			DMA1_Channel1->CCR = 0;
+			DMA1->IFCR = DMA_IFCR_CGIF1;
+			PRINT_ERROR("DMA error while computing CRC. using software.");
+			s_dma_busy = false;
+			s_hardware_ok = false;
+			*out = CRC_Compute_Software(s_dma_data, s_dma_size);
+			return true;
+		}
+
+		if (!(DMA1->ISR & DMA_ISR_TCIF1))
+			return false;
+
+		DMA1_Channel1->CCR = 0;
+		DMA1->IFCR = DMA_IFCR_CGIF1;
+	}
+
+	if (s_dma_words > 0)
+	{
+		start_dma_transfer();
+		return false;
+	}
+
+	hardware_feed_bytes(s_dma_tail, s_dma_tail_size);
+	*out = hardware_end();
+	s_dma_busy = false;
+
+	return true;
+}
+
+void CRC_Abort()
+{
+	DMA1_Channel1->CCR = 0;
+	DMA1->IFCR = DMA_IFCR_CGIF1;
+	s_dma_busy = false;
+}
+
+#else
+
+uint32_t CRC_Compute(const void *data, size_t size)
+{
+	return CRC_Compute_Software(data, size);
+}
+
+bool CRC_Init()
+{
+	return false;
+}
+
+bool CRC_Start(const void *data, size_t size)
+{
+	return false;
+}
+
+bool CRC_Poll(uint32_t *out)
+{
+	return false;
+}
+
+void CRC_Abort()
+{
+}
+
+#endif
+
+uint32_t CRC_Compute_Software(const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+	uint32_t crc = 0xFFFFFFFF;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		crc ^= bytes[i];
+		crc = (crc >> 4) ^ NIBBLE_TABLE[crc & 0x0F];
+		crc = (crc >> 4) ^ NIBBLE_TABLE[crc & 0x0F];
+	}
+
+	return ~crc;
+}
+
+#if CRC_USE_HARDWARE
+
+/**
+ * @brief Resets the peripheral for a new reflected CRC-32.
+ */
+static void hardware_begin()
+{
+	CRC->POL = 0x04C11DB7;
+	CRC->INIT = 0xFFFFFFFF;
+	CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_OUT | CRC_CR_RESET; // input reflected by byte.
+}
+
+static void hardware_feed_bytes(const uint8_t *bytes, size_t size)
+{
+	CRC->CR = (CRC->CR & ~CRC_CR_REV_IN) | CRC_CR_REV_IN_0;
+	for (size_t i = 0; i < size; i++)
+	{
+		*(__IO uint8_t *)&CRC->DR = bytes[i];
+	}
+}
+
+static uint32_t hardware_end()
+{
+	return ~CRC->DR;
+}
+
+/**
+ * @brief Computes a CRC with the peripheral, fed by the CPU.
+ */
+static uint32_t compute_hardware(const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+
+	size_t head = (4 - ((uintptr_t)bytes & 3)) & 3;
+	if (head > size)
+		head = size;
+
+	hardware_begin();
+	hardware_feed_bytes(bytes, head);
+	bytes += head;
+	size -= head;
+
+	// a whole word is only reflected in memory order when reversed as a word.
+	CRC->CR |= CRC_CR_REV_IN;
+	const uint32_t *words = (const uint32_t *)bytes;
+	for (size_t i = 0; i < size / 4; i++)
+	{
+		CRC->DR = words[i];
+	}
+
+	hardware_feed_bytes(bytes + (size & ~3), size & 3);
+
+	return hardware_end();
+}
+
+/**
+ * @brief Feeds the unaligned head of a buffer to the peripheral, then starts
+ *        DMA on the words after it.
+ */
+static void start_dma(const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+	s_dma_data = bytes;
+	s_dma_size = size;
+
+	// DMA needs word aligned addresses. feed the bytes up to one directly.
+	size_t head = (4 - ((uintptr_t)bytes & 3)) & 3;
+	if (head > size)
+		head = size;
+
+	hardware_begin();
+	hardware_feed_bytes(bytes, head);
+
+	s_dma_next = bytes + head;
+	s_dma_words = (size - head) / 4;
+	s_dma_tail = s_dma_next + s_dma_words * 4;
+	s_dma_tail_size = (size - head) & 3;
+	s_dma_busy = true;
+
+	start_dma_transfer();
+}
+
+/**
+ * @brief Starts DMA on the next run of words, up to what one transfer can do.
+ */
+static void start_dma_transfer()
+{
+	uint32_t words = s_dma_words > MAX_DMA_WORDS ? MAX_DMA_WORDS : s_dma_words;
+
+	CRC->CR |= CRC_CR_REV_IN;
+
+	// in memory to memory mode, the "peripheral" is the source.
+	DMA1_Channel1->CCR = 0;
+	DMA1->IFCR = DMA_IFCR_CGIF1;
+	DMA1_Channel1->CPAR = (uint32_t)s_dma_next;
+	DMA1_Channel1->CMAR = (uint32_t)&CRC->DR;
+	DMA1_Channel1->CNDTR = words;
+	DMA1_Channel1->CCR = DMA_CCR_MEM2MEM | DMA_CCR_PINC | DMA_CCR_PSIZE_1 | DMA_CCR_MSIZE_1;
+	if (words > 0)
+		DMA1_Channel1->CCR |= DMA_CCR_EN;
+
+	s_dma_next += words * 4;
+	s_dma_words -= words;
+}
+
+#endif
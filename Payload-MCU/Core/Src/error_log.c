@@ -0,0 +1,175 @@
+/*
+ * error_log.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Counts runtime errors and reports them to CDH without flooding
+ *           the bus.
+ */
+
+#include "error_log.h"
+#include "pp.h"
+#include "main.h"
+#include "tuk/tuk.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+static const uint32_t REPORT_INTERVAL = 1000; // in ms. least time between reports of the same error.
+static const uint32_t REFILL_PERIOD = 250;    // in ms. time to earn another report.
+static const uint32_t MAX_CREDIT = 4;         // reports that can be sent at once.
+
+static const char *const ERROR_NAMES[] = {
+		"CAN wrapper init",
+		"CAN transmit",
+		"unknown command",
+		"I2C transfer",
+		"I2C bus stuck",
+		"invalid well id",
+		"TCA9539 init",
+		"TCA9539 invalid expander",
+		"TCA9539 invalid pin",
+		"TCA9539 transfer",
+		"TCA9539 set pin",
+		"TCA9548 invalid channel",
+		"TCA9548 set channel",
+		"sensor read",
+		"sensor implausible",
+		"sensor quarantined",
+		"heater held off",
+		"ADC calibration",
+		"ADC start",
+		"ADC poll",
+		"ADC get value",
+		"flash write",
+		"flash log write",
+		"bulk timeout",
+		"stack low",
+		"fault",
+		"invalid argument",
+		"self test",
+};
+
+CASSERT(sizeof(ERROR_NAMES) / sizeof(ERROR_NAMES[0]) == NUM_ERRORS, error_log)
+
+typedef struct
+{
+	uint32_t count;       // since boot. written from interrupts.
+	uint32_t first;       // HAL tick of the first since the last report. 0 if none.
+	uint32_t last;        // HAL tick of the last.
+	uint32_t arg;         // of the last.
+	uint32_t reported;    // count when last reported.
+	uint32_t last_report; // HAL tick.
+} ErrorRecord;
+
+static ErrorRecord s_records[NUM_ERRORS];
+static uint32_t s_credit = MAX_CREDIT;
+static uint32_t s_last_refill = 0;
+
+static void report(ErrorID id, uint32_t now);
+
+#define PRINT_SUBJECT "Errors"
+
+void Error_Log_Put(ErrorID id, uint32_t arg)
+{
+	if (id >= NUM_ERRORS)
+		return;
+
+	ErrorRecord *record = &s_records[id];
+
+	uint32_t now = HAL_GetTick();
+	if (now == 0)
+		now = 1; // 0 means there is no first occurrence.
+
+	// only the first since the last report sets the time. the rest are
+	// plain stores, as a torn pair only mixes up two occurrences.
+	uint32_t none = 0;
+	__atomic_compare_exchange_n(&record->first, &none, now, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+	record->last = now;
+	record->arg = arg;
+
+	__atomic_fetch_add(&record->count, 1, __ATOMIC_RELEASE);
+}
+
+void Error_Log_Update()
+{
+	uint32_t now = HAL_GetTick();
+
+	uint32_t earned = (now - s_last_refill) / REFILL_PERIOD;
+	if (earned > 0)
+	{
+		s_last_refill += earned * REFILL_PERIOD;
+		s_credit = s_credit + earned > MAX_CREDIT ? MAX_CREDIT : s_credit + earned;
+	}
+
+	for (int id = 0; id < NUM_ERRORS && s_credit > 0; id++)
+	{
+		ErrorRecord *record = &s_records[id];
+
+		if (__atomic_load_n(&record->count, __ATOMIC_ACQUIRE) == record->reported)
+			continue;
+		if (record->reported != 0 && now - record->last_report < REPORT_INTERVAL)
+			continue;
+
+		report(id, now);
+		s_credit--;
+	}
+}
+
+uint32_t Error_Log_Get_Count(ErrorID id)
+{
+	if (id >= NUM_ERRORS)
+		return 0;
+
+	return __atomic_load_n(&s_records[id].count, __ATOMIC_ACQUIRE);
+}
+
+void Error_Log_Print()
+{
+	for (int id = 0; id < NUM_ERRORS; id++)
+	{
+		const ErrorRecord *record = &s_records[id];
+		if (record->count == 0)
+			continue;
+
+		PRINT_INFO("%-24s x%lu, last at %lu ms (arg: 0x%08lX)",
+				ERROR_NAMES[id], record->count, record->last, record->arg);
+	}
+}
+
+/**
+ * @brief Sends and prints the errors of one kind since the last report.
+ */
+static void report(ErrorID id, uint32_t now)
+{
+	ErrorRecord *record = &s_records[id];
+
+	// an error recorded between these two reads is counted in the next
+	// report, with its time in this one.
+	uint32_t count = __atomic_load_n(&record->count, __ATOMIC_ACQUIRE);
+	uint32_t first = __atomic_exchange_n(&record->first, 0, __ATOMIC_RELAXED);
+	uint32_t last = record->last;
+	uint32_t arg = record->arg;
+
+	if (first == 0)
+		first = last;
+
+	uint32_t occurrences = count - record->reported;
+	record->reported = count;
+	record->last_report = now;
+
+	PRINT_ERROR("%s x%lu over %lu ms (arg: 0x%08lX)", ERROR_NAMES[id], occurrences, last - first, arg);
+
+	uint32_t first_age = now - first;
+	uint32_t last_age = now - last;
+
+	// counts and ages saturate rather than wrap.
+	CANMessage msg;
+	msg.cmd = CMD_CDH_PROCESS_RUNTIME_ERROR;
+	SET_ARG(msg, 0, uint8_t, (uint8_t)id);
+	SET_ARG(msg, 1, uint16_t, (uint16_t)(occurrences > UINT16_MAX ? UINT16_MAX : occurrences));
+	SET_ARG(msg, 3, uint16_t, (uint16_t)(first_age > UINT16_MAX ? UINT16_MAX : first_age));
+	SET_ARG(msg, 5, uint16_t, (uint16_t)(last_age > UINT16_MAX ? UINT16_MAX : last_age));
+
+	CANWrapper_Transmit(NODE_CDH, &msg);
+}
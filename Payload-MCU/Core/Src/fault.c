@@ -0,0 +1,266 @@
+/*
+ * fault.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Records the state of the CPU when a fault occurs, so resets in the
+ *           field can be diagnosed without a debugger.
+ */
+
+#include "fault.h"
+#include "crc.h"
+#include "error_log.h"
+#include "flash_log.h"
+#include "placement.h"
+#include "pp.h"
+#include "main.h"
+#include "tuk/tuk.h"
+#include "payload_cmds.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+static const uint32_t FAULT_MAGIC = 0x544C5546; // "FULT"
+static const uint32_t MAX_SCAN_WORDS = 256;    // of the stack, searched for return addresses.
+
+// exception frame, as stacked by the CPU.
+enum {
+	FRAME_R0 = 0,
+	FRAME_R1,
+	FRAME_R2,
+	FRAME_R3,
+	FRAME_R12,
+	FRAME_LR,
+	FRAME_PC,
+	FRAME_XPSR,
+	FRAME_WORDS
+};
+
+#define FRAME_FP_WORDS 18          // extra words stacked when the FPU is in use.
+#define EXC_RETURN_PSP (1 << 2)    // the frame is on the process stack.
+#define EXC_RETURN_NO_FP (1 << 4)  // the frame has no FPU registers.
+#define XPSR_ALIGNED (1 << 9)      // a padding word was stacked to align it.
+
+// one CAN frame per field, up to the CRC.
+CASSERT(offsetof(FaultRecord, crc) / sizeof(uint32_t) < UINT8_MAX, fault)
+
+extern uint32_t _etext;
+extern uint32_t _estack;
+
+static FaultRecord s_record NOINIT;
+
+static void capture_fault(const uint32_t *frame, uint32_t exc_return, FaultType type) __attribute__((used, noreturn));
+static void finish_record(uint32_t sp) __attribute__((noreturn));
+static bool is_on_stack(uint32_t address, uint32_t size);
+static bool is_return_address(uint32_t value);
+
+#define PRINT_SUBJECT "Fault"
+
+/*
+ * The fault handlers are naked, so the stack they were entered with is
+ * untouched. They pass the stacked frame, found from EXC_RETURN, on to
+ * capture_fault.
+ */
+#define FAULT_HANDLER(name, type) \
+	__attribute__((naked)) void name(void) \
+	{ \
+		__asm volatile( \
+				"tst lr, #4 \n" \
+				"ite eq \n" \
+				"mrseq r0, msp \n" \
+				"mrsne r0, psp \n" \
+				"mov r1, lr \n" \
+				"movs r2, %0 \n" \
+				"b capture_fault \n" \
+				: : "i" (type)); \
+	}
+
+FAULT_HANDLER(HardFault_Handler, FAULT_HARD)
+FAULT_HANDLER(MemManage_Handler, FAULT_MEM_MANAGE)
+FAULT_HANDLER(BusFault_Handler, FAULT_BUS)
+FAULT_HANDLER(UsageFault_Handler, FAULT_USAGE)
+
+void Fault_Init()
+{
+	SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_USGFAULTENA_Msk;
+}
+
+bool Fault_Report()
+{
+	size_t size = offsetof(FaultRecord, crc);
+
+	if (s_record.magic != FAULT_MAGIC || s_record.crc != CRC_Compute(&s_record, size))
+		return false;
+
+	// only ever report it once. the copy keeps its magic, so the flash log
+	// and CDH get a record that passes its own check.
+	FaultRecord record = s_record;
+	s_record.magic = 0;
+
+	PRINT_ERROR("reset by fault %lu at uptime %lu ms.", record.type, record.uptime);
+	PRINT_ERROR("pc: %08lx, lr: %08lx, sp: %08lx, xpsr: %08lx",
+			record.pc, record.lr, record.sp, record.xpsr);
+	PRINT_ERROR("cfsr: %08lx, hfsr: %08lx, mmfar: %08lx, bfar: %08lx",
+			record.cfsr, record.hfsr, record.mmfar, record.bfar);
+	for (int i = 0; i < FAULT_BACKTRACE_DEPTH && record.backtrace[i] != 0; i++)
+	{
+		PRINT_ERROR("  #%d %08lx", i, record.backtrace[i]);
+	}
+	Error_Log_Put(ERROR_FAULT, record.type);
+
+	// byte 0 is the index of the field, in FaultRecord order.
+	const uint32_t *fields = (const uint32_t *)&record;
+	for (uint32_t i = 0; i < size / sizeof(uint32_t); i++)
+	{
+		CANMessage msg;
+		msg.cmd = CMD_CDH_PROCESS_FAULT_REPORT;
+		SET_ARG(msg, 0, uint8_t, (uint8_t)i);
+		SET_ARG(msg, 1, uint32_t, fields[i]);
+
+		CANWrapper_Transmit(NODE_CDH, &msg);
+	}
+
+	if (!Flash_Log_Append_Record(FLASH_LOG_FAULT, &record, sizeof(record)))
+	{
+		PRINT_ERROR("failed to log the fault.");
+	}
+
+	return true;
+}
+
+void Fault_Capture_Error(uint32_t caller)
+{
+	__disable_irq();
+
+	s_record.type = FAULT_ERROR_HANDLER;
+	s_record.r0 = 0;
+	s_record.r1 = 0;
+	s_record.r2 = 0;
+	s_record.r3 = 0;
+	s_record.r12 = 0;
+	s_record.lr = 0;
+	s_record.pc = caller;
+	s_record.xpsr = __get_xPSR();
+	s_record.exc_return = 0;
+
+	finish_record(__get_MSP());
+}
+
+/**
+ * @brief Records a fault, then resets.
+ *
+ * @param frame			The frame stacked on entry to the fault handler.
+ * @param exc_return	The EXC_RETURN value the handler was entered with.
+ * @param type			The handler.
+ */
+static void capture_fault(const uint32_t *frame, uint32_t exc_return, FaultType type)
+{
+	s_record.type = type;
+	s_record.exc_return = exc_return;
+
+	uint32_t frame_words = FRAME_WORDS;
+	if ((exc_return & EXC_RETURN_NO_FP) == 0)
+		frame_words += FRAME_FP_WORDS;
+
+	// the frame can't be trusted if stacking it is what faulted.
+	if (is_on_stack((uint32_t)frame, frame_words * sizeof(uint32_t)))
+	{
+		s_record.r0 = frame[FRAME_R0];
+		s_record.r1 = frame[FRAME_R1];
+		s_record.r2 = frame[FRAME_R2];
+		s_record.r3 = frame[FRAME_R3];
+		s_record.r12 = frame[FRAME_R12];
+		s_record.lr = frame[FRAME_LR];
+		s_record.pc = frame[FRAME_PC];
+		s_record.xpsr = frame[FRAME_XPSR];
+
+		uint32_t sp = (uint32_t)(frame + frame_words);
+		if (s_record.xpsr & XPSR_ALIGNED)
+			sp += sizeof(uint32_t);
+
+		finish_record(sp);
+	}
+
+	s_record.r0 = 0;
+	s_record.r1 = 0;
+	s_record.r2 = 0;
+	s_record.r3 = 0;
+	s_record.r12 = 0;
+	s_record.lr = 0;
+	s_record.pc = 0;
+	s_record.xpsr = 0;
+
+	finish_record((uint32_t)frame);
+}
+
+/**
+ * @brief Fills in the rest of the record, seals it, then resets.
+ *
+ * @param sp	The stack pointer of the code that faulted.
+ */
+static void finish_record(uint32_t sp)
+{
+	s_record.sp = sp;
+	s_record.cfsr = SCB->CFSR;
+	s_record.hfsr = SCB->HFSR;
+	s_record.mmfar = SCB->MMFAR;
+	s_record.bfar = SCB->BFAR;
+	s_record.uptime = HAL_GetTick();
+
+	// a return address is not always a caller, but the words on the stack
+	// that point just after a call are the best guess there is without
+	// unwind tables.
+	uint32_t depth = 0;
+	if (is_on_stack(sp & ~3u, sizeof(uint32_t)))
+	{
+		const uint32_t *word = (const uint32_t *)(sp & ~3u);
+		const uint32_t *end = &_estack;
+
+		for (uint32_t i = 0; i < MAX_SCAN_WORDS && word < end && depth < FAULT_BACKTRACE_DEPTH; i++, word++)
+		{
+			if (is_return_address(*word))
+				s_record.backtrace[depth++] = *word & ~1u;
+		}
+	}
+	while (depth < FAULT_BACKTRACE_DEPTH)
+		s_record.backtrace[depth++] = 0;
+
+	s_record.magic = FAULT_MAGIC;
+	s_record.crc = CRC_Compute_Software(&s_record, offsetof(FaultRecord, crc));
+
+	// reset now rather than waiting on the watchdog, to lose less time.
+	__DSB();
+	NVIC_SystemReset();
+}
+
+/**
+ * @brief Checks that a block lies within main RAM, where the stack is.
+ */
+static bool is_on_stack(uint32_t address, uint32_t size)
+{
+	return address >= SRAM1_BASE && address <= (uint32_t)&_estack - size;
+}
+
+/**
+ * @brief Checks whether a word is the return address of a BL or BLX.
+ */
+static bool is_return_address(uint32_t value)
+{
+	// thumb addresses are odd.
+	if ((value & 1) == 0)
+		return false;
+
+	uint32_t address = value & ~1u;
+	if (address < FLASH_BASE + 4 || address > (uint32_t)&_etext)
+		return false;
+
+	// BL <label> is the only 32-bit call.
+	uint16_t high = *(const uint16_t *)(address - 4);
+	uint16_t low = *(const uint16_t *)(address - 2);
+	if ((high & 0xF800) == 0xF000 && (low & 0xD000) == 0xD000)
+		return true;
+
+	// BLX <register>.
+	return (low & 0xFF87) == 0x4780;
+}
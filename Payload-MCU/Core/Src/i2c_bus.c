@@ -0,0 +1,585 @@
+/*
+ * i2c_bus.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Shared access to I2C1 that keeps a dead device or a stuck bus from
+ *           stalling everything else on it.
+ */
+
+#include "i2c_bus.h"
+#include "i2c.h"
+#include "timebase.h"
+#include "main.h"
+#include "pp.h"
+#include "error_log.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "tuk/debug/print.h"
+
+#define MAX_DEVICES 40 // mux, expanders and 32 ADCs, with room to spare.
+#define NUM_SEGMENTS 9 // 8 mux channels, then the root.
+
+static const uint32_t INITIAL_TIMEOUT = 10; // in ms. used until a device's latency is known.
+static const uint32_t MIN_TIMEOUT = 2;      // in ms. the first HAL tick can be partial.
+static const uint32_t MAX_TIMEOUT = 100;    // in ms.
+static const uint16_t LEARNING_SAMPLES = 4; // transfers timed before the timeout adapts.
+
+static const uint8_t QUARANTINE_THRESHOLD = 3;  // consecutive failures.
+static const uint32_t QUARANTINE_BASE = 1000;   // in ms. doubles on every failed retry.
+static const uint8_t MAX_BACKOFF = 8;           // caps the quarantine at ~4 minutes.
+
+static const uint32_t HALF_CLOCK = 5;           // in us. bus clear runs at 100 kHz.
+static const uint32_t STRETCH_LIMIT = 1000;     // in us. longest clock stretch waited for.
+
+// analogue filter delay, in ns.
+static const uint32_t FILTER_DELAY_MIN = 50;
+static const uint32_t FILTER_DELAY_MAX = 260;
+
+// edge times estimated for the board's pull-ups, in ns. each speed uses these
+// unless its own limit is lower. the speed self-test catches them being wrong.
+static const uint32_t BUS_RISE_TIME = 100;
+static const uint32_t BUS_FALL_TIME = 10;
+
+// I2C specification limits for each speed. times are in ns.
+typedef struct
+{
+	uint32_t frequency;  // in Hz.
+	uint32_t low_min;    // SCL low period.
+	uint32_t high_min;   // SCL high period.
+	uint32_t rise_max;
+	uint32_t fall_max;
+	uint32_t setup_min;  // data setup time.
+	uint32_t valid_max;  // data valid time.
+} SpeedSpec;
+
+static const SpeedSpec SPEED_SPECS[] = {
+		{  100000, 4700, 4000, 1000, 300, 250, 3450 }, // I2C_SPEED_STANDARD
+		{  400000, 1300,  600,  300, 300, 100,  900 }, // I2C_SPEED_FAST
+		{ 1000000,  500,  260,  120, 120,  50,  450 }, // I2C_SPEED_FAST_PLUS
+};
+
+CASSERT(sizeof(SPEED_SPECS) / sizeof(SPEED_SPECS[0]) == NUM_I2C_SPEEDS, i2c_bus)
+
+#define I2C_PORT GPIOA
+#define SCL_PIN GPIO_PIN_9
+#define SDA_PIN GPIO_PIN_10
+
+typedef enum {
+	TRANSFER_TRANSMIT,
+	TRANSFER_RECEIVE,
+	TRANSFER_PROBE
+} TransferType;
+
+typedef struct
+{
+	uint8_t segment;
+	uint8_t address;         // 7-bit. 0 marks an unused record.
+	uint8_t failures;        // consecutive failed transfers.
+	uint8_t backoff;         // the next quarantine lasts QUARANTINE_BASE << backoff.
+	bool quarantined;
+	uint16_t samples;        // successful transfers timed. saturates.
+	uint32_t latency;        // smoothed latency per byte, in 1/8 us.
+	uint32_t deviation;      // smoothed mean deviation of the latency, in 1/4 us.
+	uint32_t quarantine_end; // HAL tick the quarantine ends at.
+	uint32_t total_failures;
+} DeviceHealth;
+
+static DeviceHealth s_devices[MAX_DEVICES];
+static uint32_t s_recoveries = 0;
+static uint32_t s_faults = 0;
+static I2CSpeed s_speeds[NUM_SEGMENTS];          // all start at I2C_SPEED_STANDARD.
+static I2CSpeed s_applied_speed = NUM_I2C_SPEEDS; // timing currently in I2C1. none yet.
+
+static bool transfer(TransferType type, uint8_t segment, uint8_t address, uint8_t *data, uint16_t size);
+static DeviceHealth *get_device(uint8_t segment, uint8_t address);
+static bool is_quarantined(const DeviceHealth *device);
+static uint32_t get_timeout(const DeviceHealth *device, uint16_t size);
+static void record_success(DeviceHealth *device, uint32_t elapsed, uint16_t size);
+static void record_failure(DeviceHealth *device);
+static int get_segment_index(uint8_t segment);
+static bool apply_speed(I2CSpeed speed);
+static uint32_t compute_timing(I2CSpeed speed, uint32_t clock);
+static uint32_t div_ceil(uint32_t a, uint32_t b);
+static bool is_bus_stuck();
+static bool wait_for_scl();
+static void delay_us(uint32_t us);
+
+#define PRINT_SUBJECT "I2C Bus"
+
+bool I2C_Bus_Transmit(uint8_t segment, uint8_t address, const uint8_t *data, uint16_t size)
+{
+	// HAL doesn't take const, but only reads from the buffer.
+	return transfer(TRANSFER_TRANSMIT, segment, address, (uint8_t *)data, size);
+}
+
+bool I2C_Bus_Receive(uint8_t segment, uint8_t address, uint8_t *data, uint16_t size)
+{
+	return transfer(TRANSFER_RECEIVE, segment, address, data, size);
+}
+
+bool I2C_Bus_Probe(uint8_t segment, uint8_t address)
+{
+	return transfer(TRANSFER_PROBE, segment, address, NULL, 0);
+}
+
+bool I2C_Bus_Is_Quarantined(uint8_t segment, uint8_t address)
+{
+	return is_quarantined(get_device(segment, address));
+}
+
+bool I2C_Bus_Set_Speed(uint8_t segment, I2CSpeed speed)
+{
+	int index = get_segment_index(segment);
+	if (index < 0 || speed >= NUM_I2C_SPEEDS)
+	{
+		PRINT_ERROR("invalid speed %d for segment %d.", speed, segment);
+		return false;
+	}
+
+	s_speeds[index] = speed;
+
+	return true;
+}
+
+I2CSpeed I2C_Bus_Get_Speed(uint8_t segment)
+{
+	int index = get_segment_index(segment);
+
+	return index < 0 ? I2C_SPEED_STANDARD : s_speeds[index];
+}
+
+uint32_t I2C_Bus_Get_Frequency(I2CSpeed speed)
+{
+	return speed < NUM_I2C_SPEEDS ? SPEED_SPECS[speed].frequency : 0;
+}
+
+void I2C_Bus_Reset_Health()
+{
+	memset(s_devices, 0, sizeof(s_devices));
+}
+
+uint32_t I2C_Bus_Get_Fault_Count()
+{
+	return s_faults;
+}
+
+bool I2C_Bus_Recover()
+{
+	s_recoveries++;
+	s_faults++;
+	PRINT_INFO("clearing stuck bus. (recovery %lu)", s_recoveries);
+
+	HAL_I2C_DeInit(&hi2c1);
+
+	// take over the pins to clock the bus by hand.
+	GPIO_InitTypeDef gpio = {0};
+	gpio.Pin = SCL_PIN | SDA_PIN;
+	gpio.Mode = GPIO_MODE_OUTPUT_OD;
+	gpio.Pull = GPIO_NOPULL;
+	gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_WritePin(I2C_PORT, SCL_PIN | SDA_PIN, GPIO_PIN_SET);
+	HAL_GPIO_Init(I2C_PORT, &gpio);
+	wait_for_scl();
+
+	// a slave holding SDA is part way through sending a byte. up to 9 clocks
+	// let it finish the byte and see a NACK, after which it releases SDA.
+	for (int i = 0; i < 9 && HAL_GPIO_ReadPin(I2C_PORT, SDA_PIN) == GPIO_PIN_RESET; i++)
+	{
+		HAL_GPIO_WritePin(I2C_PORT, SCL_PIN, GPIO_PIN_RESET);
+		delay_us(HALF_CLOCK);
+		HAL_GPIO_WritePin(I2C_PORT, SCL_PIN, GPIO_PIN_SET);
+		wait_for_scl();
+		delay_us(HALF_CLOCK);
+	}
+
+	// send a STOP so every slave goes back to idle.
+	HAL_GPIO_WritePin(I2C_PORT, SCL_PIN, GPIO_PIN_RESET);
+	delay_us(HALF_CLOCK);
+	HAL_GPIO_WritePin(I2C_PORT, SDA_PIN, GPIO_PIN_RESET);
+	delay_us(HALF_CLOCK);
+	HAL_GPIO_WritePin(I2C_PORT, SCL_PIN, GPIO_PIN_SET);
+	wait_for_scl();
+	delay_us(HALF_CLOCK);
+	HAL_GPIO_WritePin(I2C_PORT, SDA_PIN, GPIO_PIN_SET);
+	delay_us(HALF_CLOCK);
+
+	bool released = HAL_GPIO_ReadPin(I2C_PORT, SDA_PIN) == GPIO_PIN_SET
+			&& HAL_GPIO_ReadPin(I2C_PORT, SCL_PIN) == GPIO_PIN_SET;
+
+	// hands the pins back to the peripheral. this also restores the default
+	// timing, so the next transfer has to reapply its own.
+	MX_I2C1_Init();
+	s_applied_speed = NUM_I2C_SPEEDS;
+
+	if (!released || is_bus_stuck())
+	{
+		PRINT_ERROR("failed to clear the bus.");
+		Error_Log_Put(ERROR_I2C_BUS_STUCK, 0);
+		return false;
+	}
+
+	return true;
+}
+
+void I2C_Bus_Print_Health()
+{
+	PRINT_INFO("bus recoveries: %lu", s_recoveries);
+
+	for (int i = 0; i < MAX_DEVICES; i++)
+	{
+		const DeviceHealth *device = &s_devices[i];
+		if (device->address == 0)
+			continue;
+
+		PRINT_INFO("0x%02X on segment %3d: %4lu us/byte, timeout: %3lu ms, failures: %lu%s",
+				device->address, device->segment, device->latency / 8,
+				get_timeout(device, 1), device->total_failures,
+				device->quarantined ? " (quarantined)" : "");
+	}
+}
+
+/**
+ * @brief Runs a transfer with a timeout suited to the device, and keeps
+ *        track of how the device is doing.
+ *
+ * @return true on success. false on error.
+ */
+static bool transfer(TransferType type, uint8_t segment, uint8_t address, uint8_t *data, uint16_t size)
+{
+	if (hi2c1.State == HAL_I2C_STATE_RESET)
+	{
+		PRINT_ERROR("bus not initialised.");
+		return false;
+	}
+
+	DeviceHealth *device = get_device(segment, address);
+
+	if (is_quarantined(device))
+		return false;
+
+	// HAL would otherwise wait 25 ms for the bus before giving up.
+	if (is_bus_stuck() && !I2C_Bus_Recover())
+		return false;
+
+	if (!apply_speed(I2C_Bus_Get_Speed(segment)))
+		return false;
+
+	uint32_t timeout = get_timeout(device, size);
+	uint32_t start = Timebase_Local_Micros();
+
+	HAL_StatusTypeDef status;
+	switch (type)
+	{
+	case TRANSFER_TRANSMIT:
+		status = HAL_I2C_Master_Transmit(&hi2c1, address << 1, data, size, timeout);
+		break;
+	case TRANSFER_RECEIVE:
+		status = HAL_I2C_Master_Receive(&hi2c1, address << 1, data, size, timeout);
+		break;
+	default:
+		status = HAL_I2C_IsDeviceReady(&hi2c1, address << 1, 1, timeout);
+		break;
+	}
+
+	uint32_t elapsed = Timebase_Local_Micros() - start;
+
+	if (status == HAL_OK)
+	{
+		record_success(device, elapsed, size);
+		return true;
+	}
+
+	uint32_t error = HAL_I2C_GetError(&hi2c1);
+
+	// probes are expected to fail on missing devices, so only count them.
+	if (type != TRANSFER_PROBE)
+	{
+		Error_Log_Put(ERROR_I2C_TRANSFER, error << 16 | segment << 8 | address);
+	}
+
+	record_failure(device);
+
+	// a slave that hung mid transfer may still be holding the bus.
+	if (status == HAL_TIMEOUT || status == HAL_BUSY
+	 || (error & (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_ARLO | HAL_I2C_ERROR_TIMEOUT)))
+	{
+		s_faults++;
+
+		if (is_bus_stuck())
+			I2C_Bus_Recover();
+	}
+
+	return false;
+}
+
+/**
+ * @brief Finds the record of a device, creating it on first use.
+ *
+ * @return NULL if the table is full.
+ */
+static DeviceHealth *get_device(uint8_t segment, uint8_t address)
+{
+	DeviceHealth *unused = NULL;
+
+	for (int i = 0; i < MAX_DEVICES; i++)
+	{
+		DeviceHealth *device = &s_devices[i];
+
+		if (device->address == address && device->segment == segment)
+			return device;
+
+		if (device->address == 0 && unused == NULL)
+			unused = device;
+	}
+
+	if (unused != NULL)
+	{
+		unused->segment = segment;
+		unused->address = address;
+	}
+
+	return unused;
+}
+
+/**
+ * @brief Checks whether a device is still serving its quarantine. Once it
+ *        ends, one transfer is let through to see if the device is back.
+ */
+static bool is_quarantined(const DeviceHealth *device)
+{
+	return device != NULL && device->quarantined
+		&& (int32_t)(HAL_GetTick() - device->quarantine_end) < 0;
+}
+
+/**
+ * @brief Derives a timeout from the smoothed latency and its deviation, the
+ *        same way TCP derives its retransmission timeout.
+ *
+ * @param size	bytes transferred, not counting the address.
+ * @return		the timeout in ms.
+ */
+static uint32_t get_timeout(const DeviceHealth *device, uint16_t size)
+{
+	if (device == NULL || device->samples < LEARNING_SAMPLES)
+		return INITIAL_TIMEOUT;
+
+	uint32_t per_byte = device->latency / 8 + device->deviation; // latency + 4 * deviation.
+	uint32_t timeout = (per_byte * (size + 1) + 999) / 1000 + 1;  // +1 as the first tick can be partial.
+
+	if (timeout < MIN_TIMEOUT)
+		return MIN_TIMEOUT;
+	if (timeout > MAX_TIMEOUT)
+		return MAX_TIMEOUT;
+
+	return timeout;
+}
+
+static void record_success(DeviceHealth *device, uint32_t elapsed, uint16_t size)
+{
+	if (device == NULL)
+		return;
+
+	uint32_t per_byte = elapsed / (size + 1); // the address takes as long as a byte.
+
+	if (device->samples == 0)
+	{
+		device->latency = per_byte * 8;
+		device->deviation = per_byte * 2; // half the first sample.
+	}
+	else
+	{
+		int32_t diff = (int32_t)per_byte - (int32_t)(device->latency / 8);
+		device->latency += diff;                          // latency += diff / 8
+		if (diff < 0)
+			diff = -diff;
+		device->deviation += diff - device->deviation / 4; // deviation += (|diff| - deviation) / 4
+	}
+
+	if (device->samples < UINT16_MAX)
+		device->samples++;
+
+	device->failures = 0;
+	if (device->quarantined)
+	{
+		PRINT_INFO("0x%02X on segment %d is responding again.", device->address, device->segment);
+		device->quarantined = false;
+		device->backoff = 0;
+	}
+}
+
+static void record_failure(DeviceHealth *device)
+{
+	if (device == NULL)
+		return;
+
+	device->total_failures++;
+	if (device->failures < UINT8_MAX)
+		device->failures++;
+
+	// a failed retry after a quarantine starts the next one straight away.
+	if (device->quarantined || device->failures >= QUARANTINE_THRESHOLD)
+	{
+		uint32_t duration = QUARANTINE_BASE << device->backoff;
+		if (device->backoff < MAX_BACKOFF)
+			device->backoff++;
+
+		device->quarantined = true;
+		device->quarantine_end = HAL_GetTick() + duration;
+
+		PRINT_ERROR("0x%02X on segment %d keeps failing. skipping it for %lu ms.",
+				device->address, device->segment, duration);
+	}
+}
+
+/**
+ * @return the index of a segment in s_speeds. -1 if it is invalid.
+ */
+static int get_segment_index(uint8_t segment)
+{
+	if (segment == I2C_SEGMENT_ROOT)
+		return NUM_SEGMENTS - 1;
+
+	return segment < NUM_SEGMENTS - 1 ? segment : -1;
+}
+
+/**
+ * @brief Retimes I2C1 for a speed, unless it is already at that speed.
+ *
+ * @return true on success. false on error.
+ */
+static bool apply_speed(I2CSpeed speed)
+{
+	if (speed == s_applied_speed)
+		return true;
+
+	uint32_t timing = compute_timing(speed, HAL_RCC_GetPCLK1Freq());
+	if (timing == 0)
+	{
+		PRINT_ERROR("no timing for %lu Hz at the current clock.", SPEED_SPECS[speed].frequency);
+		return false;
+	}
+
+	// the output drivers need boosting above 400 kHz.
+	if (speed == I2C_SPEED_FAST_PLUS)
+		HAL_I2CEx_EnableFastModePlus(I2C_FASTMODEPLUS_I2C1);
+	else
+		HAL_I2CEx_DisableFastModePlus(I2C_FASTMODEPLUS_I2C1);
+
+	// re-initialising a ready handle only rewrites the registers.
+	hi2c1.Init.Timing = timing;
+	HAL_StatusTypeDef status = HAL_I2C_Init(&hi2c1);
+	if (status != HAL_OK)
+	{
+		PRINT_ERROR("failed to retime the bus. (HAL error code: %d)", status);
+		s_applied_speed = NUM_I2C_SPEEDS;
+		return false;
+	}
+
+	s_applied_speed = speed;
+
+	return true;
+}
+
+/**
+ * @brief Computes the TIMINGR value for a speed, following the timing rules
+ *        in the I2C chapter of the reference manual (RM0394).
+ *
+ * The smallest prescaler that fits is used, as it gives the finest control
+ * over the SCL period. The low and high periods split whatever the edges
+ * and synchronisation leave of the period, without going under their minimums.
+ *
+ * @param clock	I2C kernel clock, in Hz.
+ * @return		The register value. 0 if no timing fits the clock.
+ */
+static uint32_t compute_timing(I2CSpeed speed, uint32_t clock)
+{
+	const SpeedSpec *spec = &SPEED_SPECS[speed];
+
+	// times below are in ps, to keep precision at 80 MHz (12.5 ns).
+	uint32_t clock_ps = 1000000000 / (clock / 1000);
+	uint32_t period_ps = 1000000000 / (spec->frequency / 1000);
+	uint32_t rise_ps = (BUS_RISE_TIME < spec->rise_max ? BUS_RISE_TIME : spec->rise_max) * 1000;
+	uint32_t fall_ps = (BUS_FALL_TIME < spec->fall_max ? BUS_FALL_TIME : spec->fall_max) * 1000;
+
+	// each SCL edge is delayed by the analogue filter and ~3 kernel clocks.
+	uint32_t sync_ps = (FILTER_DELAY_MIN + FILTER_DELAY_MAX) / 2 * 1000 + 3 * clock_ps;
+	uint32_t overhead_ps = rise_ps + fall_ps + 2 * sync_ps;
+	uint32_t budget_ps = period_ps > overhead_ps ? period_ps - overhead_ps : 0;
+
+	uint32_t low_ps = budget_ps / (spec->low_min + spec->high_min) * spec->low_min;
+	if (low_ps < spec->low_min * 1000)
+		low_ps = spec->low_min * 1000;
+
+	uint32_t high_ps = budget_ps > low_ps ? budget_ps - low_ps : 0;
+	if (high_ps < spec->high_min * 1000)
+		high_ps = spec->high_min * 1000;
+
+	// data may change once SCL has fallen, and must be stable before it rises.
+	int32_t sda_min_ps = (int32_t)fall_ps - (int32_t)(FILTER_DELAY_MIN * 1000) - 3 * (int32_t)clock_ps;
+	int32_t sda_max_ps = (int32_t)(spec->valid_max * 1000) - (int32_t)rise_ps
+			- (int32_t)(FILTER_DELAY_MAX * 1000) - 4 * (int32_t)clock_ps;
+	uint32_t scl_delay_ps = rise_ps + spec->setup_min * 1000;
+
+	for (uint32_t presc = 0; presc < 16; presc++)
+	{
+		uint32_t presc_ps = (presc + 1) * clock_ps;
+
+		uint32_t scll = div_ceil(low_ps, presc_ps) - 1;
+		uint32_t sclh = div_ceil(high_ps, presc_ps) - 1;
+		uint32_t scldel = div_ceil(scl_delay_ps, presc_ps) - 1;
+		uint32_t sdadel = sda_min_ps > 0 ? div_ceil(sda_min_ps, presc_ps) : 0;
+
+		if (scll > 0xFF || sclh > 0xFF || scldel > 0xF || sdadel > 0xF)
+			continue;
+		if ((int32_t)(sdadel * presc_ps) > sda_max_ps && sdadel != 0)
+			continue;
+
+		return (presc << 28) | (scldel << 20) | (sdadel << 16) | (sclh << 8) | scll;
+	}
+
+	return 0;
+}
+
+static uint32_t div_ceil(uint32_t a, uint32_t b)
+{
+	return (a + b - 1) / b;
+}
+
+/**
+ * @brief Checks whether the bus is held, i.e. either line is low or the
+ *        peripheral still thinks a transfer is under way.
+ */
+static bool is_bus_stuck()
+{
+	return __HAL_I2C_GET_FLAG(&hi2c1, I2C_FLAG_BUSY)
+		|| HAL_GPIO_ReadPin(I2C_PORT, SDA_PIN) == GPIO_PIN_RESET
+		|| HAL_GPIO_ReadPin(I2C_PORT, SCL_PIN) == GPIO_PIN_RESET;
+}
+
+/**
+ * @brief Waits for SCL to go high, in case a slave is stretching the clock.
+ *
+ * @return true if SCL went high. false if it is still held low.
+ */
+static bool wait_for_scl()
+{
+	uint32_t start = Timebase_Local_Micros();
+
+	while (HAL_GPIO_ReadPin(I2C_PORT, SCL_PIN) == GPIO_PIN_RESET)
+	{
+		if (Timebase_Local_Micros() - start >= STRETCH_LIMIT)
+			return false;
+	}
+
+	return true;
+}
+
+static void delay_us(uint32_t us)
+{
+	uint32_t start = Timebase_Local_Micros();
+	while (Timebase_Local_Micros() - start < us);
+}
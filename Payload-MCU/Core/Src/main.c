@@ -27,6 +27,7 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "core.h"
+#include "fault.h"
 #include <stdio.h>
 #include "tuk/debug/print.h"
 /* USER CODE END Includes */
@@ -105,10 +106,7 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
-  MX_I2C1_Init();
   MX_CAN1_Init();
-  MX_ADC1_Init();
-  MX_TIM2_Init();
   MX_TIM16_Init();
   /* USER CODE BEGIN 2 */
   Core_Init();
@@ -190,10 +188,10 @@ void Error_Handler(void)
   /* User can add his own implementation to report the HAL error return state */
   __disable_irq();
 
-  PRINT_ERROR("error occurred. Halting program.\r\n");
+  PRINT_ERROR("error occurred. Resetting.\r\n");
 
-  while (1)
-  {}
+  // record where it happened for the next boot.
+  Fault_Capture_Error((uint32_t)__builtin_return_address(0));
   /* USER CODE END Error_Handler_Debug */
 }
 
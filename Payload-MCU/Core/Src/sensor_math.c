@@ -0,0 +1,245 @@
+/*
+ * sensor_math.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Batch arithmetic on the 16 readings of a sensor type.
+ */
+
+#include "sensor_math.h"
+#include "profile.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tuk/debug/print.h"
+
+#define LANES SENSOR_MATH_LANES
+#define GAIN_SHIFT 14
+#define READING_BITS 12
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP == 1
+#define HAS_DSP 1
+#define LOAD(array, i) __UNALIGNED_UINT32_READ(&(array)[i])
+#define STORE(array, i, value) __UNALIGNED_UINT32_WRITE(&(array)[i], value)
+#else
+#define HAS_DSP 0
+#endif
+
+// the scalar versions define what each kernel computes. they are the
+// fallback without the DSP extension, and the reference for the self test.
+static void calibrate_scalar(uint16_t out[LANES], const uint16_t in[LANES],
+		const int16_t gains[LANES], const int16_t offsets[LANES]);
+static void delta_scalar(int16_t out[LANES], const uint16_t now[LANES], const uint16_t last[LANES]);
+static uint16_t outside_scalar(const uint16_t a[LANES], const uint16_t b[LANES], uint16_t deadband);
+static void accumulate_scalar(uint16_t sums[LANES], const uint16_t in[LANES]);
+static void average_scalar(uint16_t out[LANES], const uint16_t sums[LANES], uint32_t shift);
+
+#define PRINT_SUBJECT "Sensor Math"
+
+void Sensor_Math_Calibrate(uint16_t out[LANES], const uint16_t in[LANES],
+		const int16_t gains[LANES], const int16_t offsets[LANES])
+{
+#if HAS_DSP
+	for (int i = 0; i < LANES; i += 2)
+	{
+		uint32_t readings = LOAD(in, i);
+		uint32_t gain = LOAD(gains, i);
+
+		// there is no dual 16 x 16 multiply, so each half is a dual
+		// multiply-add with the other half masked off.
+		uint32_t low = (__SMUAD(readings & 0xFFFF, gain & 0xFFFF) + (1 << (GAIN_SHIFT - 1))) >> GAIN_SHIFT;
+		uint32_t high = (__SMUAD(readings & 0xFFFF0000, gain & 0xFFFF0000) + (1 << (GAIN_SHIFT - 1))) >> GAIN_SHIFT;
+
+		uint32_t scaled = __QADD16(__PKHBT(low, high, 16), LOAD(offsets, i));
+		STORE(out, i, __USAT16(scaled, READING_BITS));
+	}
+#else
+	calibrate_scalar(out, in, gains, offsets);
+#endif
+}
+
+void Sensor_Math_Delta(int16_t out[LANES], const uint16_t now[LANES], const uint16_t last[LANES])
+{
+#if HAS_DSP
+	for (int i = 0; i < LANES; i += 2)
+		STORE(out, i, __QSUB16(LOAD(now, i), LOAD(last, i)));
+#else
+	delta_scalar(out, now, last);
+#endif
+}
+
+uint16_t Sensor_Math_Outside(const uint16_t a[LANES], const uint16_t b[LANES], uint16_t deadband)
+{
+	if (deadband == UINT16_MAX)
+		return 0;
+
+#if HAS_DSP
+	uint32_t limits = (deadband + 1) * 0x00010001u;
+	uint16_t outside = 0;
+
+	for (int i = 0; i < LANES; i += 2)
+	{
+		uint32_t a_pair = LOAD(a, i);
+		uint32_t b_pair = LOAD(b, i);
+
+		// usub16 sets the GE flag of each half that didn't borrow, which
+		// sel then uses to pick that half from its first operand.
+		uint32_t below = __USUB16(b_pair, a_pair);
+		uint32_t above = __USUB16(a_pair, b_pair);
+		uint32_t distance = __SEL(above, below);
+
+		__USUB16(distance, limits);
+		uint32_t mask = __SEL(0xFFFFFFFF, 0);
+
+		outside |= ((mask & 1) | ((mask >> 15) & 2)) << i;
+	}
+
+	return outside;
+#else
+	return outside_scalar(a, b, deadband);
+#endif
+}
+
+void Sensor_Math_Accumulate(uint16_t sums[LANES], const uint16_t in[LANES])
+{
+#if HAS_DSP
+	for (int i = 0; i < LANES; i += 2)
+		STORE(sums, i, __UQADD16(LOAD(sums, i), LOAD(in, i)));
+#else
+	accumulate_scalar(sums, in);
+#endif
+}
+
+void Sensor_Math_Average(uint16_t out[LANES], const uint16_t sums[LANES], uint32_t shift)
+{
+	shift &= 15;
+
+#if HAS_DSP
+	// one shift moves both halves; the mask drops what the high half shifted
+	// into the low one.
+	uint32_t mask = (0xFFFFu >> shift) * 0x00010001u;
+	for (int i = 0; i < LANES; i += 2)
+		STORE(out, i, (LOAD(sums, i) >> shift) & mask);
+#else
+	average_scalar(out, sums, shift);
+#endif
+}
+
+bool Sensor_Math_Self_Test()
+{
+	uint16_t a[LANES];
+	uint16_t b[LANES];
+	int16_t gains[LANES];
+	int16_t offsets[LANES];
+
+	// xorshift, so the data is the same on every run.
+	uint32_t seed = 0x2545F491;
+	for (int i = 0; i < LANES; i++)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		a[i] = seed & SENSOR_MATH_MAX_READING;
+		b[i] = (seed >> 12) & SENSOR_MATH_MAX_READING;
+		gains[i] = (seed >> 16) & INT16_MAX;
+		offsets[i] = (int16_t)(seed >> 20) - 2048;
+	}
+
+	// the edges: a gain of 1, the rails and the largest offsets.
+	gains[0] = SENSOR_MATH_GAIN_ONE;
+	a[1] = SENSOR_MATH_MAX_READING;
+	b[1] = 0;
+	offsets[2] = INT16_MAX;
+	offsets[3] = INT16_MIN;
+
+	struct
+	{
+		uint16_t calibrated[LANES];
+		int16_t deltas[LANES];
+		uint16_t outside;
+		uint16_t sums[LANES];
+		uint16_t averages[LANES];
+	} fast, reference;
+
+	memset(&fast, 0, sizeof(fast));
+	memset(&reference, 0, sizeof(reference));
+
+	Profile_Init();
+
+	uint32_t start = Profile_Cycles();
+	Sensor_Math_Calibrate(fast.calibrated, a, gains, offsets);
+	Sensor_Math_Delta(fast.deltas, a, b);
+	fast.outside = Sensor_Math_Outside(a, b, 1000);
+	for (int n = 0; n < 16; n++)
+		Sensor_Math_Accumulate(fast.sums, n & 1 ? a : b);
+	Sensor_Math_Average(fast.averages, fast.sums, 4);
+	uint32_t fast_cycles = Profile_Cycles() - start;
+
+	start = Profile_Cycles();
+	calibrate_scalar(reference.calibrated, a, gains, offsets);
+	delta_scalar(reference.deltas, a, b);
+	reference.outside = outside_scalar(a, b, 1000);
+	for (int n = 0; n < 16; n++)
+		accumulate_scalar(reference.sums, n & 1 ? a : b);
+	average_scalar(reference.averages, reference.sums, 4);
+	uint32_t reference_cycles = Profile_Cycles() - start;
+
+	bool passed = memcmp(&fast, &reference, sizeof(fast)) == 0;
+
+	if (!passed)
+		PRINT_ERROR("kernels don't match their scalar reference.");
+	else if (HAS_DSP)
+		PRINT_INFO("all kernels: %lu cycles with DSP, %lu cycles scalar.", fast_cycles, reference_cycles);
+	else
+		PRINT_INFO("no DSP extension. all kernels: %lu cycles scalar.", reference_cycles);
+
+	return passed;
+}
+
+static void calibrate_scalar(uint16_t out[LANES], const uint16_t in[LANES],
+		const int16_t gains[LANES], const int16_t offsets[LANES])
+{
+	for (int i = 0; i < LANES; i++)
+	{
+		int32_t value = (((int32_t)in[i] * gains[i] + (1 << (GAIN_SHIFT - 1))) >> GAIN_SHIFT) + offsets[i];
+		out[i] = value < 0 ? 0 : value > SENSOR_MATH_MAX_READING ? SENSOR_MATH_MAX_READING : value;
+	}
+}
+
+static void delta_scalar(int16_t out[LANES], const uint16_t now[LANES], const uint16_t last[LANES])
+{
+	for (int i = 0; i < LANES; i++)
+		out[i] = (int16_t)(now[i] - last[i]);
+}
+
+static uint16_t outside_scalar(const uint16_t a[LANES], const uint16_t b[LANES], uint16_t deadband)
+{
+	uint16_t outside = 0;
+
+	for (int i = 0; i < LANES; i++)
+	{
+		uint16_t distance = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+		if (distance > deadband)
+			outside |= 1 << i;
+	}
+
+	return outside;
+}
+
+static void accumulate_scalar(uint16_t sums[LANES], const uint16_t in[LANES])
+{
+	for (int i = 0; i < LANES; i++)
+	{
+		uint32_t sum = (uint32_t)sums[i] + in[i];
+		sums[i] = sum < UINT16_MAX ? sum : UINT16_MAX;
+	}
+}
+
+static void average_scalar(uint16_t out[LANES], const uint16_t sums[LANES], uint32_t shift)
+{
+	for (int i = 0; i < LANES; i++)
+		out[i] = sums[i] >> shift;
+}
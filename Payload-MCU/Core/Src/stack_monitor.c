@@ -0,0 +1,132 @@
+/*
+ * stack_monitor.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Measures how much of the stack is used.
+ */
+
+#include "stack_monitor.h"
+#include "main.h"
+#include "error_log.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tuk/debug/print.h"
+
+static const uint32_t PAINT = 0xC0FFEE5A;
+static const uint32_t PAINT_MARGIN = 64;   // bytes below the stack pointer left alone while painting.
+static const uint32_t WARNING_MARGIN = 256; // report once the stack gets this close to the end.
+
+static const char *const ISR_NAMES[] = {
+		"SysTick",
+		"CAN1 RX0",
+		"TIM2",
+};
+
+// defined in the linker script.
+extern uint32_t _estack;
+extern uint32_t _Min_Stack_Size;
+
+static volatile uint32_t s_isr_lowest[NUM_STACK_ISRS]; // lowest stack pointer on entry.
+static uint32_t *s_watermark;   // lowest word found overwritten so far.
+static bool s_warned = false;
+
+static uint32_t *get_bottom();
+
+#define PRINT_SUBJECT "Stack"
+
+void Stack_Monitor_Init()
+{
+	uint32_t *bottom = get_bottom();
+	uint32_t *limit = (uint32_t *)(__get_MSP() - PAINT_MARGIN);
+
+	for (uint32_t *word = bottom; word < limit; word++)
+	{
+		*word = PAINT;
+	}
+
+	s_watermark = limit;
+
+	for (int i = 0; i < NUM_STACK_ISRS; i++)
+	{
+		s_isr_lowest[i] = (uint32_t)&_estack;
+	}
+}
+
+void Stack_Monitor_Sample(StackISR isr)
+{
+	uint32_t sp = __get_MSP();
+
+	// a nested handler may race this, but only loses a sample.
+	if (isr < NUM_STACK_ISRS && sp < s_isr_lowest[isr])
+		s_isr_lowest[isr] = sp;
+}
+
+bool Stack_Monitor_Check()
+{
+	uint32_t *bottom = get_bottom();
+
+	// the stack only grows down, so only the paint below the watermark
+	// needs checking.
+	uint32_t *word = bottom;
+	while (word < s_watermark && *word == PAINT)
+	{
+		word++;
+	}
+	s_watermark = word;
+
+	bool overflowed = s_watermark == bottom;
+	uint32_t remaining = (uint32_t)s_watermark - (uint32_t)bottom;
+
+	if (!s_warned && remaining < WARNING_MARGIN)
+	{
+		s_warned = true;
+		if (overflowed)
+		{
+			PRINT_ERROR("stack has reached the end of its %lu byte reservation.", Stack_Monitor_Get_Size());
+		}
+		else
+		{
+			PRINT_ERROR("stack is within %lu bytes of the end of its reservation.", remaining);
+		}
+		Error_Log_Put(ERROR_STACK_LOW, remaining);
+	}
+
+	return !overflowed;
+}
+
+uint32_t Stack_Monitor_Get_Peak()
+{
+	return (uint32_t)&_estack - (uint32_t)s_watermark;
+}
+
+uint32_t Stack_Monitor_Get_Size()
+{
+	return (uint32_t)&_Min_Stack_Size;
+}
+
+uint32_t Stack_Monitor_Get_ISR_Peak(StackISR isr)
+{
+	if (isr >= NUM_STACK_ISRS)
+		return 0;
+
+	return (uint32_t)&_estack - s_isr_lowest[isr];
+}
+
+void Stack_Monitor_Print()
+{
+	PRINT_INFO("peak use: %lu of %lu bytes", Stack_Monitor_Get_Peak(), Stack_Monitor_Get_Size());
+	for (int i = 0; i < NUM_STACK_ISRS; i++)
+	{
+		PRINT_INFO("deepest on entry to %-8s: %lu bytes", ISR_NAMES[i], Stack_Monitor_Get_ISR_Peak(i));
+	}
+}
+
+/**
+ * @brief Gets the lowest address of the stack reservation.
+ */
+static uint32_t *get_bottom()
+{
+	return (uint32_t *)((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size);
+}
@@ -0,0 +1,156 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Encodes sensor snapshots into telemetry report frames.
+ */
+
+#include "telemetry.h"
+#include "profile.h"
+#include "timebase.h"
+#include "sensor_health.h"
+#include "heater_budget.h"
+
+#include <stdint.h>
+#include "tuk/tuk.h"
+#include "payload_cmds.h"
+
+// byte offsets within a telemetry report.
+#define KEY_OFFSET      0
+#define SEQUENCE_OFFSET 1
+#define PACKET_OFFSET   2
+#define READING_OFFSET  3 // uint16_t, little-endian.
+#define STAMP_OFFSET    5 // uint16_t, little-endian. see STAMP_SHIFT.
+
+// byte offsets within a health frame.
+#define HEALTH_TYPE_OFFSET        0
+#define HEALTH_QUARANTINED_OFFSET 1 // uint16_t, little-endian.
+#define HEALTH_SUSPECT_OFFSET     3 // uint16_t, little-endian.
+
+// byte offsets within a heater budget frame.
+#define BUDGET_UTILISATION_OFFSET 0
+#define BUDGET_PEAK_OFFSET        1
+#define BUDGET_MAX_OFFSET         2
+#define BUDGET_HELD_OFFSET        3 // uint16_t, little-endian.
+
+// the stamp is the sweep's time in units of 64 us, which wraps every ~4 s.
+// CDH recovers the full time from when the frame arrived.
+#define STAMP_SHIFT 6
+
+static const uint8_t TELEMETRY_TYPES[NUM_SENSOR_TYPES] = {
+		[SENSOR_THERMISTOR] = TEL_WELL_TEMP,
+		[SENSOR_PHOTOCELL]  = TEL_WELL_LUMINOSITY,
+};
+
+static CANMessage s_frames[NUM_SENSOR_TYPES][16];
+static CANMessage s_health_frames[NUM_SENSOR_TYPES];
+static CANMessage s_budget_frame;
+
+static uint32_t s_last_cycles = 0;  // cycles taken by the last encode.
+static uint32_t s_worst_cycles = 0; // most cycles taken by an encode.
+static uint32_t s_last_count = 0;   // frames produced by the last encode.
+static uint32_t s_last_latency = 0; // from sampling to the end of the last encode, in us.
+static uint32_t s_worst_latency = 0;
+
+#define PRINT_SUBJECT "Telemetry"
+
+void Telemetry_Init()
+{
+	Profile_Init();
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		for (int well = WELL_0; well <= WELL_15; well++)
+		{
+			CANMessage *frame = &s_frames[type][well];
+			frame->cmd = CMD_CDH_PROCESS_TELEMETRY_REPORT;
+			frame->data[KEY_OFFSET] = CREATE_TELEMETRY_KEY(TELEMETRY_TYPES[type], well);
+			frame->data[PACKET_OFFSET] = 0; // a reading always fits in one packet.
+		}
+
+		s_health_frames[type].cmd = CMD_CDH_PROCESS_SENSOR_HEALTH;
+		s_health_frames[type].data[HEALTH_TYPE_OFFSET] = type;
+	}
+
+	s_budget_frame.cmd = CMD_CDH_PROCESS_HEATER_BUDGET;
+}
+
+uint32_t Telemetry_Encode(const SensorSnapshot *snapshot, uint8_t sequences[NUM_SENSOR_TYPES],
+		CANMessage *frames[TELEMETRY_MAX_FRAMES])
+{
+	uint32_t start = Profile_Cycles();
+	uint32_t count = 0;
+
+	uint16_t stamp = (uint16_t)(snapshot->timestamp >> STAMP_SHIFT);
+	uint8_t stamp_low = (uint8_t)stamp;
+	uint8_t stamp_high = (uint8_t)(stamp >> 8);
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		const uint16_t *readings = snapshot->readings[type];
+		uint8_t sequence = sequences[type];
+
+		// visit only the valid wells, lowest first.
+		uint32_t pending = snapshot->valid[type];
+		while (pending != 0)
+		{
+			uint32_t well = __builtin_ctz(pending);
+			pending &= pending - 1;
+
+			CANMessage *frame = &s_frames[type][well];
+			uint16_t reading = readings[well];
+			frame->data[SEQUENCE_OFFSET] = sequence++;
+			frame->data[READING_OFFSET] = (uint8_t)reading;
+			frame->data[READING_OFFSET + 1] = (uint8_t)(reading >> 8);
+			frame->data[STAMP_OFFSET] = stamp_low;
+			frame->data[STAMP_OFFSET + 1] = stamp_high;
+
+			frames[count++] = frame;
+		}
+
+		sequences[type] = sequence;
+
+		CANMessage *frame = &s_health_frames[type];
+		uint16_t quarantined = Sensor_Health_Get_Quarantined(type);
+		uint16_t suspect = Sensor_Health_Get_Suspect(type);
+		frame->data[HEALTH_QUARANTINED_OFFSET] = (uint8_t)quarantined;
+		frame->data[HEALTH_QUARANTINED_OFFSET + 1] = (uint8_t)(quarantined >> 8);
+		frame->data[HEALTH_SUSPECT_OFFSET] = (uint8_t)suspect;
+		frame->data[HEALTH_SUSPECT_OFFSET + 1] = (uint8_t)(suspect >> 8);
+		frame->data[STAMP_OFFSET] = stamp_low;
+		frame->data[STAMP_OFFSET + 1] = stamp_high;
+
+		frames[count++] = frame;
+	}
+
+	HeaterBudgetStats budget;
+	Heater_Budget_Take_Stats(&budget);
+	s_budget_frame.data[BUDGET_UTILISATION_OFFSET] = budget.utilisation;
+	s_budget_frame.data[BUDGET_PEAK_OFFSET] = budget.peak;
+	s_budget_frame.data[BUDGET_MAX_OFFSET] = budget.max;
+	s_budget_frame.data[BUDGET_HELD_OFFSET] = (uint8_t)budget.held;
+	s_budget_frame.data[BUDGET_HELD_OFFSET + 1] = (uint8_t)(budget.held >> 8);
+	s_budget_frame.data[STAMP_OFFSET] = stamp_low;
+	s_budget_frame.data[STAMP_OFFSET + 1] = stamp_high;
+
+	frames[count++] = &s_budget_frame;
+
+	s_last_cycles = Profile_Cycles() - start;
+	if (s_last_cycles > s_worst_cycles)
+		s_worst_cycles = s_last_cycles;
+	s_last_count = count;
+
+	s_last_latency = Timebase_Now() - snapshot->timestamp;
+	if (s_last_latency > s_worst_latency)
+		s_worst_latency = s_last_latency;
+
+	return count;
+}
+
+void Telemetry_Print_Stats()
+{
+	PRINT_INFO("last encode: %lu frames in %lu cycles, worst: %lu cycles",
+			s_last_count, s_last_cycles, s_worst_cycles);
+	PRINT_INFO("sample to send latency: %lu us, worst: %lu us", s_last_latency, s_worst_latency);
+}
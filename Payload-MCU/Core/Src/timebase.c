@@ -0,0 +1,142 @@
+/*
+ * timebase.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: A microsecond clock shared with CDH, for stamping telemetry.
+ */
+
+#include "timebase.h"
+#include "profile.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tuk/debug/print.h"
+
+static const int32_t MAX_RATE_PPM = 500;        // beyond this, the crystal or the sync is broken.
+static const uint64_t MIN_RATE_INTERVAL = 1000000; // in us. shorter sync intervals are too noisy to measure rate.
+
+static uint32_t s_last_cycles = 0;  // cycle counter at the last read.
+static uint32_t s_cycle_wraps = 0;  // times the cycle counter has wrapped.
+
+static bool s_synced = false;
+static uint64_t s_sync_local = 0;   // local time at the last sync, in us.
+static uint32_t s_sync_remote = 0;  // CDH time at the last sync, in us.
+static int32_t s_rate_ppm = 0;      // how much faster CDH's clock runs, in parts per million.
+static int32_t s_last_error = 0;    // CDH time minus ours at the last sync, in us.
+
+static uint64_t get_local_micros();
+static uint32_t to_remote(uint64_t local);
+
+#define PRINT_SUBJECT "Timebase"
+
+void Timebase_Init()
+{
+	Profile_Init();
+
+	// the cycle counter keeps running through a reset, so count from here.
+	DWT->CYCCNT = 0;
+	s_last_cycles = 0;
+	s_cycle_wraps = 0;
+}
+
+uint32_t Timebase_Now()
+{
+	return to_remote(get_local_micros());
+}
+
+uint32_t Timebase_Local_Micros()
+{
+	return (uint32_t)get_local_micros();
+}
+
+void Timebase_Sync(uint32_t remote_time)
+{
+	uint64_t local = get_local_micros();
+
+	// time is only wrong by the error, the rest came from the last sync.
+	int32_t error = (int32_t)(remote_time - to_remote(local));
+
+	if (s_synced)
+	{
+		uint64_t local_elapsed = local - s_sync_local;
+		uint32_t remote_elapsed = remote_time - s_sync_remote;
+
+		if (local_elapsed >= MIN_RATE_INTERVAL)
+		{
+			// CDH's clock wraps every 71 minutes, but the two only drift
+			// apart by a little, so their difference is taken modulo 2^32.
+			int32_t drift = (int32_t)(remote_elapsed - (uint32_t)local_elapsed);
+			int64_t ppm = (int64_t)drift * 1000000 / (int64_t)local_elapsed;
+			if (-MAX_RATE_PPM <= ppm && ppm <= MAX_RATE_PPM)
+			{
+				s_rate_ppm = (int32_t)ppm;
+			}
+			else
+			{
+				PRINT_ERROR("ignoring implausible clock rate difference of %ld ppm.", (int32_t)ppm);
+			}
+		}
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	s_sync_local = local;
+	s_sync_remote = remote_time;
+	s_synced = true;
+	__set_PRIMASK(primask);
+
+	s_last_error = error;
+}
+
+bool Timebase_Is_Synced()
+{
+	return s_synced;
+}
+
+void Timebase_Print_Status()
+{
+	if (!s_synced)
+	{
+		PRINT_INFO("not synced. time since boot: %lu us", Timebase_Now());
+		return;
+	}
+
+	PRINT_INFO("time: %lu us, last sync error: %ld us, rate correction: %ld ppm",
+			Timebase_Now(), s_last_error, s_rate_ppm);
+}
+
+/**
+ * @brief Gets the time since Timebase_Init on the local clock, in microseconds.
+ */
+static uint64_t get_local_micros()
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t cycles = Profile_Cycles();
+	if (cycles < s_last_cycles)
+		s_cycle_wraps++;
+	s_last_cycles = cycles;
+
+	uint64_t total = ((uint64_t)s_cycle_wraps << 32) | cycles;
+	__set_PRIMASK(primask);
+
+	return total / (SystemCoreClock / 1000000);
+}
+
+/**
+ * @brief Converts a local time to CDH's clock.
+ */
+static uint32_t to_remote(uint64_t local)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	int64_t since_sync = (int64_t)(local - s_sync_local);
+	uint32_t remote = s_sync_remote;
+	int32_t rate_ppm = s_rate_ppm;
+	__set_PRIMASK(primask);
+
+	return remote + (uint32_t)(since_sync + since_sync * rate_ppm / 1000000);
+}
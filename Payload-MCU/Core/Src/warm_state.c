@@ -0,0 +1,163 @@
+/*
+ * warm_state.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Keeps the state of running experiments across resets.
+ */
+
+#include "warm_state.h"
+#include "flash.h"
+#include "crc.h"
+#include "pp.h"
+#include "placement.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "tuk/debug/print.h"
+
+static const uint32_t IMAGE_MAGIC = 0x5741524D; // "WARM"
+static const uint16_t IMAGE_VERSION = 2;
+
+static const uint32_t MIRROR_PERIOD = 600000; // in ms.
+
+// a checksummed copy of the state, as kept in RAM and flash.
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t size;
+	WarmState state;
+	uint32_t crc; // covers everything above.
+} WarmStateImage;
+
+CASSERT(sizeof(WarmStateImage) % sizeof(uint64_t) == 0, warm_state)
+
+// the flash page holds a sequence of images. it is only erased once full.
+#define SLOT_COUNT (FLASH_PAGE_SIZE / sizeof(WarmStateImage))
+
+static WarmStateImage s_ram_image NOINIT;
+
+static uint32_t s_next_slot;           // flash slot for the next image.
+static uint32_t s_last_mirror;         // HAL tick of the last mirror.
+
+static void seal_image(WarmStateImage *image, const WarmState *state);
+static bool is_valid(const WarmStateImage *image);
+static const WarmStateImage *get_slot(uint32_t slot);
+static bool mirror(const WarmState *state);
+
+#define PRINT_SUBJECT "Warm State"
+
+WarmStateSource Warm_State_Load(WarmState *out)
+{
+	// find the newest image in flash, and where the next one goes.
+	const WarmStateImage *newest = NULL;
+	s_next_slot = SLOT_COUNT;
+	for (uint32_t slot = 0; slot < SLOT_COUNT; slot++)
+	{
+		const WarmStateImage *image = get_slot(slot);
+		if (image->magic == UINT32_MAX)
+		{
+			s_next_slot = slot; // erased.
+			break;
+		}
+		if (is_valid(image))
+		{
+			newest = image;
+		}
+	}
+
+	s_last_mirror = HAL_GetTick();
+
+	if (is_valid(&s_ram_image))
+	{
+		*out = s_ram_image.state;
+		return WARM_STATE_RAM;
+	}
+
+	if (newest != NULL)
+	{
+		*out = newest->state;
+		seal_image(&s_ram_image, out);
+		return WARM_STATE_FLASH;
+	}
+
+	return WARM_STATE_NONE;
+}
+
+void Warm_State_Store(const WarmState *state)
+{
+	seal_image(&s_ram_image, state);
+
+	uint32_t now = HAL_GetTick();
+
+	if (now - s_last_mirror >= MIRROR_PERIOD)
+	{
+		// retry on the next period if this fails.
+		s_last_mirror = now;
+		mirror(state);
+	}
+}
+
+/**
+ * @brief Fills in an image with the given state and checksums it.
+ */
+static void seal_image(WarmStateImage *image, const WarmState *state)
+{
+	image->magic = IMAGE_MAGIC;
+	image->version = IMAGE_VERSION;
+	image->size = sizeof(WarmState);
+	image->state = *state;
+	image->crc = CRC_Compute(image, offsetof(WarmStateImage, crc));
+}
+
+/**
+ * @brief Checks that an image is complete and belongs to this firmware.
+ */
+static bool is_valid(const WarmStateImage *image)
+{
+	return image->magic == IMAGE_MAGIC
+		&& image->version == IMAGE_VERSION
+		&& image->size == sizeof(WarmState)
+		&& image->crc == CRC_Compute(image, offsetof(WarmStateImage, crc));
+}
+
+static const WarmStateImage *get_slot(uint32_t slot)
+{
+	return (const WarmStateImage *)(FLASH_WARM_STATE_ADDR + slot * sizeof(WarmStateImage));
+}
+
+/**
+ * @brief Appends the state to the flash page, erasing it first if it is full.
+ *
+ * @return true on success. false on error.
+ */
+static bool mirror(const WarmState *state)
+{
+	if (s_next_slot >= SLOT_COUNT)
+	{
+		if (!Flash_Erase_Page(FLASH_WARM_STATE_ADDR))
+		{
+			PRINT_ERROR("failed to erase the flash mirror.");
+			return false;
+		}
+		s_next_slot = 0;
+	}
+
+	WarmStateImage image;
+	seal_image(&image, state);
+
+	uint32_t address = (uint32_t)get_slot(s_next_slot);
+	s_next_slot++; // skip the slot even on failure, as it may be half written.
+
+	if (!Flash_Program(address, &image, sizeof(image)))
+	{
+		PRINT_ERROR("failed to update the flash mirror.");
+		return false;
+	}
+
+	return true;
+}
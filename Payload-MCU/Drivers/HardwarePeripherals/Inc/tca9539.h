@@ -13,6 +13,7 @@
 #include "power.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum
 {
@@ -47,6 +48,15 @@ typedef enum
  */
 bool TCA9539_Init();
 
+/**
+ * @brief Checks whether a device acknowledges its address.
+ *
+ * Takes a few ms at most, so it can be used to skip a missing device at boot.
+ *
+ * @return true if the device responded. false otherwise.
+ */
+bool TCA9539_Is_Present(ExpanderID device);
+
 /**
  * @brief Gets the state of a pin on one of the expanders.
  *
@@ -61,6 +71,19 @@ int TCA9539_Get_Pin(ExpanderID device, ExpanderPinID pin); // TODO: inconsistent
  */
 bool TCA9539_Set_Pin(ExpanderID device, ExpanderPinID pin, Power power);
 
+/**
+ * @brief Updates several output pins of one expander in a single transaction.
+ *
+ * Both output ports are written back-to-back. Pins outside of the mask keep
+ * the state they were last written with.
+ *
+ * @param device	which expander to target.
+ * @param mask		bit n selects the pin with ExpanderPinID n.
+ * @param outputs	new states for the selected pins.
+ * @return true on success. false on error.
+ */
+bool TCA9539_Set_Pins(ExpanderID device, uint16_t mask, uint16_t outputs);
+
 /**
  * @brief Sets all pins to low.
  *
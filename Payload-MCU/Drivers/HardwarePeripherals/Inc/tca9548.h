@@ -10,6 +10,7 @@
 #ifndef HARDWAREPERIPHERALS_INC_TCA9548_H_
 #define HARDWAREPERIPHERALS_INC_TCA9548_H_
 
+#include <stdint.h>
 #include <stdbool.h>
 
 typedef enum {
@@ -21,11 +22,56 @@ typedef enum {
 	MUX_CHANNEL_5,
 } MuxChannel;
 
+#define TCA9548_NUM_CHANNELS (MUX_CHANNEL_5 + 1)
+
+/**
+ * @brief Sets which channels have devices at the same addresses, so they are
+ *        never enabled together by TCA9548_Select.
+ *
+ * Until this is called, every channel is treated as clashing with every other.
+ *
+ * @param conflicts	bit n of entry c is set if channel n clashes with channel c.
+ */
+void TCA9548_Init(const uint8_t conflicts[TCA9548_NUM_CHANNELS]);
+
 /**
  * @brief Sets the I2C channel for the multiplexer.
  *
+ * Nothing is sent if the multiplexer is known to be on that channel already.
+ *
  * @return true on success. false on error.
  */
 bool TCA9548_Set_I2C_Channel(MuxChannel channel);
 
+/**
+ * @brief Enables any combination of channels at once.
+ *
+ * Nothing is sent if the multiplexer is known to have those channels enabled
+ * already. The cached state is dropped on any bus fault, so the next call
+ * always rewrites it.
+ *
+ * @param mask	bit n enables channel n.
+ * @return 		true on success. false on error.
+ */
+bool TCA9548_Set_Channels(uint8_t mask);
+
+/**
+ * @brief Makes a device behind a channel reachable, switching as little as
+ *        possible.
+ *
+ * A channel is kept enabled alongside others for as long as none of them
+ * clash with it, as set by TCA9548_Init, so alternating between them needs no
+ * switch at all.
+ *
+ * @return true on success. false on error.
+ */
+bool TCA9548_Select(MuxChannel channel);
+
+/**
+ * @brief Checks whether the multiplexer acknowledges its address.
+ *
+ * @return true if it responded. false otherwise.
+ */
+bool TCA9548_Is_Present();
+
 #endif /* HARDWAREPERIPHERALS_INC_TCA9548_H_ */
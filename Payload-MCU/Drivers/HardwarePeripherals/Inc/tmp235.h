@@ -19,4 +19,12 @@
  */
 bool TMP235_Read_Temp(uint16_t *out);
 
+/**
+ * @brief Converts a raw reading to a temperature.
+ *
+ * @param raw	Raw 12 bit ADC reading, against a 3.3 V reference.
+ * @return		Temperature in hundredths of a degree celsius.
+ */
+int16_t TMP235_To_Centidegrees(uint16_t raw);
+
 #endif /* HARDWAREPERIPHERALS_INC_TMP235_H_ */
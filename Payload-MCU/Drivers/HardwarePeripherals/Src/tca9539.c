@@ -11,14 +11,13 @@
 #include "tca9539.h"
 #include "power.h"
 #include "assert.h"
-#include "i2c.h"
-
-static const uint32_t TIMEOUT = 100;
+#include "i2c_bus.h"
+#include "error_log.h"
 
 // I2C addresses of each IO expander.
 static const uint8_t EXPANDER_I2C_ADDRESSES[] = {
-		0x74 << 1, 	// IO Expander 1 (Wells 0-7)
-		0x75 << 1 	// IO Expander 2 (Wells 8-15)
+		0x74, 	// IO Expander 1 (Wells 0-7)
+		0x75 	// IO Expander 2 (Wells 8-15)
 };
 
 typedef enum {
@@ -36,23 +35,28 @@ static const uint8_t PORT_ADDRESSES[] = {
 		0x03,   // OUTPUT PORT 1
 };
 
+// last output states written to each device. bit n is ExpanderPinID n.
+static uint16_t s_outputs[] = { 0x0000, 0x0000 };
+
 static bool get_port(ExpanderID device, PortID port, uint8_t *out);
 static bool set_port(ExpanderID device, PortID port, uint8_t bitmap);
+static bool set_output_ports(ExpanderID device, uint16_t outputs);
 static bool check_params(ExpanderID device, ExpanderPinID pin);
 
 #define PRINT_SUBJECT "TCA9539"
 
 bool TCA9539_Init()
 {
+	// clear outputs first. the output registers power up high, and would
+	// otherwise switch everything on for a moment once the pins are outputs.
+	if (!TCA9539_Clear_Pins()) return false;
+
 	// configure all pins to be outputs.
 	if (!set_port(EXPANDER_1, CONFIG_PORT_0, 0x00)) return false;
 	if (!set_port(EXPANDER_1, CONFIG_PORT_1, 0x00)) return false;
 	if (!set_port(EXPANDER_2, CONFIG_PORT_0, 0x00)) return false;
 	if (!set_port(EXPANDER_2, CONFIG_PORT_1, 0x00)) return false;
 
-	// clear outputs.
-	if (!TCA9539_Clear_Pins()) return false;
-
 	return true;
 }
 
@@ -78,6 +82,17 @@ int TCA9539_Get_Pin(ExpanderID device, ExpanderPinID pin)
 	return bit ? 1 : 0;
 }
 
+bool TCA9539_Is_Present(ExpanderID device)
+{
+	if (device != EXPANDER_1 && device != EXPANDER_2)
+	{
+		PRINT_ERROR("invalid device: %d.", device);
+		return false;
+	}
+
+	return I2C_Bus_Probe(I2C_SEGMENT_ROOT, EXPANDER_I2C_ADDRESSES[device]);
+}
+
 bool TCA9539_Set_Pin(ExpanderID device, ExpanderPinID pin, Power power)
 {
 	if (!check_params(device, pin))
@@ -106,6 +121,20 @@ bool TCA9539_Set_Pin(ExpanderID device, ExpanderPinID pin, Power power)
 	return true;
 }
 
+bool TCA9539_Set_Pins(ExpanderID device, uint16_t mask, uint16_t outputs)
+{
+	if (!check_params(device, EXPANDER_PIN_0))
+		return false;
+
+	uint16_t new_outputs = (s_outputs[device] & ~mask) | (outputs & mask);
+
+	// nothing to do if the pins are already in the requested state.
+	if (new_outputs == s_outputs[device])
+		return true;
+
+	return set_output_ports(device, new_outputs);
+}
+
 bool TCA9539_Clear_Pins()
 {
 	// clear all outputs for both devices.
@@ -128,27 +157,21 @@ bool TCA9539_Clear_Pins()
 #define OUTPUT_PORT_OFFSET 3
 static bool get_port(ExpanderID device, PortID port, uint8_t *out)
 {
-	HAL_StatusTypeDef status;
-
 	uint8_t i2c_address = EXPANDER_I2C_ADDRESSES[device];
 	uint8_t msg = PORT_ADDRESSES[port];
 
 	// indicate to the device which port we want.
-	status = HAL_I2C_Master_Transmit(&hi2c1, i2c_address << 1, &msg, sizeof(msg), TIMEOUT);
-	if (status != HAL_OK)
+	if (!I2C_Bus_Transmit(I2C_SEGMENT_ROOT, i2c_address, &msg, sizeof(msg)))
 	{
-		PRINT_ERROR("failed to transmit port address 0x%02X to device %d. (I2C address: 0x%02X, HAL error code: %d)", msg, device, i2c_address, status);
-		//PUT_ERROR(ERR_I2C_TRANSMIT, (uint8_t)port, (uint8_t)status); // TODO: inconsistent usage with rest of code. Do we want this?
+		Error_Log_Put(ERROR_TCA9539_TRANSFER, device << 8 | port);
 		return false;
 	}
 
 	// now receive the current state of the register.
 	uint8_t port_register;
-	status = HAL_I2C_Master_Receive(&hi2c1, i2c_address << 1, &port_register, sizeof(port_register), TIMEOUT);
-	if (status != HAL_OK)
+	if (!I2C_Bus_Receive(I2C_SEGMENT_ROOT, i2c_address, &port_register, sizeof(port_register)))
 	{
-		PRINT_ERROR("failed to get register for port %d from device %d. (I2C address: 0x%02X, HAL error code: %d)", port, device, i2c_address, status);
-		//PUT_ERROR(ERR_I2C_RECEIVE, (uint8_t)port, (uint8_t)status); // TODO: inconsistent usage with rest of code. Do we want this?
+		Error_Log_Put(ERROR_TCA9539_TRANSFER, device << 8 | port);
 		return false;
 	}
 
@@ -167,20 +190,48 @@ static bool get_port(ExpanderID device, PortID port, uint8_t *out)
  */
 static bool set_port(ExpanderID device, PortID port, uint8_t bitmap)
 {
-	HAL_StatusTypeDef status;
-
 	uint8_t i2c_address = EXPANDER_I2C_ADDRESSES[device];
 	uint8_t msg[] = { PORT_ADDRESSES[port], bitmap };
 
-	status = HAL_I2C_Master_Transmit(&hi2c1, i2c_address << 1, msg, sizeof(msg), TIMEOUT);
-	if (status != HAL_OK)
+	if (!I2C_Bus_Transmit(I2C_SEGMENT_ROOT, i2c_address, msg, sizeof(msg)))
+	{
+		PRINT_ERROR("failed to transmit message { port address: 0x%02X, bitmap: 0x%02X } to device %d. (I2C address: 0x%02X)", msg[0], msg[1], device, i2c_address);
+
+		return false;
+	}
+
+	// keep track of output states so bulk updates don't need to read them back.
+	if (port == OUTPUT_PORT_0)
+		s_outputs[device] = (s_outputs[device] & 0xFF00) | bitmap;
+	else if (port == OUTPUT_PORT_1)
+		s_outputs[device] = (s_outputs[device] & 0x00FF) | (bitmap << 8);
+
+	return true;
+}
+
+/**
+ * @brief Sets both output port registers of a device in one transmission.
+ *
+ * The device auto-increments between the two registers of a port pair, so
+ * output port 1 directly follows output port 0.
+ *
+ * @param device	which device to target.
+ * @param outputs	port 0 in the low byte, port 1 in the high byte.
+ * @return 			true on success. false on error.
+ */
+static bool set_output_ports(ExpanderID device, uint16_t outputs)
+{
+	uint8_t i2c_address = EXPANDER_I2C_ADDRESSES[device];
+	uint8_t msg[] = { PORT_ADDRESSES[OUTPUT_PORT_0], outputs & 0xFF, outputs >> 8 };
+
+	if (!I2C_Bus_Transmit(I2C_SEGMENT_ROOT, i2c_address, msg, sizeof(msg)))
 	{
-		PRINT_ERROR("failed to transmit message { port address: 0x%02X, bitmap: 0x%02X } to device %d. (I2C address: 0x%02X, HAL error code: %d)", msg[0], msg[1], device, i2c_address, status);
+		PRINT_ERROR("failed to transmit outputs 0x%04X to device %d. (I2C address: 0x%02X)", outputs, device, i2c_address);
 
 		return false;
 	}
 
-//	Flash_Write(OUTPUT_PORT_OFFSET, &bitmap, 1);
+	s_outputs[device] = outputs;
 
 	return true;
 }
@@ -198,14 +249,14 @@ static bool check_params(ExpanderID device, ExpanderPinID pin)
 	if (device != EXPANDER_1 && device != EXPANDER_2)
 	{
 		PRINT_ERROR("invalid device: %d.", device);
-		//PUT_ERROR(ERR_PLD_TCA9539_INVALID_EXPANDER_ID);
+		Error_Log_Put(ERROR_TCA9539_INVALID_EXPANDER, device);
 		return false;
 	}
 
 	if (pin < EXPANDER_PIN_0 || pin > EXPANDER_PIN_17)
 	{
 		PRINT_ERROR("invalid pin: %d.", pin);
-		//PUT_ERROR(ERR_PLD_TCA9539_INVALID_EXPANDER_PIN_ID);
+		Error_Log_Put(ERROR_TCA9539_INVALID_PIN, pin);
 		return false;
 	}
 
@@ -10,17 +10,44 @@
 #include "tca9548.h"
 #include "assert.h"
 
-#include "i2c.h"
+#include "i2c_bus.h"
+#include "error_log.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 #include "tuk/debug/print.h"
 
-static const uint16_t I2C_ADDRESS = 0x70 << 1;  // I2C address of the multiplexer
-static const uint32_t TIMEOUT = 100;       // in ms
+#define VALID_CHANNELS ((1 << TCA9548_NUM_CHANNELS) - 1)
+#define OTHER_CHANNELS(channel) (VALID_CHANNELS & ~(1 << (channel)))
+
+static const uint8_t I2C_ADDRESS = 0x70;  // I2C address of the multiplexer
+
+// channels enabled in the mux. only trusted while s_mask_known is set and no
+// bus fault has happened since it was written.
+static uint8_t s_mask = 0x00;
+static bool s_mask_known = false;
+static uint32_t s_mask_faults = 0; // bus fault count when s_mask was written.
+
+// channels that share a device address with each channel. until the board
+// says otherwise, every channel is assumed to clash with every other.
+static uint8_t s_conflicts[TCA9548_NUM_CHANNELS] = {
+		OTHER_CHANNELS(MUX_CHANNEL_0), OTHER_CHANNELS(MUX_CHANNEL_1), OTHER_CHANNELS(MUX_CHANNEL_2),
+		OTHER_CHANNELS(MUX_CHANNEL_3), OTHER_CHANNELS(MUX_CHANNEL_4), OTHER_CHANNELS(MUX_CHANNEL_5)
+};
+
+static bool is_mask_valid();
 
 #define PRINT_SUBJECT "TCA9548"
 
+void TCA9548_Init(const uint8_t conflicts[TCA9548_NUM_CHANNELS])
+{
+	for (int channel = 0; channel < TCA9548_NUM_CHANNELS; channel++)
+	{
+		// a channel never clashes with itself, nor with channels it doesn't have.
+		s_conflicts[channel] = conflicts[channel] & OTHER_CHANNELS(channel);
+	}
+}
+
 bool TCA9548_Set_I2C_Channel(MuxChannel channel)
 {
 	ASSERT(MUX_CHANNEL_0 <= channel && channel <= MUX_CHANNEL_5, "invalid mux channel: %d.", channel);
@@ -28,22 +55,75 @@ bool TCA9548_Set_I2C_Channel(MuxChannel channel)
 	if (channel < MUX_CHANNEL_0 || channel > MUX_CHANNEL_5)
 	{
 		PRINT_ERROR("invalid mux channel: %d.", channel);
-		//PUT_ERROR(ERR_PLD_TCA9548_INVALID_CHANNEL);
+		Error_Log_Put(ERROR_TCA9548_INVALID_CHANNEL, channel);
 		return false;
 	}
 
-	// create an array of 1 byte and copy the value in channel_number
-	uint8_t command_register[1] = {1 << channel};
+	return TCA9548_Set_Channels(1 << channel);
+}
 
-	// usage: i2c object, device addr, payload, payload size (bytes), timeout (ms)
-	HAL_StatusTypeDef status = HAL_I2C_Master_Transmit(&hi2c1, I2C_ADDRESS << 1, command_register, 1, TIMEOUT);
+bool TCA9548_Set_Channels(uint8_t mask)
+{
+	if (mask & ~VALID_CHANNELS)
+	{
+		PRINT_ERROR("invalid mux channel mask: 0x%02X.", mask);
+		Error_Log_Put(ERROR_TCA9548_INVALID_CHANNEL, mask);
+		return false;
+	}
+
+	if (is_mask_valid() && s_mask == mask)
+		return true;
 
-	if (status != HAL_OK)
+	// each bit of the control register enables one channel.
+	uint8_t command_register[1] = { mask };
+
+	if (!I2C_Bus_Transmit(I2C_SEGMENT_ROOT, I2C_ADDRESS, command_register, 1))
 	{
-		PRINT_ERROR("failed to switch to I2C channel %d. (HAL error code: %d)", channel, status);
-		//PUT_ERROR(ERR_I2C_TRANSMIT, status);
+		Error_Log_Put(ERROR_TCA9548_SET_CHANNEL, mask);
+		s_mask_known = false;
 		return false;
 	}
 
+	s_mask = mask;
+	s_mask_known = true;
+	s_mask_faults = I2C_Bus_Get_Fault_Count();
+
 	return true;
 }
+
+bool TCA9548_Select(MuxChannel channel)
+{
+	ASSERT(MUX_CHANNEL_0 <= channel && channel <= MUX_CHANNEL_5, "invalid mux channel: %d.", channel);
+
+	if (channel < MUX_CHANNEL_0 || channel > MUX_CHANNEL_5)
+	{
+		PRINT_ERROR("invalid mux channel: %d.", channel);
+		Error_Log_Put(ERROR_TCA9548_INVALID_CHANNEL, channel);
+		return false;
+	}
+
+	uint8_t mask = is_mask_valid() ? s_mask : 0x00;
+
+	// already reachable, and nothing else answers to the same addresses.
+	if ((mask & (1 << channel)) && !(mask & s_conflicts[channel]))
+		return true;
+
+	// keep the other channels open if none of their devices clash with this
+	// one's, so going back to them doesn't need a switch either.
+	mask &= ~s_conflicts[channel];
+
+	return TCA9548_Set_Channels(mask | (1 << channel));
+}
+
+bool TCA9548_Is_Present()
+{
+	return I2C_Bus_Probe(I2C_SEGMENT_ROOT, I2C_ADDRESS);
+}
+
+/**
+ * @brief Checks whether the cached mask can be trusted.
+ */
+static bool is_mask_valid()
+{
+	return s_mask_known && s_mask_faults == I2C_Bus_Get_Fault_Count();
+}
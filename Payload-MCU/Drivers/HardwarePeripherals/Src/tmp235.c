@@ -8,6 +8,8 @@
 #include "tmp235.h"
 #include "assert.h"
 #include "adc.h"
+#include "boot.h"
+#include "error_log.h"
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -15,17 +17,28 @@
 
 static const uint32_t TIMEOUT = 100; // in ms
 
+static bool s_adc_ready = false; // the ADC is only initialised on first use.
+
 #define PRINT_SUBJECT "PCB Sensor"
 
 bool TMP235_Read_Temp(uint16_t *out)
 {
+	if (!s_adc_ready)
+	{
+		// kept out of boot, as nothing needs the ADC until the first reading.
+		Boot_Stage_Begin(BOOT_STAGE_ADC);
+		MX_ADC1_Init();
+		Boot_Stage_End(BOOT_STAGE_ADC, BOOT_STAGE_OK);
+		s_adc_ready = true;
+	}
+
 	// perform self-calibration.
 	HAL_StatusTypeDef status;
 	status = HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED);
 	if (status != HAL_OK)
 	{
 		PRINT_ERROR("failed to calibrate. (HAL error code: %d)", status);
-		//PUT_ERROR(ERR_ADC_CALIBRATION_START, status);
+		Error_Log_Put(ERROR_ADC_CALIBRATION, status);
 		return false;
 	}
 
@@ -34,7 +47,7 @@ bool TMP235_Read_Temp(uint16_t *out)
 	if (status != HAL_OK)
 	{
 		PRINT_ERROR("failed to start conversion. (HAL error code: %d)", status);
-		//PUT_ERROR(ERR_ADC_START, status);
+		Error_Log_Put(ERROR_ADC_START, status);
 		return false;
 	}
 
@@ -42,7 +55,7 @@ bool TMP235_Read_Temp(uint16_t *out)
 	if (status != HAL_OK)
 	{
 		PRINT_ERROR("failed to complete conversion. (HAL error code: %d)", status);
-		//PUT_ERROR(ERR_ADC_POLL, status);
+		Error_Log_Put(ERROR_ADC_POLL, status);
 		return false;
 	}
 
@@ -53,7 +66,7 @@ bool TMP235_Read_Temp(uint16_t *out)
 	if (status != HAL_OK)
 	{
 		PRINT_ERROR("failed to complete conversion. (HAL error code: %d)", status);
-		//PUT_ERROR(ERR_ADC_GET_VALUE, status);
+		Error_Log_Put(ERROR_ADC_GET_VALUE, status);
 		return false;
 	}
 
@@ -62,3 +75,10 @@ bool TMP235_Read_Temp(uint16_t *out)
 
 	return true;
 }
+
+int16_t TMP235_To_Centidegrees(uint16_t raw)
+{
+	// 500 mV at 0 deg C, then 10 mV per degree.
+	int32_t millivolts = (int32_t)raw * 3300 / 4095;
+	return (int16_t)((millivolts - 500) * 10);
+}
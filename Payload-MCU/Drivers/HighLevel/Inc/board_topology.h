@@ -0,0 +1,165 @@
+/*
+ * board_topology.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Where every sensor and output of each well is wired on the board.
+ *
+ *  This is the only place the wiring is written down. The location tables,
+ *  per-channel read batches and per-expander pin masks used by the drivers are
+ *  all generated from BOARD_WELLS at compile time, and checked for collisions.
+ */
+
+#ifndef HIGHLEVEL_INC_BOARD_TOPOLOGY_H_
+#define HIGHLEVEL_INC_BOARD_TOPOLOGY_H_
+
+#include "well_id.h"
+#include "mux_adc_location.h"
+#include "tca9548.h"
+#include "tca9539.h"
+#include "expander_pin_location.h"
+#include "pp.h"
+
+#include <stdint.h>
+
+/*
+ * One row per well:
+ *
+ *   X(arg, well,
+ *     thermistor mux channel, thermistor ADC address,
+ *     photocell mux channel,  photocell ADC address,
+ *     heater expander,        heater pin,
+ *     LED expander,           LED pin)
+ *
+ * arg is passed through untouched, so a row macro can filter on it.
+ */
+#define BOARD_WELLS(X, arg) \
+	X(arg, WELL_0,  MUX_CHANNEL_3, ADC_A0, MUX_CHANNEL_4, ADC_A0, EXPANDER_1, EXPANDER_PIN_3,  EXPANDER_1, EXPANDER_PIN_2 ) \
+	X(arg, WELL_1,  MUX_CHANNEL_3, ADC_A1, MUX_CHANNEL_4, ADC_A1, EXPANDER_1, EXPANDER_PIN_1,  EXPANDER_1, EXPANDER_PIN_0 ) \
+	X(arg, WELL_2,  MUX_CHANNEL_3, ADC_A2, MUX_CHANNEL_4, ADC_A2, EXPANDER_1, EXPANDER_PIN_17, EXPANDER_1, EXPANDER_PIN_16) \
+	X(arg, WELL_3,  MUX_CHANNEL_3, ADC_A4, MUX_CHANNEL_4, ADC_A4, EXPANDER_1, EXPANDER_PIN_15, EXPANDER_1, EXPANDER_PIN_14) \
+	X(arg, WELL_4,  MUX_CHANNEL_3, ADC_A5, MUX_CHANNEL_4, ADC_A5, EXPANDER_1, EXPANDER_PIN_5,  EXPANDER_1, EXPANDER_PIN_4 ) \
+	X(arg, WELL_5,  MUX_CHANNEL_3, ADC_A6, MUX_CHANNEL_4, ADC_A6, EXPANDER_1, EXPANDER_PIN_7,  EXPANDER_1, EXPANDER_PIN_6 ) \
+	X(arg, WELL_6,  MUX_CHANNEL_3, ADC_A7, MUX_CHANNEL_4, ADC_A7, EXPANDER_1, EXPANDER_PIN_11, EXPANDER_1, EXPANDER_PIN_10) \
+	X(arg, WELL_7,  MUX_CHANNEL_5, ADC_A0, MUX_CHANNEL_5, ADC_A1, EXPANDER_1, EXPANDER_PIN_13, EXPANDER_1, EXPANDER_PIN_12) \
+	X(arg, WELL_8,  MUX_CHANNEL_0, ADC_A0, MUX_CHANNEL_1, ADC_A0, EXPANDER_2, EXPANDER_PIN_3,  EXPANDER_2, EXPANDER_PIN_2 ) \
+	X(arg, WELL_9,  MUX_CHANNEL_0, ADC_A1, MUX_CHANNEL_1, ADC_A1, EXPANDER_2, EXPANDER_PIN_1,  EXPANDER_2, EXPANDER_PIN_0 ) \
+	X(arg, WELL_10, MUX_CHANNEL_0, ADC_A2, MUX_CHANNEL_1, ADC_A2, EXPANDER_2, EXPANDER_PIN_17, EXPANDER_2, EXPANDER_PIN_16) \
+	X(arg, WELL_11, MUX_CHANNEL_0, ADC_A4, MUX_CHANNEL_1, ADC_A4, EXPANDER_2, EXPANDER_PIN_15, EXPANDER_2, EXPANDER_PIN_14) \
+	X(arg, WELL_12, MUX_CHANNEL_0, ADC_A5, MUX_CHANNEL_1, ADC_A5, EXPANDER_2, EXPANDER_PIN_5,  EXPANDER_2, EXPANDER_PIN_4 ) \
+	X(arg, WELL_13, MUX_CHANNEL_0, ADC_A6, MUX_CHANNEL_1, ADC_A6, EXPANDER_2, EXPANDER_PIN_7,  EXPANDER_2, EXPANDER_PIN_6 ) \
+	X(arg, WELL_14, MUX_CHANNEL_0, ADC_A7, MUX_CHANNEL_1, ADC_A7, EXPANDER_2, EXPANDER_PIN_11, EXPANDER_2, EXPANDER_PIN_10) \
+	X(arg, WELL_15, MUX_CHANNEL_2, ADC_A0, MUX_CHANNEL_2, ADC_A1, EXPANDER_2, EXPANDER_PIN_13, EXPANDER_2, EXPANDER_PIN_12)
+
+#define BOARD_NUM_WELLS (WELL_15 + 1)
+#define BOARD_NUM_MUX_CHANNELS (MUX_CHANNEL_5 + 1)
+
+////////////////////////////////////////////////////////
+/// GENERATED TABLES
+////////////////////////////////////////////////////////
+
+// initialisers for MuxADCLocation[BOARD_NUM_WELLS], indexed by well.
+#define BOARD_THERMISTOR_LOCATIONS { BOARD_WELLS(BOARD_THERMISTOR_LOCATION_, ~) }
+#define BOARD_PHOTOCELL_LOCATIONS  { BOARD_WELLS(BOARD_PHOTOCELL_LOCATION_, ~) }
+
+// initialisers for ExpanderPinLocation[BOARD_NUM_WELLS], indexed by well.
+#define BOARD_HEATER_LOCATIONS { BOARD_WELLS(BOARD_HEATER_LOCATION_, ~) }
+#define BOARD_LED_LOCATIONS    { BOARD_WELLS(BOARD_LED_LOCATION_, ~) }
+
+// wells whose sensor is behind a mux channel. bit n is well n.
+#define BOARD_THERMISTORS_ON_CHANNEL(channel) ((uint16_t)(0u BOARD_WELLS(BOARD_THERMISTOR_ON_CHANNEL_, channel)))
+#define BOARD_PHOTOCELLS_ON_CHANNEL(channel)  ((uint16_t)(0u BOARD_WELLS(BOARD_PHOTOCELL_ON_CHANNEL_, channel)))
+
+// mux channels with a device at an address also used behind the given
+// channel, so they can't be enabled alongside it. bit n is channel n.
+#define BOARD_MUX_CONFLICTS(channel) ((uint8_t)( \
+	BOARD_MUX_CONFLICT_(channel, MUX_CHANNEL_0) | BOARD_MUX_CONFLICT_(channel, MUX_CHANNEL_1) | \
+	BOARD_MUX_CONFLICT_(channel, MUX_CHANNEL_2) | BOARD_MUX_CONFLICT_(channel, MUX_CHANNEL_3) | \
+	BOARD_MUX_CONFLICT_(channel, MUX_CHANNEL_4) | BOARD_MUX_CONFLICT_(channel, MUX_CHANNEL_5) ))
+
+// initialiser for uint8_t[BOARD_NUM_MUX_CHANNELS], indexed by channel.
+#define BOARD_MUX_CONFLICT_TABLE { \
+	[MUX_CHANNEL_0] = BOARD_MUX_CONFLICTS(MUX_CHANNEL_0), [MUX_CHANNEL_1] = BOARD_MUX_CONFLICTS(MUX_CHANNEL_1), \
+	[MUX_CHANNEL_2] = BOARD_MUX_CONFLICTS(MUX_CHANNEL_2), [MUX_CHANNEL_3] = BOARD_MUX_CONFLICTS(MUX_CHANNEL_3), \
+	[MUX_CHANNEL_4] = BOARD_MUX_CONFLICTS(MUX_CHANNEL_4), [MUX_CHANNEL_5] = BOARD_MUX_CONFLICTS(MUX_CHANNEL_5) }
+
+// expander pins driving an output. bit n is ExpanderPinID n.
+#define BOARD_HEATER_PINS(device) ((uint16_t)(0u BOARD_WELLS(BOARD_HEATER_PIN_, device)))
+#define BOARD_LED_PINS(device)    ((uint16_t)(0u BOARD_WELLS(BOARD_LED_PIN_, device)))
+
+////////////////////////////////////////////////////////
+/// COLLISION CHECKS
+////////////////////////////////////////////////////////
+
+/*
+ * A sum of single bits only equals their OR if no bit appears twice, so
+ * comparing the two finds any address or pin used more than once.
+ */
+
+// no two ADCs behind the same mux channel share an address.
+#define BOARD_CHANNEL_IS_UNIQUE(channel) \
+	( (0ull BOARD_WELLS(BOARD_ADDRESS_SUM_LO_, channel)) == (0ull BOARD_WELLS(BOARD_ADDRESS_OR_LO_, channel)) \
+	&& (0ull BOARD_WELLS(BOARD_ADDRESS_SUM_HI_, channel)) == (0ull BOARD_WELLS(BOARD_ADDRESS_OR_HI_, channel)) )
+
+// no two outputs share an expander pin.
+#define BOARD_EXPANDER_IS_UNIQUE(device) \
+	( (0u BOARD_WELLS(BOARD_PIN_SUM_, device)) == (0u BOARD_WELLS(BOARD_PIN_OR_, device)) )
+
+////////////////////////////////////////////////////////
+/// INTERNAL MACROS
+////////////////////////////////////////////////////////
+
+#define BOARD_THERMISTOR_LOCATION_(arg, well, tc, ta, pc, pa, he, hp, le, lp) [well] = { tc, ta },
+#define BOARD_PHOTOCELL_LOCATION_(arg, well, tc, ta, pc, pa, he, hp, le, lp)  [well] = { pc, pa },
+#define BOARD_HEATER_LOCATION_(arg, well, tc, ta, pc, pa, he, hp, le, lp)     [well] = { he, hp },
+#define BOARD_LED_LOCATION_(arg, well, tc, ta, pc, pa, he, hp, le, lp)        [well] = { le, lp },
+
+#define BOARD_THERMISTOR_ON_CHANNEL_(arg, well, tc, ta, pc, pa, he, hp, le, lp) | ((tc) == (arg) ? 1u << (well) : 0u)
+#define BOARD_PHOTOCELL_ON_CHANNEL_(arg, well, tc, ta, pc, pa, he, hp, le, lp)  | ((pc) == (arg) ? 1u << (well) : 0u)
+
+#define BOARD_HEATER_PIN_(arg, well, tc, ta, pc, pa, he, hp, le, lp) | ((he) == (arg) ? 1u << (hp) : 0u)
+#define BOARD_LED_PIN_(arg, well, tc, ta, pc, pa, he, hp, le, lp)    | ((le) == (arg) ? 1u << (lp) : 0u)
+
+// 7-bit addresses split over two 64-bit words.
+#define BOARD_BIT_LO_(address) ((address) < 64 ? 1ull << ((address) & 63) : 0ull)
+#define BOARD_BIT_HI_(address) ((address) < 64 ? 0ull : 1ull << ((address) & 63))
+
+#define BOARD_ADDRESS_BITS_(op, half, arg, tc, ta, pc, pa) \
+	op ((tc) == (arg) ? BOARD_BIT_##half##_(ta) : 0ull) \
+	op ((pc) == (arg) ? BOARD_BIT_##half##_(pa) : 0ull)
+
+#define BOARD_ADDRESS_SUM_LO_(arg, well, tc, ta, pc, pa, he, hp, le, lp) BOARD_ADDRESS_BITS_(+, LO, arg, tc, ta, pc, pa)
+#define BOARD_ADDRESS_OR_LO_(arg, well, tc, ta, pc, pa, he, hp, le, lp)  BOARD_ADDRESS_BITS_(|, LO, arg, tc, ta, pc, pa)
+#define BOARD_ADDRESS_SUM_HI_(arg, well, tc, ta, pc, pa, he, hp, le, lp) BOARD_ADDRESS_BITS_(+, HI, arg, tc, ta, pc, pa)
+#define BOARD_ADDRESS_OR_HI_(arg, well, tc, ta, pc, pa, he, hp, le, lp)  BOARD_ADDRESS_BITS_(|, HI, arg, tc, ta, pc, pa)
+
+// addresses of the ADCs behind a mux channel, in two halves.
+#define BOARD_ADDRESSES_LO_(channel) (0ull BOARD_WELLS(BOARD_ADDRESS_OR_LO_, channel))
+#define BOARD_ADDRESSES_HI_(channel) (0ull BOARD_WELLS(BOARD_ADDRESS_OR_HI_, channel))
+
+#define BOARD_MUX_CONFLICT_(channel, other) \
+	( (other) != (channel) \
+	&& ((BOARD_ADDRESSES_LO_(channel) & BOARD_ADDRESSES_LO_(other)) \
+	|| (BOARD_ADDRESSES_HI_(channel) & BOARD_ADDRESSES_HI_(other))) ? 1u << (other) : 0u )
+
+#define BOARD_PIN_BITS_(op, arg, he, hp, le, lp) \
+	op ((he) == (arg) ? 1u << (hp) : 0u) \
+	op ((le) == (arg) ? 1u << (lp) : 0u)
+
+#define BOARD_PIN_SUM_(arg, well, tc, ta, pc, pa, he, hp, le, lp) BOARD_PIN_BITS_(+, arg, he, hp, le, lp)
+#define BOARD_PIN_OR_(arg, well, tc, ta, pc, pa, he, hp, le, lp)  BOARD_PIN_BITS_(|, arg, he, hp, le, lp)
+
+////////////////////////////////////////////////////////
+/// ASSERTIONS
+////////////////////////////////////////////////////////
+
+CASSERT(BOARD_CHANNEL_IS_UNIQUE(MUX_CHANNEL_0), board_topology)
+CASSERT(BOARD_CHANNEL_IS_UNIQUE(MUX_CHANNEL_1), board_topology)
+CASSERT(BOARD_CHANNEL_IS_UNIQUE(MUX_CHANNEL_2), board_topology)
+CASSERT(BOARD_CHANNEL_IS_UNIQUE(MUX_CHANNEL_3), board_topology)
+CASSERT(BOARD_CHANNEL_IS_UNIQUE(MUX_CHANNEL_4), board_topology)
+CASSERT(BOARD_CHANNEL_IS_UNIQUE(MUX_CHANNEL_5), board_topology)
+CASSERT(BOARD_EXPANDER_IS_UNIQUE(EXPANDER_1), board_topology)
+CASSERT(BOARD_EXPANDER_IS_UNIQUE(EXPANDER_2), board_topology)
+
+#endif /* HIGHLEVEL_INC_BOARD_TOPOLOGY_H_ */
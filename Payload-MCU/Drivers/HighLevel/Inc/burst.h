@@ -0,0 +1,65 @@
+/*
+ * burst.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Samples one sensor back-to-back at the full I2C rate, then streams
+ *           the samples to CDH, e.g. to characterise the step response of a
+ *           heater or the flicker of an LED.
+ *
+ *  Capturing runs in short slices from the main loop, so CAN and the LED
+ *  programs keep running. The multiplexer stays on the sensor's channel for
+ *  the whole capture, as nothing else reads sensors while a capture runs.
+ *
+ *  The capture is announced with a CMD_CDH_PROCESS_BURST_INFO frame, then
+ *  its BurstSample records are sent as a bulk transfer. see bulk.h.
+ */
+
+#ifndef HIGHLEVEL_INC_BURST_H_
+#define HIGHLEVEL_INC_BURST_H_
+
+#include "sensors.h"
+#include "well_id.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BURST_MAX_SAMPLES 4096
+
+// stored for samples that could not be read. readings are only 12 bits.
+#define BURST_INVALID_READING 0xFFFF
+
+// one sample, as stored and sent. little-endian.
+typedef struct
+{
+	uint16_t reading;  // MCP3221 reading, calibrated like telemetry. see calibration.h.
+	uint16_t interval; // us since the previous sample, or the start for the first.
+} BurstSample;
+
+typedef enum {
+	BURST_IDLE = 0,
+	BURST_CAPTURING,
+	BURST_ANNOUNCING, // captured, waiting to send the info frame.
+	BURST_STREAMING
+} BurstState;
+
+/**
+ * @brief Starts capturing a sensor. Cancels any capture in progress.
+ *
+ * @param count	The number of samples to take. At most BURST_MAX_SAMPLES.
+ * @return		true on success. false if the arguments are invalid.
+ */
+bool Burst_Start(SensorType type, WellID well_id, uint16_t count);
+
+/**
+ * @brief Takes the next slice of samples, or sends the next frames once the
+ *        capture is complete. Call from the main loop.
+ */
+void Burst_Update();
+
+/**
+ * @brief Gets what the burst capture is doing.
+ */
+BurstState Burst_Get_State();
+
+#endif /* HIGHLEVEL_INC_BURST_H_ */
@@ -0,0 +1,87 @@
+/*
+ * calibration.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Per-sensor calibration of the raw ADC readings, kept in flash.
+ *
+ *  Each sensor has a gain and an offset, and optionally a few points of a
+ *  piecewise-linear curve applied after them. The gains and offsets of a
+ *  sweep are applied to all 16 wells of a type in one pass (see
+ *  sensor_math.h); only sensors with a curve take a second, per-sensor step.
+ *
+ *  Uploads take effect at once, and each changed sensor is saved to the
+ *  config store once they have settled.
+ */
+
+#ifndef HIGHLEVEL_INC_CALIBRATION_H_
+#define HIGHLEVEL_INC_CALIBRATION_H_
+
+#include "sensors.h"
+#include "well_id.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CALIBRATION_MAX_POINTS 4
+
+// a point of the curve, from the reading after gain and offset to the
+// calibrated reading, both in ADC counts.
+typedef struct
+{
+	uint16_t in;
+	uint16_t out;
+} CalibrationPoint;
+
+/**
+ * @brief Loads the calibration from flash. Sensors are left uncalibrated if
+ *        none is saved, or it doesn't check out.
+ */
+void Calibration_Init();
+
+/**
+ * @brief Saves the calibration once uploads have settled.
+ */
+void Calibration_Update();
+
+/**
+ * @brief Sets the gain and offset of a sensor, and clears its curve.
+ *
+ * @param gain		Q14 (see SENSOR_MATH_GAIN_ONE), from 0 to INT16_MAX.
+ * @param offset	In ADC counts.
+ * @return			true on success. false if the sensor or gain is invalid.
+ */
+bool Calibration_Set(SensorType type, WellID well_id, int16_t gain, int16_t offset);
+
+/**
+ * @brief Sets a point of a sensor's curve.
+ *
+ * Point 0 starts a new curve, so it is sent first. The curve is only used
+ * once every point of it has been set since, and each point's input is
+ * above the one before it. A count that differs from the curve's points
+ * so far starts it over, as does Calibration_Set.
+ *
+ * @param index		Of the point, from 0.
+ * @param count		Points in the curve, from 2 to CALIBRATION_MAX_POINTS,
+ * 					once this one is set.
+ * @return			true on success. false if the sensor or point is invalid.
+ */
+bool Calibration_Set_Point(SensorType type, WellID well_id, uint8_t index, uint8_t count,
+		const CalibrationPoint *point);
+
+/**
+ * @brief Calibrates the valid readings of a snapshot, in place.
+ */
+void Calibration_Apply(SensorSnapshot *snapshot);
+
+/**
+ * @brief Calibrates a single reading.
+ */
+uint16_t Calibration_Apply_One(SensorType type, WellID well_id, uint16_t reading);
+
+/**
+ * @brief Prints the sensors that aren't at the identity calibration.
+ */
+void Calibration_Print();
+
+#endif /* HIGHLEVEL_INC_CALIBRATION_H_ */
@@ -0,0 +1,67 @@
+/*
+ * config_store.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Persistent key/value store for the payload's configuration.
+ *
+ *  Values are appended to a flash page as checksummed records, so changing
+ *  one costs a few double-word writes rather than a page erase. The newest
+ *  valid record of a key wins, and a record cut short by a reset fails its
+ *  checksum and is ignored, so each update is atomic. When the page fills,
+ *  the newest record of every key is copied to the other page, whose header
+ *  is written last: until then, the old page is still the one in use.
+ *
+ *  An index of where each key's newest record is, built at boot, makes every
+ *  lookup O(1).
+ */
+
+#ifndef HIGHLEVEL_INC_CONFIG_STORE_H_
+#define HIGHLEVEL_INC_CONFIG_STORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define CONFIG_MAX_VALUE_SIZE 64
+
+typedef enum {
+	CONFIG_KEY_SETPOINTS = 0,      // int16_t[16]. see TCS_Set_Setpoint.
+	CONFIG_KEY_TELEMETRY_INTERVAL, // uint32_t. TIM2 autoreload value.
+	CONFIG_KEY_LED_PROGRAMS,       // LEDProgram. one key per well from here.
+	CONFIG_KEY_CALIBRATION = CONFIG_KEY_LED_PROGRAMS + 16, // one key per sensor from here, by type then well.
+	NUM_CONFIG_KEYS = CONFIG_KEY_CALIBRATION + 2 * 16
+} ConfigKey;
+
+/**
+ * @brief Finds the page in use and indexes it, or starts an empty store if
+ *        there is none.
+ *
+ * @return true on success. false if the store couldn't be started, in which
+ *         case every key reads as unset.
+ */
+bool Config_Init();
+
+/**
+ * @brief Reads the value of a key.
+ *
+ * @param out	Where to copy the value.
+ * @param size	The size of out. Longer values are cut short.
+ * @return		The size of the stored value. 0 if the key is unset.
+ */
+size_t Config_Get(ConfigKey key, void *out, size_t size);
+
+/**
+ * @brief Writes the value of a key, unless it is unchanged.
+ *
+ * @param size	Up to CONFIG_MAX_VALUE_SIZE.
+ * @return		true on success. false on error.
+ */
+bool Config_Set(ConfigKey key, const void *data, size_t size);
+
+/**
+ * @brief Prints the page in use, how full it is and the compactions so far.
+ */
+void Config_Print_Stats();
+
+#endif /* HIGHLEVEL_INC_CONFIG_STORE_H_ */
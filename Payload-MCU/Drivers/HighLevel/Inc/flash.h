@@ -10,30 +10,38 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
+
+// Pages at the top of flash reserved for persistent payload data.
+// The linker script keeps program code below FLASH_RESERVED_START_ADDR.
+#define FLASH_RESERVED_START_ADDR    0x08060000
+#define FLASH_RESERVED_END_ADDR      0x08080000
+
+#define FLASH_LOG_START_ADDR         0x08060000
+#define FLASH_LOG_END_ADDR           0x0807C000
+#define FLASH_CONFIG_A_ADDR          0x0807C000
+#define FLASH_CONFIG_B_ADDR          0x0807C800
+#define FLASH_WARM_STATE_ADDR        0x0807D800
 
 /**
- * @brief   Writes data to a specified location in the current memory block in use.
+ * @brief   Erases the flash page containing the given address.
  *
- * @param memory_offset Byte offset in the current block.
- * @param data          The data to write.
- * @param data_size     The number of bytes to write.
- * @return              true on success. false on error.
+ * @param address   Any address within the reserved region.
+ * @return          true on success. false on error.
  */
-bool Flash_Write(int memory_offset, uint8_t *data, size_t data_size);
+bool Flash_Erase_Page(uint32_t address);
 
 /**
- * @brief   Reads data from a specified location in the current memory block in use.
+ * @brief   Programs data into previously erased flash.
  *
- * @param memory_offset Byte offset in the current block.
- * @param data_size     The number of bytes to read.
- * @param data_out      The data to read.
- * @return              true on success. false on error.
+ * Data is written one double word at a time, so the final double word is
+ * padded with 0xFF if data_size is not a multiple of 8.
+ *
+ * @param address   Destination address. Must be 8 byte aligned.
+ * @param data      The data to write.
+ * @param data_size The number of bytes to write.
+ * @return          true on success. false on error.
  */
-bool Flash_Read(int memory_offset, size_t data_size, uint8_t *data_out);
-
-//bool Flash_Write_LED_Status(int id, Power status);
-//Power Flash_Read_LED_Status(int id);
-//bool Flash_Write_Well_Temperature(int id, uint8_t temp);
-//int8_t Flash_Read_Well_Temperature(int id);
+bool Flash_Program(uint32_t address, const void *data, size_t data_size);
 
 #endif /* HIGHLEVEL_INC_FLASH_H_ */
@@ -0,0 +1,98 @@
+/*
+ * flash_log.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Keeps a compressed history of sensor snapshots in flash.
+ *
+ *  Snapshots are compressed into a chunk in RAM (see snapshot_codec.h), which
+ *  is written to flash once full. Every chunk starts a new stream, so each can
+ *  be decoded on its own. The log area is used as a ring: once it is full, the
+ *  oldest page is erased to make room.
+ *
+ *  Other records, such as faults, are stored one per chunk, uncompressed, and
+ *  are told apart by the magic of their chunk.
+ */
+
+#ifndef HIGHLEVEL_INC_FLASH_LOG_H_
+#define HIGHLEVEL_INC_FLASH_LOG_H_
+
+#include "sensors.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLASH_LOG_CHUNK_SIZE 256
+
+typedef enum {
+	FLASH_LOG_SNAPSHOTS = 0, // compressed sensor snapshots.
+	FLASH_LOG_FAULT,         // a FaultRecord.
+	NUM_FLASH_LOG_TYPES
+} FlashLogType;
+
+// a chunk, as stored in flash.
+typedef struct
+{
+	uint32_t crc;      // covers the fields below and the used data.
+	uint32_t magic;    // identifies the type of chunk.
+	uint32_t sequence; // counts up from the first chunk ever written.
+	uint16_t size;     // bytes of data.
+	uint16_t records;  // records in the data.
+	uint8_t data[FLASH_LOG_CHUNK_SIZE - 16];
+} FlashLogChunk;
+
+/**
+ * @brief Finds where the log left off.
+ */
+void Flash_Log_Init();
+
+/**
+ * @brief Adds a snapshot to the log.
+ *
+ * @return true on success. false if a full chunk couldn't be written, or if
+ *         the snapshot was dropped because the page the chunk goes in is
+ *         being downlinked.
+ */
+bool Flash_Log_Append(const SensorSnapshot *snapshot);
+
+/**
+ * @brief Writes a record to a chunk of its own.
+ *
+ * Snapshots logged so far are flushed first, so the log stays in order.
+ *
+ * @param type	Type of the record. not FLASH_LOG_SNAPSHOTS.
+ * @return		true on success. false on error, or if the record doesn't
+ * 				fit in a chunk.
+ */
+bool Flash_Log_Append_Record(FlashLogType type, const void *data, uint16_t size);
+
+/**
+ * @brief Writes the chunk being filled to flash, even if it isn't full.
+ *
+ * The chunk is kept in RAM if writing it would erase the page being
+ * downlinked.
+ *
+ * @return true on success. false on error, or if the chunk was kept.
+ */
+bool Flash_Log_Flush();
+
+/**
+ * @brief Gets the address of a page of the log, to be downlinked.
+ *
+ * The page won't be erased for as long as a BULK_SOURCE_LOG transfer is in
+ * progress. Snapshots that would need it erased are dropped meanwhile.
+ *
+ * @param pages_back	0 for the page holding the newest chunk, 1 for the one
+ * 						before it, and so on.
+ * @return				The address of the page, or 0 if it holds no chunks, is
+ * 						still being written, or the log area doesn't have that
+ * 						many pages.
+ */
+uint32_t Flash_Log_Get_Page(uint32_t pages_back);
+
+/**
+ * @brief Prints how well snapshots compress, and how long it takes.
+ */
+void Flash_Log_Print_Stats();
+
+#endif /* HIGHLEVEL_INC_FLASH_LOG_H_ */
@@ -0,0 +1,104 @@
+/*
+ * heater_budget.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Keeps the heaters within the power the satellite bus can give
+ *           the payload.
+ *
+ *  Every heater write goes through the budget. When more heaters are asked
+ *  for than the limit allows, the lowest ranked are held off. Wells rank by
+ *  their experiment priority, then by how far they are below their setpoint.
+ *  The TCS keeps its total duty within what the budget leaves it, so only
+ *  heaters switched by command are normally held off.
+ */
+
+#ifndef HIGHLEVEL_INC_HEATER_BUDGET_H_
+#define HIGHLEVEL_INC_HEATER_BUDGET_H_
+
+#include "well_id.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HEATER_BUDGET_DEFAULT_LIMIT 4000 // in mW.
+
+typedef struct
+{
+	uint8_t utilisation; // average heater power as a percentage of the limit.
+	uint8_t peak;        // most heaters on at once.
+	uint8_t max;         // heaters the limit allows at once.
+	uint16_t held;       // bit n is set if well n's heater was held off.
+} HeaterBudgetStats;
+
+/**
+ * @brief Sets the power the heaters may draw at once.
+ *
+ * Heaters already on above the new limit stay on until their next write.
+ *
+ * @param limit	In mW.
+ */
+void Heater_Budget_Set_Limit(uint16_t limit);
+
+/**
+ * @brief Gets the power the heaters may draw at once, in mW.
+ */
+uint16_t Heater_Budget_Get_Limit();
+
+/**
+ * @brief Gets the number of heaters the limit allows on at once.
+ */
+uint32_t Heater_Budget_Get_Max_Heaters();
+
+/**
+ * @brief Sets the priority of a well's experiment. Higher priorities keep
+ *        their heater when the budget is short. All wells start at 0.
+ *
+ * @return true on success. false if the well is invalid.
+ */
+bool Heater_Budget_Set_Priority(WellID well_id, uint8_t priority);
+
+/**
+ * @brief Sets how far a well is below its setpoint, used to rank wells of
+ *        the same priority.
+ *
+ * @param error	In hundredths of a degree. 0 or less for wells that don't
+ * 				need heat, or aren't regulated.
+ */
+void Heater_Budget_Set_Error(WellID well_id, int16_t error);
+
+/**
+ * @brief Gets the rank of a well. A higher rank keeps its heater.
+ */
+uint32_t Heater_Budget_Get_Rank(WellID well_id);
+
+/**
+ * @brief Picks which of the requested heaters may be on.
+ *
+ * @param requested	Bit n is set if the heater in well n is wanted on.
+ * @return			The requested heaters, less the lowest ranked ones that
+ * 					don't fit in the limit.
+ */
+uint16_t Heater_Budget_Apply(uint16_t requested);
+
+/**
+ * @brief Gets the heaters held off by the last Heater_Budget_Apply.
+ */
+uint16_t Heater_Budget_Get_Held();
+
+/**
+ * @brief Records the heaters now on, for the utilisation.
+ */
+void Heater_Budget_Record(uint16_t heaters);
+
+/**
+ * @brief Gets the utilisation since the last call, then starts over.
+ */
+void Heater_Budget_Take_Stats(HeaterBudgetStats *out);
+
+/**
+ * @brief Prints the limit, the heaters on and held off, and the priorities.
+ */
+void Heater_Budget_Print();
+
+#endif /* HIGHLEVEL_INC_HEATER_BUDGET_H_ */
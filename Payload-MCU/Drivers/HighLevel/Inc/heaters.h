@@ -12,7 +12,32 @@
 #include "power.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
+/**
+ * @brief Sets the power of one heater, within the heater budget.
+ *
+ * @return true on success. false on error, or if the budget held it off.
+ */
 bool Heaters_Set_Heater(WellID well_id, Power power);
 
+/**
+ * @brief Sets the power of every heater at once.
+ *
+ * Uses a single bulk write per IO expander. LED outputs are unaffected.
+ * Heaters that don't fit in the heater budget are held off, which isn't an
+ * error. Heaters_Get_All tells which are on.
+ *
+ * @param well_bitmap	bit n is the requested state of the heater in well n.
+ * @return true on success. false on error.
+ */
+bool Heaters_Set_All(uint16_t well_bitmap);
+
+/**
+ * @brief Gets the last successfully written state of every heater.
+ *
+ * @return bit n is the state of the heater in well n.
+ */
+uint16_t Heaters_Get_All();
+
 #endif /* HIGHLEVEL_INC_HEATERS_H_ */
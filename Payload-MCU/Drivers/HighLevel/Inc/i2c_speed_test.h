@@ -0,0 +1,29 @@
+/*
+ * i2c_speed_test.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Picks the fastest I2C speed each segment of the bus works at.
+ */
+
+#ifndef HIGHLEVEL_INC_I2C_SPEED_TEST_H_
+#define HIGHLEVEL_INC_I2C_SPEED_TEST_H_
+
+#include "i2c_bus.h"
+
+/**
+ * @brief Tries every device at each speed up to the given one, and sets each
+ *        segment to the fastest speed at which it does no worse than at
+ *        100 kHz.
+ *
+ * The root segment (multiplexer and IO expanders) is tested first, as the
+ * other segments are reached through it. A full sensor sweep is then timed
+ * at each speed and printed.
+ *
+ * Takes a few hundred ms. Meant to be run once at startup.
+ *
+ * @param max_speed	The fastest speed to try.
+ */
+void I2C_Speed_Test_Run(I2CSpeed max_speed);
+
+#endif /* HIGHLEVEL_INC_I2C_SPEED_TEST_H_ */
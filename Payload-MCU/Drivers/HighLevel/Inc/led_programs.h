@@ -0,0 +1,87 @@
+/*
+ * led_programs.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Per-well photoperiod (light/dark cycle) programs for the LEDs.
+ */
+
+#ifndef HIGHLEVEL_INC_LED_PROGRAMS_H_
+#define HIGHLEVEL_INC_LED_PROGRAMS_H_
+
+#include "well_id.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * A repeating light/dark cycle for the LED of a single well.
+ *
+ * All times are in seconds. A program with an on_time of 0 keeps the LED off,
+ * and a program with an off_time of 0 keeps it on. A whole cycle, on_time
+ * plus off_time, can be at most LED_PROGRAM_MAX_PERIOD.
+ */
+#define LED_PROGRAM_MAX_PERIOD UINT16_MAX // so a position in the cycle fits LEDProgramState.
+
+typedef struct
+{
+	uint16_t on_time;  // time spent lit at the start of each cycle.
+	uint16_t off_time; // time spent dark at the end of each cycle.
+	uint16_t phase;    // how far into its first cycle the program starts.
+	uint8_t repeats;   // number of cycles to run. 0 repeats forever.
+	uint8_t reserved;
+} LEDProgram;
+
+// progress of a well through its program.
+typedef struct
+{
+	uint16_t position; // seconds into the current cycle.
+	uint16_t cycles;   // completed cycles.
+} LEDProgramState;
+
+/**
+ * @brief Loads the saved programs from flash and starts the program clock.
+ */
+void LED_Programs_Init();
+
+/**
+ * @brief Advances the program clock and applies any change in LED states.
+ *
+ * Should be called regularly from the main loop. All 16 programs are
+ * evaluated in one pass per elapsed second, and the LEDs are only written
+ * to when their combined state changes.
+ */
+void LED_Programs_Update();
+
+/**
+ * @brief Replaces the program of a well. The program restarts immediately.
+ *
+ * The new programs are saved to flash once uploads have settled.
+ *
+ * @return true on success. false if the well is invalid or the program's
+ *         period is over LED_PROGRAM_MAX_PERIOD.
+ */
+bool LED_Programs_Set(WellID well_id, const LEDProgram *program);
+
+/**
+ * @brief Gets the progress of every well through its program.
+ *
+ * @param out	Array of 16 states, indexed by well.
+ */
+void LED_Programs_Get_States(LEDProgramState *out);
+
+/**
+ * @brief Resumes every program from previously saved progress.
+ *
+ * @param states	Array of 16 states, indexed by well.
+ */
+void LED_Programs_Restore_States(const LEDProgramState *states);
+
+/**
+ * @brief Lights every LED until the next program tick.
+ *
+ * @return true on success. false on error.
+ */
+bool LED_Programs_Test();
+
+#endif /* HIGHLEVEL_INC_LED_PROGRAMS_H_ */
@@ -12,6 +12,7 @@
 #include "power.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * @brief Sets the power of an LED in a specific well on or off.
@@ -19,4 +20,21 @@
  */
 bool LEDs_Set_LED(WellID well_id, Power power);
 
+/**
+ * @brief Sets the power of every LED at once.
+ *
+ * Uses a single bulk write per IO expander. Heater outputs are unaffected.
+ *
+ * @param well_bitmap	bit n is the requested state of the LED in well n.
+ * @return true on success. false on error.
+ */
+bool LEDs_Set_All(uint16_t well_bitmap);
+
+/**
+ * @brief Gets the last successfully written state of every LED.
+ *
+ * @return bit n is the state of the LED in well n.
+ */
+uint16_t LEDs_Get_All();
+
 #endif /* HIGHLEVEL_INC_LEDS_H_ */
@@ -0,0 +1,64 @@
+/*
+ * sensor_health.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Judges whether each sensor can be trusted, and takes the ones
+ *           that can't out of the sweep.
+ *
+ *  Every reading is checked for failures to read, readings at the rails,
+ *  jumps faster than the quantity can change and values stuck for too long,
+ *  as far as each type of sensor allows. A sensor with a few faults in a row
+ *  is quarantined: it is no longer swept, only re-probed now and then, with
+ *  the time between probes doubling while it keeps failing.
+ */
+
+#ifndef HIGHLEVEL_INC_SENSOR_HEALTH_H_
+#define HIGHLEVEL_INC_SENSOR_HEALTH_H_
+
+#include "sensors.h"
+#include "well_id.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Gets the sensors of a type to read in this sweep: those not
+ *        quarantined, and those due to be re-probed.
+ *
+ * @return Bit n is set if well n is due.
+ */
+uint16_t Sensor_Health_Get_Due(SensorType type);
+
+/**
+ * @brief Updates the health of a sensor with the outcome of reading it.
+ *
+ * @param read		Whether the sensor was read.
+ * @param reading	The raw reading, if it was.
+ * @param timestamp	When it was read. see Timebase_Now.
+ * @return			true if the reading is plausible and can be used.
+ * 					false otherwise.
+ */
+bool Sensor_Health_Update(SensorType type, WellID well_id, bool read, uint16_t reading, uint32_t timestamp);
+
+/**
+ * @brief Gets the quarantined sensors of a type.
+ *
+ * @return Bit n is set if well n is quarantined.
+ */
+uint16_t Sensor_Health_Get_Quarantined(SensorType type);
+
+/**
+ * @brief Gets the sensors of a type that are still swept, but have recently
+ *        faulted or look stuck.
+ *
+ * @return Bit n is set if well n is suspect.
+ */
+uint16_t Sensor_Health_Get_Suspect(SensorType type);
+
+/**
+ * @brief Prints the sensors that are suspect or quarantined.
+ */
+void Sensor_Health_Print();
+
+#endif /* HIGHLEVEL_INC_SENSOR_HEALTH_H_ */
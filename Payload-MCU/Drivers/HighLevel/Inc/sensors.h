@@ -0,0 +1,59 @@
+/*
+ * sensors.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Common read path for the ADCs behind the multiplexer.
+ */
+
+#ifndef HIGHLEVEL_INC_SENSORS_H_
+#define HIGHLEVEL_INC_SENSORS_H_
+
+#include "well_id.h"
+#include "mux_adc_location.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+	SENSOR_THERMISTOR = 0,
+	SENSOR_PHOTOCELL,
+	NUM_SENSOR_TYPES
+} SensorType;
+
+// one reading of every sensor.
+typedef struct
+{
+	uint16_t readings[NUM_SENSOR_TYPES][16]; // calibrated MCP3221 readings, by type then well.
+	uint16_t valid[NUM_SENSOR_TYPES];        // bit n is set if well n was read.
+	uint32_t timestamp;                      // when the sweep started. see Timebase_Now.
+} SensorSnapshot;
+
+/**
+ * @brief Reads the ADC of one sensor. The reading is not calibrated (see
+ *        calibration.h).
+ *
+ * @param out	Where to store the raw reading.
+ * @return		true on success. false on error.
+ */
+bool Sensors_Read(SensorType type, WellID well_id, uint16_t *out);
+
+/**
+ * @brief Reads every sensor, one multiplexer channel at a time, so the
+ *        multiplexer only switches once per channel.
+ *
+ * Quarantined sensors are skipped unless due for a re-probe (see
+ * sensor_health.h). Sensors that fail to read, or whose readings are
+ * implausible, are left out of the snapshot's valid bits. The health checks
+ * see the raw readings; the snapshot holds them calibrated.
+ *
+ * @return true if every sensor was read. false otherwise.
+ */
+bool Sensors_Sweep(SensorSnapshot *out);
+
+/**
+ * @brief Gets where the ADC of a sensor is wired.
+ */
+MuxADCLocation Sensors_Get_Location(SensorType type, WellID well_id);
+
+#endif /* HIGHLEVEL_INC_SENSORS_H_ */
@@ -0,0 +1,88 @@
+/*
+ * snapshot_codec.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Lossless compression of sensor snapshots for the flash log and
+ *           downlink.
+ *
+ *  Each reading is stored as its difference from the previous reading of
+ *  the same sensor, zig-zag mapped to an unsigned value and Rice coded. The
+ *  Rice parameter adapts to the recent size of the differences of each
+ *  sensor type, so slowly changing readings cost a few bits each. The sweep
+ *  time is stored the same way, as the change in the interval between sweeps.
+ *
+ *  A stream starts with a key record, which stores everything in full. Every
+ *  record after it depends on the ones before, back to the key record.
+ *
+ *  Record layout, fields packed LSB first:
+ *  	key record:	1, timestamp (32), valid masks (16 each),
+ *  				then the reading of every valid sensor (16 each).
+ *  	delta record:	0, interval change (Rice), 1 if the valid masks are
+ *  				unchanged or 0 followed by the masks (16 each), then the
+ *  				difference of every valid sensor (Rice).
+ *  A Rice code is q ones, a zero, then the k low bits of the value, where
+ *  q = value >> k. If q would reach CODEC_ESCAPE, it is instead CODEC_ESCAPE
+ *  ones followed by the value in full (32).
+ */
+
+#ifndef HIGHLEVEL_INC_SNAPSHOT_CODEC_H_
+#define HIGHLEVEL_INC_SNAPSHOT_CODEC_H_
+
+#include "sensors.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CODEC_ESCAPE 24
+
+// Rice parameters adapt separately for each sensor type and the sweep time.
+#define CODEC_NUM_CONTEXTS (NUM_SENSOR_TYPES + 1)
+
+// a buffer written or read one bit at a time.
+typedef struct
+{
+	uint8_t *data;
+	uint32_t size;     // in bytes.
+	uint32_t position; // in bits.
+} BitStream;
+
+// what one end of a stream remembers of the records before.
+typedef struct
+{
+	bool started;                           // false until the key record.
+	uint16_t previous[NUM_SENSOR_TYPES][16]; // last reading of each sensor.
+	uint16_t valid[NUM_SENSOR_TYPES];
+	uint32_t timestamp;
+	uint32_t interval;                      // between the last two sweeps.
+	uint32_t magnitude[CODEC_NUM_CONTEXTS]; // sum of recent coded values.
+	uint32_t count[CODEC_NUM_CONTEXTS];     // number of recent coded values.
+} SnapshotCodec;
+
+/**
+ * @brief Starts a new stream. The next record is a key record.
+ */
+void Snapshot_Codec_Reset(SnapshotCodec *codec);
+
+/**
+ * @brief Appends a snapshot to a stream.
+ *
+ * @param codec		The encoder's state.
+ * @param snapshot	The snapshot to append.
+ * @param stream	Where to append it.
+ * @return			true on success. false if it doesn't fit, in which case
+ * 					neither the codec nor the stream are changed.
+ */
+bool Snapshot_Codec_Encode(SnapshotCodec *codec, const SensorSnapshot *snapshot, BitStream *stream);
+
+/**
+ * @brief Reads the next snapshot from a stream.
+ *
+ * @param codec		The decoder's state.
+ * @param stream	Where to read it from.
+ * @param snapshot	Where to store it.
+ * @return			true on success. false if the stream ends first.
+ */
+bool Snapshot_Codec_Decode(SnapshotCodec *codec, BitStream *stream, SensorSnapshot *snapshot);
+
+#endif /* HIGHLEVEL_INC_SNAPSHOT_CODEC_H_ */
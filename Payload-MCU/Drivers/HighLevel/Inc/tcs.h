@@ -5,9 +5,73 @@
  *      Author: Logan Furedi
  *
  *  Purpose: Thermal Control System.
+ *
+ *  Wells share the board, so heating one warms its neighbours. Rather than
+ *  switching each heater on its own error, the TCS predicts every well with
+ *  a linear model of the board (see tcs_model.h) and, once per model period,
+ *  picks the duty of each heater that brings the regulated wells to their
+ *  setpoints at the end of a horizon, counting the heat each one gets from
+ *  the others. The heaters are then time-proportioned within the period,
+ *  their on-times staggered so no more are on at once than the total duty
+ *  needs. Heat the model keeps missing is learnt as an offset on each
+ *  heater, so a model that is somewhat off still settles on the setpoint.
+ *
+ *  Wells that can't be read are predicted from the model. Once that has gone
+ *  on too long, their heaters are switched off.
  */
 
 #ifndef HIGHLEVEL_INC_TCS_H_
 #define HIGHLEVEL_INC_TCS_H_
 
+#include "well_id.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// setpoint of a well with no temperature regulation.
+#define TCS_SETPOINT_OFF INT16_MIN
+
+/**
+ * @brief Sets the target temperature of a well, and saves it to the config
+ *        store.
+ *
+ * @param well_id	The well to regulate.
+ * @param setpoint	Target temperature in hundredths of a degree celsius, or
+ * 					TCS_SETPOINT_OFF to stop regulating the well.
+ * @return			true on success. false on error.
+ */
+bool TCS_Set_Setpoint(WellID well_id, int16_t setpoint);
+
+/**
+ * @brief Gets the target temperature of a well.
+ *
+ * @return Target temperature in hundredths of a degree celsius, or
+ * 		   TCS_SETPOINT_OFF if the well is not regulated.
+ */
+int16_t TCS_Get_Setpoint(WellID well_id);
+
+/**
+ * @brief Loads the saved setpoints, and precomputes the predictions over the
+ *        horizon from the model.
+ */
+void TCS_Init();
+
+/**
+ * @brief Runs a control step when one is due, and switches the heaters on
+ *        and off within the period. Called from the main loop, once the
+ *        expanders are up.
+ *
+ * Heaters of wells that are not regulated are left alone.
+ *
+ * @param may_sample	Whether the sensors may be read now. If not, the step
+ * 						predicts every well instead.
+ */
+void TCS_Update(bool may_sample);
+
+/**
+ * @brief Prints the duty of each regulated well and how long control steps
+ *        take, in CPU cycles.
+ */
+void TCS_Print_Stats();
+
 #endif /* HIGHLEVEL_INC_TCS_H_ */
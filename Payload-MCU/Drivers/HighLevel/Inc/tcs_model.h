@@ -0,0 +1,42 @@
+/*
+ * tcs_model.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Thermal model of the wells, used by the TCS to predict them.
+ *
+ *  Generated by tools/tcs_sysid.py from nominal parameters. Regenerate rather than edit.
+ *
+ *  x[k+1] = A x[k] + B u[k], where x is each well's temperature above
+ *  ambient in hundredths of a degree, and u each heater's duty, 0 to 1.
+ */
+
+#ifndef HIGHLEVEL_INC_TCS_MODEL_H_
+#define HIGHLEVEL_INC_TCS_MODEL_H_
+
+#define TCS_MODEL_PERIOD 1000 // in ms. the time step of the model.
+
+// Q24. row i is how each well's excess temperature carries over to well i.
+#define TCS_MODEL_A { \
+		{  16736671,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,  16736671,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,  16736671,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,  16736671,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,  16736671,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,  16736671,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,  16736671,       839,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,  16736671,       839,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,  16736671,       839,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,       839,  16736671,       839,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,  16736671,       839,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,  16736671,       839,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,  16736671,       839,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,  16736671,       839,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,  16736671,       839 }, \
+		{       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,       839,  16736671 }, \
+}
+
+// rise of each well per step at full duty, in 1/256ths of a hundredth of a degree.
+#define TCS_MODEL_B { 853, 853, 853, 853, 853, 853, 853, 853, 853, 853, 853, 853, 853, 853, 853, 853 }
+
+#endif /* HIGHLEVEL_INC_TCS_MODEL_H_ */
@@ -31,6 +31,15 @@ bool Thermistors_Get_Temp(WellID well_id, uint16_t *out);
  */
 bool Thermistors_Get_Temp_Celsius(WellID well_id, double *out);
 
+/**
+ * @brief Converts a raw reading to a temperature, along the nominal curve of
+ *        the thermistors.
+ *
+ * @param raw	Raw reading from an MCP3221 ADC unit.
+ * @return		Temperature in hundredths of a degree celsius.
+ */
+int16_t Thermistors_To_Centidegrees(uint16_t raw);
+
 void Thermistors_Print_Debug_Info();
 
 #endif /* HIGHLEVEL_INC_THERMISTORS_H_ */
@@ -0,0 +1,194 @@
+/*
+ * burst.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Samples one sensor back-to-back at the full I2C rate, then streams
+ *           the samples to CDH.
+ */
+
+#include "burst.h"
+#include "sensors.h"
+#include "calibration.h"
+#include "bulk.h"
+#include "error_log.h"
+#include "tca9548.h"
+#include "timebase.h"
+#include "pp.h"
+#include "placement.h"
+#include "tuk/tuk.h"
+#include "payload_cmds.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+static const uint32_t CAPTURE_SLICE = 2000;   // in us. longest to capture for per update.
+static const uint32_t ANNOUNCE_LIMIT = 100000; // in us. longest to retry the info frame for.
+
+CASSERT(sizeof(BurstSample) == 4, burst)
+CASSERT(BURST_MAX_SAMPLES * sizeof(BurstSample) <= BULK_MAX_SIZE, burst)
+
+static BurstSample s_samples[BURST_MAX_SAMPLES] RAM2_BSS(burst);
+
+static BurstState s_state = BURST_IDLE;
+static SensorType s_type;
+static WellID s_well_id;
+static uint16_t s_count;        // samples to capture.
+static uint16_t s_captured;     // samples captured so far.
+static uint32_t s_start_time;   // Timebase_Now of the first sample, on CDH's clock.
+static uint32_t s_first_time;   // local time the capture started.
+static uint32_t s_last_time;    // local time of the latest sample.
+
+static void capture_slice();
+static void announce();
+static bool send_info();
+
+#define PRINT_SUBJECT "Burst"
+
+bool Burst_Start(SensorType type, WellID well_id, uint16_t count)
+{
+	if (type >= NUM_SENSOR_TYPES || well_id < WELL_0 || well_id > WELL_15)
+	{
+		PRINT_ERROR("invalid sensor: type %d, well %d.", type, well_id);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
+		return false;
+	}
+
+	if (count == 0 || count > BURST_MAX_SAMPLES)
+	{
+		PRINT_ERROR("invalid sample count: %u (max %u).", count, BURST_MAX_SAMPLES);
+		return false;
+	}
+
+	// the samples are about to be overwritten.
+	Bulk_Cancel(BULK_SOURCE_BURST);
+
+	s_type = type;
+	s_well_id = well_id;
+	s_count = count;
+	s_captured = 0;
+	s_state = BURST_CAPTURING;
+
+	// switch the multiplexer once, up front. reads keep it on this channel.
+	MuxADCLocation location = Sensors_Get_Location(type, well_id);
+	TCA9548_Select(location.channel);
+
+	PRINT_INFO("capturing %u samples of well %d.", count, well_id);
+
+	return true;
+}
+
+void Burst_Update()
+{
+	switch (s_state)
+	{
+	case BURST_CAPTURING:
+		capture_slice();
+		break;
+	case BURST_ANNOUNCING:
+		announce();
+		break;
+	case BURST_STREAMING:
+		if (Bulk_Get_Source() != BULK_SOURCE_BURST)
+			s_state = BURST_IDLE; // sent, or replaced by another transfer.
+		break;
+	default:
+		break;
+	}
+}
+
+BurstState Burst_Get_State()
+{
+	return s_state;
+}
+
+/**
+ * @brief Samples back-to-back until the capture is complete or the slice is
+ *        used up.
+ */
+static void capture_slice()
+{
+	// intervals are measured on the local clock, which a sync from CDH can't
+	// step in the middle of a capture.
+	uint32_t slice_start = Timebase_Local_Micros();
+
+	if (s_captured == 0)
+	{
+		s_start_time = Timebase_Now();
+		s_first_time = slice_start;
+		s_last_time = slice_start;
+	}
+
+	while (s_captured < s_count && Timebase_Local_Micros() - slice_start < CAPTURE_SLICE)
+	{
+		BurstSample *sample = &s_samples[s_captured];
+
+		if (!Sensors_Read(s_type, s_well_id, &sample->reading))
+			sample->reading = BURST_INVALID_READING;
+
+		uint32_t now = Timebase_Local_Micros();
+		uint32_t interval = now - s_last_time;
+		sample->interval = interval > UINT16_MAX ? UINT16_MAX : interval;
+		s_last_time = now;
+
+		s_captured++;
+	}
+
+	if (s_captured < s_count)
+		return;
+
+	uint32_t duration = s_last_time - s_first_time;
+	PRINT_INFO("captured %u samples in %lu us.", s_count, duration);
+
+	// calibrated like telemetry, once the capture is done, so reads stay
+	// back-to-back and every sample gets the same calibration.
+	for (uint32_t i = 0; i < s_count; i++)
+	{
+		if (s_samples[i].reading != BURST_INVALID_READING)
+			s_samples[i].reading = Calibration_Apply_One(s_type, s_well_id, s_samples[i].reading);
+	}
+
+	s_state = BURST_ANNOUNCING;
+	announce();
+}
+
+/**
+ * @brief Sends the info frame, then starts streaming the samples. CDH can't
+ *        make sense of the samples without it, so the send is retried until
+ *        it goes through or ANNOUNCE_LIMIT passes, when the capture is dropped.
+ */
+static void announce()
+{
+	if (!send_info())
+	{
+		if (Timebase_Local_Micros() - s_last_time < ANNOUNCE_LIMIT)
+			return;
+
+		PRINT_ERROR("failed to send capture info. Dropping the capture.");
+		Error_Log_Put(ERROR_CAN_TRANSMIT, CMD_CDH_PROCESS_BURST_INFO);
+		s_state = BURST_IDLE;
+		return;
+	}
+
+	if (Bulk_Start(BULK_SOURCE_BURST, s_samples, s_count * sizeof(BurstSample)))
+		s_state = BURST_STREAMING;
+	else
+		s_state = BURST_IDLE;
+}
+
+/**
+ * @brief Tells CDH which sensor was captured, how many samples are in the
+ *        transfer that follows, and when the first was taken.
+ *
+ * @return true on success. false on error.
+ */
+static bool send_info()
+{
+	CANMessage msg;
+	msg.cmd = CMD_CDH_PROCESS_BURST_INFO;
+	SET_ARG(msg, 0, uint8_t, (uint8_t)((s_type << 4) | s_well_id));
+	SET_ARG(msg, 1, uint16_t, s_count);
+	SET_ARG(msg, 3, uint32_t, s_start_time);
+
+	return CANWrapper_Transmit(NODE_CDH, &msg) == CAN_WRAPPER_HAL_OK;
+}
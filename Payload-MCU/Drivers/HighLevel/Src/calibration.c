@@ -0,0 +1,345 @@
+/*
+ * calibration.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Per-sensor calibration of the raw ADC readings, kept in flash.
+ */
+
+#include "calibration.h"
+#include "sensor_math.h"
+#include "config_store.h"
+#include "pp.h"
+#include "error_log.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "tuk/tuk.h"
+#include "payload_cmds.h"
+
+#define NUM_WELLS (WELL_15 + 1)
+
+static const uint32_t SAVE_DELAY = 5000; // in ms. wait for uploads to settle.
+
+// kept as arrays of each field, so a type's gains and offsets can be
+// applied in one pass.
+typedef struct
+{
+	int16_t gains[NUM_SENSOR_TYPES][NUM_WELLS];   // Q14.
+	int16_t offsets[NUM_SENSOR_TYPES][NUM_WELLS]; // in ADC counts.
+	uint8_t num_points[NUM_SENSOR_TYPES][NUM_WELLS]; // points in use. 0 for no curve.
+	uint8_t upload_counts[NUM_SENSOR_TYPES][NUM_WELLS]; // points in the curve being uploaded.
+	uint8_t received[NUM_SENSOR_TYPES][NUM_WELLS]; // bit n is set once point n of that upload arrived.
+	CalibrationPoint points[NUM_SENSOR_TYPES][NUM_WELLS][CALIBRATION_MAX_POINTS];
+} CalibrationTable;
+
+// layout of a sensor's calibration in the config store.
+typedef struct
+{
+	int16_t gain;
+	int16_t offset;
+	uint8_t num_points;
+	uint8_t reserved[3];
+	CalibrationPoint points[CALIBRATION_MAX_POINTS]; // kept even while incomplete.
+} CalibrationRecord;
+
+CASSERT(sizeof(CalibrationRecord) <= CONFIG_MAX_VALUE_SIZE, calibration_record)
+CASSERT(NUM_SENSOR_TYPES * NUM_WELLS == NUM_CONFIG_KEYS - CONFIG_KEY_CALIBRATION, calibration_keys)
+
+static CalibrationTable s_table;
+static uint16_t s_curves[NUM_SENSOR_TYPES]; // bit n is set if well n has a curve.
+
+static uint16_t s_unsaved[NUM_SENSOR_TYPES]; // bit n is set if well n changed since the last save.
+static uint32_t s_last_change;  // HAL tick of the last change.
+
+static void reset_table();
+static void load(SensorType type, WellID well_id);
+static void update_curves();
+static uint16_t apply_curve(SensorType type, WellID well_id, uint16_t reading);
+static bool is_unsaved();
+static bool save();
+
+#define PRINT_SUBJECT "Calibration"
+
+void Calibration_Init()
+{
+	reset_table();
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		for (int i = 0; i < NUM_WELLS; i++)
+			load(type, i);
+	}
+
+	update_curves();
+}
+
+void Calibration_Update()
+{
+	if (is_unsaved() && HAL_GetTick() - s_last_change >= SAVE_DELAY)
+	{
+		save();
+		s_last_change = HAL_GetTick(); // don't retry failed saves in a tight loop.
+	}
+}
+
+bool Calibration_Set(SensorType type, WellID well_id, int16_t gain, int16_t offset)
+{
+	if (well_id < WELL_0 || well_id > WELL_15)
+	{
+		PRINT_ERROR("invalid well id: %d.", well_id);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
+		return false;
+	}
+
+	if (type >= NUM_SENSOR_TYPES || gain < 0)
+	{
+		PRINT_ERROR("invalid calibration: type %d, gain %d.", type, gain);
+		Error_Log_Put(ERROR_INVALID_ARGUMENT, CMD_PLD_SET_CALIBRATION);
+		return false;
+	}
+
+	s_table.gains[type][well_id] = gain;
+	s_table.offsets[type][well_id] = offset;
+	s_table.num_points[type][well_id] = 0;
+	s_table.received[type][well_id] = 0;
+	update_curves();
+
+	s_unsaved[type] |= 1 << well_id;
+	s_last_change = HAL_GetTick();
+
+	return true;
+}
+
+bool Calibration_Set_Point(SensorType type, WellID well_id, uint8_t index, uint8_t count,
+		const CalibrationPoint *point)
+{
+	if (well_id < WELL_0 || well_id > WELL_15)
+	{
+		PRINT_ERROR("invalid well id: %d.", well_id);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
+		return false;
+	}
+
+	if (type >= NUM_SENSOR_TYPES || count < 2 || count > CALIBRATION_MAX_POINTS || index >= count)
+	{
+		PRINT_ERROR("invalid calibration point: type %d, point %u of %u.", type, index, count);
+		Error_Log_Put(ERROR_INVALID_ARGUMENT, CMD_PLD_SET_CALIBRATION_POINT);
+		return false;
+	}
+
+	// the points left from the last curve mustn't complete this one.
+	if (index == 0 || count != s_table.upload_counts[type][well_id])
+	{
+		s_table.upload_counts[type][well_id] = count;
+		s_table.received[type][well_id] = 0;
+	}
+
+	CalibrationPoint *points = s_table.points[type][well_id];
+	points[index] = *point;
+	s_table.received[type][well_id] |= 1 << index;
+
+	// the curve is off while its points are still arriving.
+	bool complete = s_table.received[type][well_id] == (1 << count) - 1;
+	for (int i = 1; i < count; i++)
+	{
+		if (points[i].in <= points[i - 1].in)
+			complete = false;
+	}
+
+	s_table.num_points[type][well_id] = complete ? count : 0;
+	update_curves();
+
+	s_unsaved[type] |= 1 << well_id;
+	s_last_change = HAL_GetTick();
+
+	return true;
+}
+
+void Calibration_Apply(SensorSnapshot *snapshot)
+{
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		uint16_t *readings = snapshot->readings[type];
+
+		// invalid readings are calibrated too, but stay invalid.
+		Sensor_Math_Calibrate(readings, readings, s_table.gains[type], s_table.offsets[type]);
+
+		uint32_t pending = s_curves[type] & snapshot->valid[type];
+		while (pending != 0)
+		{
+			uint32_t well = __builtin_ctz(pending);
+			pending &= pending - 1;
+
+			readings[well] = apply_curve(type, well, readings[well]);
+		}
+	}
+}
+
+uint16_t Calibration_Apply_One(SensorType type, WellID well_id, uint16_t reading)
+{
+	if (type >= NUM_SENSOR_TYPES || well_id < WELL_0 || well_id > WELL_15)
+		return reading;
+
+	// the same as Sensor_Math_Calibrate, for one reading.
+	int32_t value = (((int32_t)reading * s_table.gains[type][well_id] + SENSOR_MATH_GAIN_ONE / 2)
+			/ SENSOR_MATH_GAIN_ONE) + s_table.offsets[type][well_id];
+	value = value < 0 ? 0 : value > SENSOR_MATH_MAX_READING ? SENSOR_MATH_MAX_READING : value;
+
+	if (s_curves[type] & (1 << well_id))
+		value = apply_curve(type, well_id, value);
+
+	return value;
+}
+
+void Calibration_Print()
+{
+	int calibrated = 0;
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			int16_t gain = s_table.gains[type][i];
+			int16_t offset = s_table.offsets[type][i];
+			uint8_t num_points = s_table.num_points[type][i];
+
+			if (gain == SENSOR_MATH_GAIN_ONE && offset == 0 && num_points == 0)
+				continue;
+
+			calibrated++;
+			PRINT_INFO("  type %d, well %2d: gain %d/%d, offset %d, %u curve points",
+					type, i, gain, SENSOR_MATH_GAIN_ONE, offset, num_points);
+		}
+	}
+
+	PRINT_INFO("%d sensors calibrated%s.", calibrated, is_unsaved() ? ", unsaved changes" : "");
+}
+
+/**
+ * @brief Sets every sensor to a gain of 1, no offset and no curve.
+ */
+static void reset_table()
+{
+	memset(&s_table, 0, sizeof(s_table));
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		for (int i = 0; i < NUM_WELLS; i++)
+			s_table.gains[type][i] = SENSOR_MATH_GAIN_ONE;
+	}
+}
+
+/**
+ * @brief Loads a sensor's saved calibration, if it has one.
+ */
+static void load(SensorType type, WellID well_id)
+{
+	CalibrationRecord record;
+
+	if (Config_Get(CONFIG_KEY_CALIBRATION + type * NUM_WELLS + well_id, &record, sizeof(record)) != sizeof(record))
+		return;
+
+	s_table.gains[type][well_id] = record.gain;
+	s_table.offsets[type][well_id] = record.offset;
+	s_table.num_points[type][well_id] = record.num_points <= CALIBRATION_MAX_POINTS ? record.num_points : 0;
+	memcpy(s_table.points[type][well_id], record.points, sizeof(record.points));
+
+	// a saved curve can have single points set again. one that was still
+	// being uploaded has to start over.
+	s_table.upload_counts[type][well_id] = s_table.num_points[type][well_id];
+	s_table.received[type][well_id] = (1 << s_table.num_points[type][well_id]) - 1;
+}
+
+static void update_curves()
+{
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		s_curves[type] = 0;
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			if (s_table.num_points[type][i] >= 2)
+				s_curves[type] |= 1 << i;
+		}
+	}
+}
+
+/**
+ * @brief Interpolates a reading on a sensor's curve. Readings beyond either
+ *        end follow the segment at that end.
+ */
+static uint16_t apply_curve(SensorType type, WellID well_id, uint16_t reading)
+{
+	const CalibrationPoint *points = s_table.points[type][well_id];
+	uint8_t num_points = s_table.num_points[type][well_id];
+
+	int segment = 1;
+	while (segment < num_points - 1 && reading >= points[segment].in)
+		segment++;
+
+	const CalibrationPoint *low = &points[segment - 1];
+	const CalibrationPoint *high = &points[segment];
+
+	int32_t value = low->out + ((int32_t)reading - low->in) * ((int32_t)high->out - low->out)
+			/ ((int32_t)high->in - low->in);
+
+	return value < 0 ? 0 : value > SENSOR_MATH_MAX_READING ? SENSOR_MATH_MAX_READING : value;
+}
+
+static bool is_unsaved()
+{
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		if (s_unsaved[type] != 0)
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Writes the changed sensors to the config store. Those that fail stay
+ *        unsaved, to be retried.
+ *
+ * @return true on success. false on error.
+ */
+static bool save()
+{
+	int saved = 0;
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		uint32_t pending = s_unsaved[type];
+		while (pending != 0)
+		{
+			uint32_t well = __builtin_ctz(pending);
+			pending &= pending - 1;
+
+			CalibrationRecord record = {
+					.gain = s_table.gains[type][well],
+					.offset = s_table.offsets[type][well],
+					.num_points = s_table.num_points[type][well]
+			};
+			memcpy(record.points, s_table.points[type][well], sizeof(record.points));
+
+			if (Config_Set(CONFIG_KEY_CALIBRATION + type * NUM_WELLS + well, &record, sizeof(record)))
+			{
+				s_unsaved[type] &= ~(1 << well);
+				saved++;
+			}
+		}
+	}
+
+	if (is_unsaved())
+	{
+		PRINT_ERROR("failed to save calibration to flash.");
+		return false;
+	}
+
+	PRINT_INFO("saved %d sensors.", saved);
+
+	return true;
+}
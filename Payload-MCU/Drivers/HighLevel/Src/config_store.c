@@ -0,0 +1,340 @@
+/*
+ * config_store.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Persistent key/value store for the payload's configuration.
+ */
+
+#include "config_store.h"
+#include "flash.h"
+#include "crc.h"
+#include "pp.h"
+#include "error_log.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "tuk/debug/print.h"
+
+#define NUM_PAGES 2
+#define ALIGN(size) (((size) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1))
+
+static const uint32_t PAGE_MAGIC = 0x43464753; // "CFGS"
+
+static const uint32_t PAGES[NUM_PAGES] = { FLASH_CONFIG_A_ADDR, FLASH_CONFIG_B_ADDR };
+
+// the first double word of a page. written last, once the page is complete.
+typedef struct
+{
+	uint32_t magic;
+	uint32_t sequence; // higher on the newer page.
+} PageHeader;
+
+// precedes each value, which is padded to a whole double word.
+typedef struct
+{
+	uint32_t crc;  // covers the key, size and value.
+	uint16_t key;
+	uint16_t size; // of the value.
+} RecordHeader;
+
+CASSERT(sizeof(PageHeader) == sizeof(uint64_t), config_page_header)
+CASSERT(sizeof(RecordHeader) == sizeof(uint64_t), config_record_header)
+CASSERT(NUM_CONFIG_KEYS <= UINT16_MAX, config_keys)
+
+static int s_page = -1;         // index of the page in use. -1 if there is none.
+static uint32_t s_sequence;     // of the page in use.
+static uint32_t s_end;          // offset of the first free double word of the page.
+static uint16_t s_index[NUM_CONFIG_KEYS]; // offset of each key's newest record. 0 if unset.
+static uint32_t s_compactions = 0;
+
+static bool is_page_valid(int page);
+static bool is_record_erased(const RecordHeader *record);
+static bool is_record_valid(const RecordHeader *record);
+static uint32_t get_footprint(const RecordHeader *record);
+static void build_index();
+static bool start_page(int page, uint32_t sequence);
+static bool compact(ConfigKey key, const void *data, size_t size);
+static bool write_record(uint32_t address, ConfigKey key, const void *data, size_t size);
+
+#define PRINT_SUBJECT "Config"
+
+bool Config_Init()
+{
+	s_page = -1;
+	for (int page = 0; page < NUM_PAGES; page++)
+	{
+		if (!is_page_valid(page))
+			continue;
+
+		const PageHeader *header = (const PageHeader *)PAGES[page];
+		if (s_page < 0 || (int32_t)(header->sequence - s_sequence) > 0)
+		{
+			s_page = page;
+			s_sequence = header->sequence;
+		}
+	}
+
+	if (s_page < 0)
+	{
+		PRINT_INFO("no configuration found. Starting an empty store.");
+		if (!start_page(0, 1))
+			return false;
+	}
+
+	build_index();
+
+	return true;
+}
+
+size_t Config_Get(ConfigKey key, void *out, size_t size)
+{
+	if (s_page < 0 || key >= NUM_CONFIG_KEYS || s_index[key] == 0)
+		return 0;
+
+	const RecordHeader *record = (const RecordHeader *)(PAGES[s_page] + s_index[key]);
+	memcpy(out, record + 1, record->size < size ? record->size : size);
+
+	return record->size;
+}
+
+bool Config_Set(ConfigKey key, const void *data, size_t size)
+{
+	if (key >= NUM_CONFIG_KEYS || size > CONFIG_MAX_VALUE_SIZE)
+	{
+		PRINT_ERROR("invalid config value: key %d, %u bytes.", key, size);
+		return false;
+	}
+
+	if (s_page < 0)
+		return false;
+
+	// skip writes that wouldn't change anything.
+	if (s_index[key] != 0)
+	{
+		const RecordHeader *record = (const RecordHeader *)(PAGES[s_page] + s_index[key]);
+		if (record->size == size && memcmp(record + 1, data, size) == 0)
+			return true;
+	}
+
+	uint32_t footprint = sizeof(RecordHeader) + ALIGN(size);
+	if (s_end + footprint > FLASH_PAGE_SIZE)
+		return compact(key, data, size);
+
+	uint32_t offset = s_end;
+	s_end += footprint; // skip the space even on failure, as it may be half written.
+
+	if (!write_record(PAGES[s_page] + offset, key, data, size))
+		return false;
+
+	s_index[key] = offset;
+
+	return true;
+}
+
+void Config_Print_Stats()
+{
+	if (s_page < 0)
+	{
+		PRINT_INFO("no page in use.");
+		return;
+	}
+
+	uint32_t live = 0;
+	for (int key = 0; key < NUM_CONFIG_KEYS; key++)
+	{
+		if (s_index[key] != 0)
+			live += get_footprint((const RecordHeader *)(PAGES[s_page] + s_index[key]));
+	}
+
+	PRINT_INFO("page %d (sequence %lu): %lu of %u bytes used, %lu live. %lu compactions since boot.",
+			s_page, s_sequence, s_end, FLASH_PAGE_SIZE, live, s_compactions);
+}
+
+/**
+ * @brief Checks that a page has been completely written.
+ */
+static bool is_page_valid(int page)
+{
+	const PageHeader *header = (const PageHeader *)PAGES[page];
+	return header->magic == PAGE_MAGIC;
+}
+
+static bool is_record_erased(const RecordHeader *record)
+{
+	return record->crc == UINT32_MAX && record->key == UINT16_MAX && record->size == UINT16_MAX;
+}
+
+static bool is_record_valid(const RecordHeader *record)
+{
+	return record->key < NUM_CONFIG_KEYS
+		&& record->crc == CRC_Compute(&record->key, sizeof(RecordHeader) - offsetof(RecordHeader, key) + record->size);
+}
+
+static uint32_t get_footprint(const RecordHeader *record)
+{
+	return sizeof(RecordHeader) + ALIGN(record->size);
+}
+
+/**
+ * @brief Finds the newest valid record of each key in the page in use, and
+ *        where the free space starts.
+ */
+static void build_index()
+{
+	memset(s_index, 0, sizeof(s_index));
+
+	const uint32_t page = PAGES[s_page];
+	uint32_t offset = sizeof(PageHeader);
+
+	while (offset + sizeof(RecordHeader) <= FLASH_PAGE_SIZE)
+	{
+		const RecordHeader *record = (const RecordHeader *)(page + offset);
+
+		if (is_record_erased(record))
+			break;
+
+		// a damaged size can't be stepped over. the rest of the page is lost,
+		// and the next write compacts.
+		if (record->size > CONFIG_MAX_VALUE_SIZE || offset + get_footprint(record) > FLASH_PAGE_SIZE)
+		{
+			PRINT_ERROR("damaged record at offset %lu.", offset);
+			offset = FLASH_PAGE_SIZE;
+			break;
+		}
+
+		if (is_record_valid(record))
+			s_index[record->key] = offset;
+
+		offset += get_footprint(record);
+	}
+
+	s_end = offset;
+}
+
+/**
+ * @brief Erases a page and makes it the one in use, empty.
+ */
+static bool start_page(int page, uint32_t sequence)
+{
+	PageHeader header = {
+			.magic = PAGE_MAGIC,
+			.sequence = sequence
+	};
+
+	if (!Flash_Erase_Page(PAGES[page]) || !Flash_Program(PAGES[page], &header, sizeof(header)))
+	{
+		PRINT_ERROR("failed to start page %d.", page);
+		Error_Log_Put(ERROR_FLASH_WRITE, 0);
+		s_page = -1;
+		return false;
+	}
+
+	s_page = page;
+	s_sequence = sequence;
+
+	return true;
+}
+
+/**
+ * @brief Copies the newest record of every key to the other page, with the
+ *        given value in place of its key's, then switches to that page.
+ *
+ * @return true on success. false on error, in which case the page in use is
+ *         unchanged.
+ */
+static bool compact(ConfigKey key, const void *data, size_t size)
+{
+	const int target = 1 - s_page;
+	const uint32_t source = PAGES[s_page];
+	const uint32_t destination = PAGES[target];
+
+	if (!Flash_Erase_Page(destination))
+	{
+		Error_Log_Put(ERROR_FLASH_WRITE, 0);
+		return false;
+	}
+
+	uint16_t index[NUM_CONFIG_KEYS] = {0};
+	uint32_t offset = sizeof(PageHeader);
+	bool success = true;
+
+	for (int k = 0; k < NUM_CONFIG_KEYS && success; k++)
+	{
+		uint32_t footprint;
+
+		if (k == (int)key)
+		{
+			footprint = sizeof(RecordHeader) + ALIGN(size);
+			success = offset + footprint <= FLASH_PAGE_SIZE
+				&& write_record(destination + offset, key, data, size);
+		}
+		else if (s_index[k] != 0)
+		{
+			const RecordHeader *record = (const RecordHeader *)(source + s_index[k]);
+			footprint = get_footprint(record);
+			success = offset + footprint <= FLASH_PAGE_SIZE
+				&& Flash_Program(destination + offset, record, footprint);
+		}
+		else
+		{
+			continue;
+		}
+
+		index[k] = offset;
+		offset += footprint;
+	}
+
+	// the header makes the new page the one in use.
+	PageHeader header = {
+			.magic = PAGE_MAGIC,
+			.sequence = s_sequence + 1
+	};
+
+	if (!success || !Flash_Program(destination, &header, sizeof(header)))
+	{
+		PRINT_ERROR("failed to compact into page %d.", target);
+		Error_Log_Put(ERROR_FLASH_WRITE, 0);
+		return false;
+	}
+
+	s_page = target;
+	s_sequence = header.sequence;
+	s_end = offset;
+	memcpy(s_index, index, sizeof(s_index));
+	s_compactions++;
+
+	PRINT_INFO("compacted into page %d: %lu bytes live.", target, offset);
+
+	return true;
+}
+
+/**
+ * @brief Programs a record, checksum included, into erased flash.
+ */
+static bool write_record(uint32_t address, ConfigKey key, const void *data, size_t size)
+{
+	struct
+	{
+		RecordHeader header;
+		uint8_t value[ALIGN(CONFIG_MAX_VALUE_SIZE)];
+	} record;
+
+	memset(&record, 0xFF, sizeof(record));
+	record.header.key = key;
+	record.header.size = size;
+	memcpy(record.value, data, size);
+	record.header.crc = CRC_Compute(&record.header.key,
+			sizeof(RecordHeader) - offsetof(RecordHeader, key) + size);
+
+	if (!Flash_Program(address, &record, sizeof(RecordHeader) + ALIGN(size)))
+	{
+		Error_Log_Put(ERROR_FLASH_WRITE, key);
+		return false;
+	}
+
+	return true;
+}
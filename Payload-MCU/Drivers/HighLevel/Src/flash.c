@@ -6,90 +6,88 @@
  */
 
 #include "main.h"
-#include "power.h"
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+#include "flash.h"
+#include "tuk/debug/print.h"
 
-#define BLOCK_COUNTER_ADDRESS 0x08000000
-#define BLOCK_START_ADDRESS   0x08000001
-#define BLOCK_END_ADDRESS     0x08100000
-#define BLOCK_SIZE 32
+#define PRINT_SUBJECT "Flash"
 
-size_t current_block = 0;
-uint8_t block_buffer[BLOCK_SIZE];
+static bool is_reserved(uint32_t address, size_t size);
 
-// output ports: 2 bytes
-// temperatures: 16 bytes
-// active states: 16 bytes
-
-// Boundaries of the available flash memory
-#define FLASH_BOUNDARY_MIN_ADDR 		0x08000000
-#define FLASH_BOUNDARY_MAX_ADDR 		0x08080000
-
-#define FLASH_WELL_TEMP_STRUCT_ADDR  	0x08040000
-#define FLASH_LED_STATUS_STRUCT_ADDR	0x08040100
-
-typedef struct WELL_TEMP_STRUCT {
-	/*
-	 * Array of 16 ints with temperature goal in celsius for each well.
-	 * -1 means that well is OFF and no temperature regulation is happening.
-	 * */
-	int8_t temperatures[16];
-
-} Flash_Well_Temperatures;
-
-typedef struct LED_STATUS_STRUCT {
-	/*
-	 * Array of 16 uints. 1 is LED on, 0 is LED off.
-	 * These are separate rather than 1 uint16 so they can be invidiually addressed.
-	 */
-	uint8_t leds[16];
-
-} Flash_LED_Status;
-
-/*
- * Takes the raw data from each port of a TCA9539 and writes it to flash
- */
-bool Flash_Write_LED_Status(int id, uint8_t d1p1, uint8_t d1p2, uint8_t d2p1, uint8_t d2p2) {
+bool Flash_Erase_Page(uint32_t address)
+{
+	if (!is_reserved(address, 1))
+	{
+		PRINT_ERROR("refusing to erase page outside of reserved region: 0x%08lX.", address);
+		return false;
+	}
 
-	Flash_LED_Status leds;
+	FLASH_EraseInitTypeDef erase = {
+			.TypeErase = FLASH_TYPEERASE_PAGES,
+			.Banks = FLASH_BANK_1,
+			.Page = (address - FLASH_BASE) / FLASH_PAGE_SIZE,
+			.NbPages = 1
+	};
+	uint32_t page_error;
 
 	HAL_FLASH_Unlock();
-
-//	HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, FLASH_LED_STATUS_STRUCT_ADDR + (id * sizeof(uint8_t)), (uint8_t)status);
-
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+	HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &page_error);
 	HAL_FLASH_Lock();
 
+	if (status != HAL_OK)
+	{
+		PRINT_ERROR("failed to erase page %lu. (HAL error code: %d)", erase.Page, status);
+		return false;
+	}
+
 	return true;
 }
 
-Power Flash_Read_LED_Status(int id) {
+bool Flash_Program(uint32_t address, const void *data, size_t data_size)
+{
+	if ((address % sizeof(uint64_t)) != 0 || !is_reserved(address, data_size))
+	{
+		PRINT_ERROR("invalid program destination: 0x%08lX (%u bytes).", address, data_size);
+		return false;
+	}
 
-	Power* addr;
-	addr = (Power*) (FLASH_LED_STATUS_STRUCT_ADDR + (id * sizeof(Power)));
+	const uint8_t *bytes = data;
+	HAL_StatusTypeDef status = HAL_OK;
 
-	return *addr;
-}
+	HAL_FLASH_Unlock();
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
 
-bool Flash_Write_Well_Temperature(int id, uint8_t temp) {
+	for (size_t offset = 0; offset < data_size && status == HAL_OK; offset += sizeof(uint64_t))
+	{
+		uint64_t double_word = UINT64_MAX; // erased state.
+		size_t chunk = data_size - offset;
+		if (chunk > sizeof(double_word))
+			chunk = sizeof(double_word);
+
+		memcpy(&double_word, &bytes[offset], chunk);
+		status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address + offset, double_word);
+	}
 
-	HAL_FLASH_Unlock();
-	HAL_FLASH_Program(FLASH_TYPEPROGRAM_FAST, FLASH_WELL_TEMP_STRUCT_ADDR + (id * sizeof(int8_t)), temp);
 	HAL_FLASH_Lock();
 
-	if (HAL_FLASH_GetError() != HAL_FLASH_ERROR_NONE) {
-	    // Handle error
+	if (status != HAL_OK)
+	{
+		PRINT_ERROR("failed to program 0x%08lX. (HAL error code: %d)", address, status);
+		return false;
 	}
 
 	return true;
 }
 
-int8_t Flash_Read_Well_Temperature(int id) {
-
-	uint8_t* addr;
-	addr = (uint8_t*) (FLASH_WELL_TEMP_STRUCT_ADDR + (id * sizeof(int8_t)));
-
-	return *addr;
-
+/**
+ * @brief Ensures a range lies entirely within the reserved flash region.
+ */
+static bool is_reserved(uint32_t address, size_t size)
+{
+	return address >= FLASH_RESERVED_START_ADDR
+		&& address + size <= FLASH_RESERVED_END_ADDR;
 }
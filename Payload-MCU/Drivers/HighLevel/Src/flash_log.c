@@ -0,0 +1,294 @@
+/*
+ * flash_log.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Keeps a compressed history of sensor snapshots in flash.
+ */
+
+#include "flash_log.h"
+#include "flash.h"
+#include "bulk.h"
+#include "snapshot_codec.h"
+#include "crc.h"
+#include "error_log.h"
+#include "profile.h"
+#include "pp.h"
+#include "placement.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "tuk/debug/print.h"
+
+static const uint32_t MAGICS[NUM_FLASH_LOG_TYPES] = {
+		0x474F4C53, // "SLOG"
+		0x544C4653, // "SFLT"
+};
+
+#define CHUNKS_PER_PAGE (FLASH_PAGE_SIZE / FLASH_LOG_CHUNK_SIZE)
+#define NUM_CHUNKS ((FLASH_LOG_END_ADDR - FLASH_LOG_START_ADDR) / FLASH_LOG_CHUNK_SIZE)
+#define NUM_PAGES (NUM_CHUNKS / CHUNKS_PER_PAGE)
+
+CASSERT(sizeof(FlashLogChunk) == FLASH_LOG_CHUNK_SIZE, flash_log)
+CASSERT(FLASH_PAGE_SIZE % FLASH_LOG_CHUNK_SIZE == 0, flash_log)
+CASSERT((FLASH_LOG_END_ADDR - FLASH_LOG_START_ADDR) % FLASH_PAGE_SIZE == 0, flash_log)
+
+static FlashLogChunk s_chunk RAM2_BSS(log); // being filled.
+static SnapshotCodec s_codec;
+static BitStream s_stream;
+
+static uint32_t s_next_slot;     // where s_chunk goes.
+static uint32_t s_next_sequence;
+static bool s_has_newest = false;
+static uint32_t s_newest_slot;   // last chunk written.
+static uint32_t s_sending_page = 0; // last page handed out for downlink.
+
+static uint32_t s_records = 0;        // snapshots logged since boot.
+static uint32_t s_compressed_bits = 0; // their compressed size.
+static uint32_t s_last_cycles = 0;    // to compress the last snapshot.
+static uint32_t s_worst_cycles = 0;
+static uint32_t s_dropped = 0;        // snapshots dropped while a page couldn't be erased.
+
+static const FlashLogChunk *get_slot(uint32_t slot);
+static bool is_valid(const FlashLogChunk *chunk);
+static bool is_erase_blocked();
+static bool write_chunk(FlashLogType type, uint16_t size);
+static void start_chunk();
+
+#define PRINT_SUBJECT "Flash Log"
+
+void Flash_Log_Init()
+{
+	Profile_Init();
+
+	// the newest chunk has the highest sequence, allowing for wrap around.
+	s_has_newest = false;
+	for (uint32_t slot = 0; slot < NUM_CHUNKS; slot++)
+	{
+		const FlashLogChunk *chunk = get_slot(slot);
+		if (!is_valid(chunk))
+			continue;
+
+		if (!s_has_newest || (int32_t)(chunk->sequence - get_slot(s_newest_slot)->sequence) > 0)
+		{
+			s_newest_slot = slot;
+			s_has_newest = true;
+		}
+	}
+
+	if (s_has_newest)
+	{
+		s_next_slot = (s_newest_slot + 1) % NUM_CHUNKS;
+		s_next_sequence = get_slot(s_newest_slot)->sequence + 1;
+		PRINT_INFO("resuming after chunk %lu.", s_next_sequence - 1);
+	}
+	else
+	{
+		s_next_slot = 0;
+		s_next_sequence = 0;
+	}
+
+	// a slot that isn't erased was being written during a reset. start on
+	// the next page, which gets erased first.
+	if (s_next_slot % CHUNKS_PER_PAGE != 0 && get_slot(s_next_slot)->magic != UINT32_MAX)
+	{
+		s_next_slot = (s_next_slot / CHUNKS_PER_PAGE + 1) * CHUNKS_PER_PAGE % NUM_CHUNKS;
+	}
+
+	start_chunk();
+}
+
+bool Flash_Log_Append(const SensorSnapshot *snapshot)
+{
+	uint32_t start = Profile_Cycles();
+	uint32_t position = s_stream.position;
+	bool success = true;
+
+	if (!Snapshot_Codec_Encode(&s_codec, snapshot, &s_stream))
+	{
+		success = Flash_Log_Flush();
+
+		// the chunk is kept until the page it goes in is free to be erased.
+		if (s_chunk.records != 0)
+		{
+			s_dropped++;
+			return false;
+		}
+
+		position = 0;
+
+		// always fits, as it's the first record of an empty chunk.
+		Snapshot_Codec_Encode(&s_codec, snapshot, &s_stream);
+	}
+
+	s_chunk.records++;
+	s_records++;
+	s_compressed_bits += s_stream.position - position;
+
+	s_last_cycles = Profile_Cycles() - start;
+	if (s_last_cycles > s_worst_cycles && success)
+		s_worst_cycles = s_last_cycles; // excluding flash writes.
+
+	return success;
+}
+
+bool Flash_Log_Append_Record(FlashLogType type, const void *data, uint16_t size)
+{
+	if (type == FLASH_LOG_SNAPSHOTS || type >= NUM_FLASH_LOG_TYPES || size > sizeof(s_chunk.data))
+		return false;
+
+	bool success = Flash_Log_Flush();
+	if (s_chunk.records != 0)
+		return false;
+
+	memcpy(s_chunk.data, data, size);
+	s_chunk.records = 1;
+	success = write_chunk(type, size) && success;
+
+	start_chunk();
+	return success;
+}
+
+bool Flash_Log_Flush()
+{
+	if (s_chunk.records == 0)
+		return true;
+
+	if (is_erase_blocked())
+		return false;
+
+	bool success = write_chunk(FLASH_LOG_SNAPSHOTS, (s_stream.position + 7) / 8);
+
+	start_chunk();
+	return success;
+}
+
+uint32_t Flash_Log_Get_Page(uint32_t pages_back)
+{
+	if (!s_has_newest || pages_back >= NUM_PAGES)
+		return 0;
+
+	uint32_t page = (s_newest_slot / CHUNKS_PER_PAGE + NUM_PAGES - pages_back) % NUM_PAGES;
+
+	// chunks are still being added to the page of the next slot.
+	if (s_next_slot % CHUNKS_PER_PAGE != 0 && page == s_next_slot / CHUNKS_PER_PAGE)
+		return 0;
+
+	// the log may not have gone round the ring yet.
+	bool written = false;
+	for (uint32_t slot = page * CHUNKS_PER_PAGE; slot < (page + 1) * CHUNKS_PER_PAGE; slot++)
+	{
+		if (is_valid(get_slot(slot)))
+			written = true;
+	}
+
+	if (!written)
+		return 0;
+
+	s_sending_page = FLASH_LOG_START_ADDR + page * FLASH_PAGE_SIZE;
+	return s_sending_page;
+}
+
+void Flash_Log_Print_Stats()
+{
+	uint32_t raw_bytes = s_records * sizeof(SensorSnapshot);
+	uint32_t compressed_bytes = (s_compressed_bits + 7) / 8;
+
+	PRINT_INFO("%lu snapshots, %lu bytes compressed to %lu (ratio x100: %lu)",
+			s_records, raw_bytes, compressed_bytes,
+			compressed_bytes == 0 ? 0 : raw_bytes * 100 / compressed_bytes);
+	PRINT_INFO("compressing took %lu cycles, worst: %lu cycles", s_last_cycles, s_worst_cycles);
+	PRINT_INFO("%lu snapshots dropped while the next page was being downlinked.", s_dropped);
+}
+
+static const FlashLogChunk *get_slot(uint32_t slot)
+{
+	return (const FlashLogChunk *)(FLASH_LOG_START_ADDR + slot * FLASH_LOG_CHUNK_SIZE);
+}
+
+/**
+ * @brief Checks that a chunk in flash was completely written.
+ */
+static bool is_valid(const FlashLogChunk *chunk)
+{
+	bool known = false;
+	for (int i = 0; i < NUM_FLASH_LOG_TYPES; i++)
+	{
+		if (chunk->magic == MAGICS[i])
+			known = true;
+	}
+
+	if (!known || chunk->size > sizeof(chunk->data))
+		return false;
+
+	size_t size = offsetof(FlashLogChunk, data) - offsetof(FlashLogChunk, magic) + chunk->size;
+	return chunk->crc == CRC_Compute(&chunk->magic, size);
+}
+
+/**
+ * @brief Checks whether the next write would erase the page being downlinked.
+ */
+static bool is_erase_blocked()
+{
+	return s_next_slot % CHUNKS_PER_PAGE == 0
+		&& Bulk_Get_Source() == BULK_SOURCE_LOG
+		&& (uint32_t)get_slot(s_next_slot) == s_sending_page;
+}
+
+/**
+ * @brief Writes the chunk in RAM to the next slot.
+ *
+ * @param size	Bytes of data in the chunk.
+ */
+static bool write_chunk(FlashLogType type, uint16_t size)
+{
+	uint32_t slot = s_next_slot;
+	uint32_t address = (uint32_t)get_slot(slot);
+
+	s_chunk.magic = MAGICS[type];
+	s_chunk.sequence = s_next_sequence;
+	s_chunk.size = size;
+	s_chunk.crc = CRC_Compute(&s_chunk.magic, offsetof(FlashLogChunk, data) - offsetof(FlashLogChunk, magic) + s_chunk.size);
+
+	// skip the slot even on failure, as it may be half written.
+	s_next_slot = (slot + 1) % NUM_CHUNKS;
+	s_next_sequence++;
+
+	bool success = true;
+	if (slot % CHUNKS_PER_PAGE == 0 && !Flash_Erase_Page(address))
+	{
+		success = false;
+	}
+	else if (!Flash_Program(address, &s_chunk, offsetof(FlashLogChunk, data) + s_chunk.size))
+	{
+		success = false;
+	}
+	else
+	{
+		s_newest_slot = slot;
+		s_has_newest = true;
+	}
+
+	if (!success)
+	{
+		PRINT_ERROR("failed to write chunk %lu. %u records lost.", s_chunk.sequence, s_chunk.records);
+		Error_Log_Put(ERROR_FLASH_LOG_WRITE, s_chunk.records);
+	}
+
+	return success;
+}
+
+/**
+ * @brief Empties the chunk in RAM and starts a new stream in it.
+ */
+static void start_chunk()
+{
+	Snapshot_Codec_Reset(&s_codec);
+	s_chunk.records = 0;
+	s_stream.data = s_chunk.data;
+	s_stream.size = sizeof(s_chunk.data);
+	s_stream.position = 0;
+}
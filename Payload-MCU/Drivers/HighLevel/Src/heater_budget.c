@@ -0,0 +1,169 @@
+/*
+ * heater_budget.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Keeps the heaters within the power the satellite bus can give
+ *           the payload.
+ */
+
+#include "heater_budget.h"
+#include "error_log.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tuk/debug/print.h"
+
+#define NUM_WELLS 16
+#define ERROR_BITS 16 // the rank is priority << ERROR_BITS | error.
+
+static const uint32_t HEATER_POWER = 500; // mW drawn by one heater. nominal, until measured.
+
+static uint16_t s_limit = HEATER_BUDGET_DEFAULT_LIMIT;
+static uint8_t s_priorities[NUM_WELLS] = {0};
+static uint16_t s_errors[NUM_WELLS] = {0}; // below setpoint, in hundredths of a degree.
+static uint16_t s_held = 0;                // held off by the last apply.
+
+// utilisation since the stats were last taken.
+static uint16_t s_heaters = 0;      // on since the last record.
+static uint32_t s_last_record = 0;  // HAL tick.
+static uint32_t s_window_start = 0; // HAL tick.
+static uint32_t s_heater_ms = 0;    // sum over time of the heaters on.
+static uint8_t s_peak = 0;
+static uint16_t s_held_since = 0;
+
+static void accumulate(uint32_t now);
+
+#define PRINT_SUBJECT "Heater Budget"
+
+void Heater_Budget_Set_Limit(uint16_t limit)
+{
+	s_limit = limit;
+	PRINT_INFO("limit set to %u mW, %lu heaters.", limit, Heater_Budget_Get_Max_Heaters());
+}
+
+uint16_t Heater_Budget_Get_Limit()
+{
+	return s_limit;
+}
+
+uint32_t Heater_Budget_Get_Max_Heaters()
+{
+	uint32_t max = s_limit / HEATER_POWER;
+	return max < NUM_WELLS ? max : NUM_WELLS;
+}
+
+bool Heater_Budget_Set_Priority(WellID well_id, uint8_t priority)
+{
+	if (well_id < WELL_0 || well_id > WELL_15)
+	{
+		PRINT_ERROR("invalid well id: %d.", well_id);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
+		return false;
+	}
+
+	s_priorities[well_id] = priority;
+
+	return true;
+}
+
+void Heater_Budget_Set_Error(WellID well_id, int16_t error)
+{
+	if (well_id < WELL_0 || well_id > WELL_15)
+		return;
+
+	s_errors[well_id] = error > 0 ? error : 0;
+}
+
+uint32_t Heater_Budget_Get_Rank(WellID well_id)
+{
+	if (well_id < WELL_0 || well_id > WELL_15)
+		return 0;
+
+	return (uint32_t)s_priorities[well_id] << ERROR_BITS | s_errors[well_id];
+}
+
+uint16_t Heater_Budget_Apply(uint16_t requested)
+{
+	uint32_t max = Heater_Budget_Get_Max_Heaters();
+	uint16_t allowed = requested;
+
+	// drop the lowest ranked until the rest fit. ties drop the highest well.
+	while ((uint32_t)__builtin_popcount(allowed) > max)
+	{
+		int lowest = -1;
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			if ((allowed & (1 << i))
+			 && (lowest < 0 || Heater_Budget_Get_Rank(i) <= Heater_Budget_Get_Rank(lowest)))
+				lowest = i;
+		}
+
+		allowed &= ~(1 << lowest);
+	}
+
+	s_held = requested & ~allowed;
+	if (s_held != 0)
+	{
+		s_held_since |= s_held;
+		Error_Log_Put(ERROR_HEATER_HELD, s_held);
+	}
+
+	return allowed;
+}
+
+uint16_t Heater_Budget_Get_Held()
+{
+	return s_held;
+}
+
+void Heater_Budget_Record(uint16_t heaters)
+{
+	accumulate(HAL_GetTick());
+
+	s_heaters = heaters;
+
+	uint8_t count = __builtin_popcount(heaters);
+	if (count > s_peak)
+		s_peak = count;
+}
+
+void Heater_Budget_Take_Stats(HeaterBudgetStats *out)
+{
+	uint32_t now = HAL_GetTick();
+	accumulate(now);
+
+	uint32_t max = Heater_Budget_Get_Max_Heaters();
+	uint32_t capacity = (now - s_window_start) * max;
+	uint32_t utilisation = capacity != 0 ? (uint32_t)(((uint64_t)s_heater_ms * 100) / capacity) : 0;
+
+	out->utilisation = utilisation < UINT8_MAX ? utilisation : UINT8_MAX;
+	out->peak = s_peak;
+	out->max = max;
+	out->held = s_held_since;
+
+	s_window_start = now;
+	s_heater_ms = 0;
+	s_peak = __builtin_popcount(s_heaters);
+	s_held_since = s_held;
+}
+
+void Heater_Budget_Print()
+{
+	PRINT_INFO("limit: %u mW (%lu heaters), on: 0x%04X, held off: 0x%04X",
+			s_limit, Heater_Budget_Get_Max_Heaters(), s_heaters, s_held);
+
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (s_priorities[i] != 0)
+			PRINT_INFO("  well %2d: priority %u", i, s_priorities[i]);
+	}
+}
+
+// adds the heaters on since the last record to the utilisation.
+static void accumulate(uint32_t now)
+{
+	s_heater_ms += (now - s_last_record) * __builtin_popcount(s_heaters);
+	s_last_record = now;
+}
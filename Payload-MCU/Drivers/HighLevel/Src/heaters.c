@@ -6,33 +6,28 @@
  */
 
 #include "heaters.h"
+#include "heater_budget.h"
 #include "well_id.h"
 #include "power.h"
 #include "tca9539.h"
 #include "expander_pin_location.h"
+#include "board_topology.h"
+#include "error_log.h"
 
 #include <stdbool.h>
 #include "tuk/debug/print.h"
 
-static const ExpanderPinLocation HEATER_LOCATIONS[] = {
-		{ EXPANDER_1, EXPANDER_PIN_3  }, // HEATER 0
-		{ EXPANDER_1, EXPANDER_PIN_1  }, // HEATER 1
-		{ EXPANDER_1, EXPANDER_PIN_17 }, // HEATER 2
-		{ EXPANDER_1, EXPANDER_PIN_15 }, // HEATER 3
-		{ EXPANDER_1, EXPANDER_PIN_5  }, // HEATER 4
-		{ EXPANDER_1, EXPANDER_PIN_7  }, // HEATER 5
-		{ EXPANDER_1, EXPANDER_PIN_11 }, // HEATER 6
-		{ EXPANDER_1, EXPANDER_PIN_13 }, // HEATER 7
-		{ EXPANDER_2, EXPANDER_PIN_3  }, // HEATER 8
-		{ EXPANDER_2, EXPANDER_PIN_1  }, // HEATER 9
-		{ EXPANDER_2, EXPANDER_PIN_17 }, // HEATER 10
-		{ EXPANDER_2, EXPANDER_PIN_15 }, // HEATER 11
-		{ EXPANDER_2, EXPANDER_PIN_5  }, // HEATER 12
-		{ EXPANDER_2, EXPANDER_PIN_7  }, // HEATER 13
-		{ EXPANDER_2, EXPANDER_PIN_11 }, // HEATER 14
-		{ EXPANDER_2, EXPANDER_PIN_13 }, // HEATER 15
+static const ExpanderPinLocation HEATER_LOCATIONS[] = BOARD_HEATER_LOCATIONS;
+
+// pins driving a heater on each expander.
+static const uint16_t HEATER_PINS[] = {
+		[EXPANDER_1] = BOARD_HEATER_PINS(EXPANDER_1),
+		[EXPANDER_2] = BOARD_HEATER_PINS(EXPANDER_2),
 };
 
+// last successfully written heater states. bit n is well n.
+static uint16_t s_heater_states = 0x0000;
+
 #define PRINT_SUBJECT "Heaters"
 
 bool Heaters_Set_Heater(WellID well_id, Power power)
@@ -42,18 +37,69 @@ bool Heaters_Set_Heater(WellID well_id, Power power)
 	if (well_id < WELL_0 || well_id > WELL_15)
 	{
 		PRINT_ERROR("invalid well id: %d.", well_id);
-		//PUT_ERROR(ERR_PLD_INVALID_WELL_ID);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
 		return false;
 	}
 
+	// switching one on goes through the budget, which may hold others off.
+	if (power == ON)
+	{
+		return Heaters_Set_All(s_heater_states | 1 << well_id)
+			&& (s_heater_states & 1 << well_id);
+	}
+
 	ExpanderPinLocation location = HEATER_LOCATIONS[well_id];
 	bool success = TCA9539_Set_Pin(location.device, location.pin, power);
 
 	if (!success)
 	{
-		PRINT_ERROR("failed to set heater %d to %s", well_id, power ? "ON" : "OFF");
-		//PUT_ERROR(ERR_PLD_TCA9539_SET_PIN);
+		Error_Log_Put(ERROR_TCA9539_SET_PIN, well_id);
+	}
+	else
+	{
+		s_heater_states &= ~(1 << well_id);
+		Heater_Budget_Record(s_heater_states);
 	}
 
 	return success;
 }
+
+bool Heaters_Set_All(uint16_t well_bitmap)
+{
+	well_bitmap = Heater_Budget_Apply(well_bitmap);
+
+	// requested pin states per expander.
+	uint16_t outputs[] = { 0x0000, 0x0000 };
+
+	for (int i = WELL_0; i <= WELL_15; i++)
+	{
+		if (well_bitmap & (1 << i))
+		{
+			ExpanderPinLocation location = HEATER_LOCATIONS[i];
+			outputs[location.device] |= 1 << location.pin;
+		}
+	}
+
+	bool success = true;
+
+	if (!TCA9539_Set_Pins(EXPANDER_1, HEATER_PINS[EXPANDER_1], outputs[EXPANDER_1]))
+		success = false;
+	if (!TCA9539_Set_Pins(EXPANDER_2, HEATER_PINS[EXPANDER_2], outputs[EXPANDER_2]))
+		success = false;
+
+	if (!success)
+	{
+		Error_Log_Put(ERROR_TCA9539_SET_PIN, well_bitmap);
+		return false;
+	}
+
+	s_heater_states = well_bitmap;
+	Heater_Budget_Record(s_heater_states);
+
+	return true;
+}
+
+uint16_t Heaters_Get_All()
+{
+	return s_heater_states;
+}
@@ -0,0 +1,148 @@
+/*
+ * i2c_speed_test.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Picks the fastest I2C speed each segment of the bus works at.
+ */
+
+#include "i2c_speed_test.h"
+#include "i2c_bus.h"
+#include "timebase.h"
+#include "tca9548.h"
+#include "tca9539.h"
+#include "sensors.h"
+#include "max6822.h"
+#include "well_id.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tuk/debug/print.h"
+
+#define NUM_MUX_CHANNELS (MUX_CHANNEL_5 + 1)
+
+static int test_root();
+static int sweep(int *failures);
+static I2CSpeed pick_speed(const int *failures, int stride, I2CSpeed max_speed);
+
+#define PRINT_SUBJECT "I2C Speed"
+
+void I2C_Speed_Test_Run(I2CSpeed max_speed)
+{
+	if (max_speed >= NUM_I2C_SPEEDS)
+		max_speed = NUM_I2C_SPEEDS - 1;
+
+	// failures seen at each speed.
+	int root_failures[NUM_I2C_SPEEDS];
+	int failures[NUM_I2C_SPEEDS][NUM_MUX_CHANNELS];
+
+	for (I2CSpeed speed = I2C_SPEED_STANDARD; speed <= max_speed; speed++)
+	{
+		I2C_Bus_Set_Speed(I2C_SEGMENT_ROOT, speed);
+		I2C_Bus_Reset_Health(); // so failures at one speed don't quarantine devices at the next.
+		root_failures[speed] = test_root();
+	}
+
+	I2CSpeed root_speed = pick_speed(root_failures, 1, max_speed);
+	I2C_Bus_Set_Speed(I2C_SEGMENT_ROOT, root_speed);
+
+	for (I2CSpeed speed = I2C_SPEED_STANDARD; speed <= max_speed; speed++)
+	{
+		MAX6822_Reset_Timer();
+
+		for (int channel = MUX_CHANNEL_0; channel < NUM_MUX_CHANNELS; channel++)
+		{
+			I2C_Bus_Set_Speed(channel, speed);
+		}
+		I2C_Bus_Reset_Health();
+
+		uint32_t start = Timebase_Local_Micros();
+		int total = sweep(failures[speed]);
+		uint32_t elapsed = Timebase_Local_Micros() - start;
+
+		PRINT_INFO("sweep at %4lu kHz: %6lu us, %2d failures.",
+				I2C_Bus_Get_Frequency(speed) / 1000, elapsed, total);
+	}
+
+	PRINT_INFO("root: %lu kHz.", I2C_Bus_Get_Frequency(root_speed) / 1000);
+
+	for (int channel = MUX_CHANNEL_0; channel < NUM_MUX_CHANNELS; channel++)
+	{
+		I2CSpeed speed = pick_speed(&failures[0][channel], NUM_MUX_CHANNELS, max_speed);
+		I2C_Bus_Set_Speed(channel, speed);
+
+		PRINT_INFO("channel %d: %lu kHz.", channel, I2C_Bus_Get_Frequency(speed) / 1000);
+	}
+
+	I2C_Bus_Reset_Health();
+}
+
+/**
+ * @brief Checks the devices on the root segment.
+ *
+ * @return The number of devices that didn't respond.
+ */
+static int test_root()
+{
+	int failures = 0;
+
+	if (!TCA9548_Is_Present()) failures++;
+	if (!TCA9539_Is_Present(EXPANDER_1)) failures++;
+	if (!TCA9539_Is_Present(EXPANDER_2)) failures++;
+
+	return failures;
+}
+
+/**
+ * @brief Reads every thermistor and photocell once.
+ *
+ * @param failures	Array of failed reads per mux channel.
+ * @return			The total number of failed reads.
+ */
+static int sweep(int *failures)
+{
+	int total = 0;
+
+	for (int channel = MUX_CHANNEL_0; channel < NUM_MUX_CHANNELS; channel++)
+	{
+		failures[channel] = 0;
+	}
+
+	SensorSnapshot snapshot;
+	Sensors_Sweep(&snapshot);
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		for (int i = WELL_0; i <= WELL_15; i++)
+		{
+			if (!(snapshot.valid[type] & (1 << i)))
+			{
+				failures[Sensors_Get_Location(type, i).channel]++;
+				total++;
+			}
+		}
+	}
+
+	return total;
+}
+
+/**
+ * @brief Picks the fastest speed with no more failures than at 100 kHz, so a
+ *        dead device doesn't hold back the rest of its segment.
+ *
+ * @param failures	Failures at each speed, stride elements apart.
+ */
+static I2CSpeed pick_speed(const int *failures, int stride, I2CSpeed max_speed)
+{
+	I2CSpeed best = I2C_SPEED_STANDARD;
+
+	for (I2CSpeed speed = I2C_SPEED_FAST; speed <= max_speed; speed++)
+	{
+		if (failures[speed * stride] > failures[0])
+			break; // anything faster is no more likely to work.
+
+		best = speed;
+	}
+
+	return best;
+}
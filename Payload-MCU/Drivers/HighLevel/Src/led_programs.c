@@ -0,0 +1,213 @@
+/*
+ * led_programs.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Per-well photoperiod (light/dark cycle) programs for the LEDs.
+ */
+
+#include "led_programs.h"
+#include "leds.h"
+#include "config_store.h"
+#include "error_log.h"
+#include "well_id.h"
+#include "assert.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tuk/tuk.h"
+#include "payload_cmds.h"
+
+#define NUM_WELLS (WELL_15 + 1)
+
+static const uint32_t TICK_PERIOD = 1000; // in ms.
+static const uint32_t SAVE_DELAY = 1000;  // in ms. wait for uploads to settle.
+
+static LEDProgram s_programs[NUM_WELLS];
+static LEDProgramState s_states[NUM_WELLS];
+
+static uint32_t s_last_tick;     // HAL tick of the last program tick.
+static uint16_t s_applied;       // LED states last written to the expanders.
+static uint16_t s_unsaved = 0;   // bit n is set if well n's program changed since last save.
+static uint32_t s_last_change;   // HAL tick of the last program change.
+
+static void restart_program(WellID well_id);
+static uint16_t tick_programs();
+static bool save_programs();
+
+#define PRINT_SUBJECT "LED Programs"
+
+void LED_Programs_Init()
+{
+	int loaded = 0;
+
+	for (int i = WELL_0; i <= WELL_15; i++)
+	{
+		if (Config_Get(CONFIG_KEY_LED_PROGRAMS + i, &s_programs[i], sizeof(LEDProgram)) == sizeof(LEDProgram))
+			loaded++;
+		else
+			memset(&s_programs[i], 0, sizeof(LEDProgram));
+
+		restart_program(i);
+	}
+
+	if (loaded == 0)
+		PRINT_INFO("no saved programs found. All LEDs off.");
+
+	s_applied = LEDs_Get_All();
+	s_last_tick = HAL_GetTick() - TICK_PERIOD; // evaluate on first update.
+}
+
+void LED_Programs_Update()
+{
+	uint32_t now = HAL_GetTick();
+
+	// catch up on every elapsed second so long calls don't skew the programs.
+	uint16_t states = s_applied;
+	bool ticked = false;
+	while (now - s_last_tick >= TICK_PERIOD)
+	{
+		s_last_tick += TICK_PERIOD;
+		states = tick_programs();
+		ticked = true;
+	}
+
+	if (ticked && states != s_applied)
+	{
+		// on failure, s_applied is left unchanged so the write is retried.
+		if (LEDs_Set_All(states))
+		{
+			s_applied = states;
+		}
+	}
+
+	if (s_unsaved != 0 && now - s_last_change >= SAVE_DELAY)
+	{
+		save_programs();
+		s_last_change = now; // don't retry failed saves in a tight loop.
+	}
+}
+
+bool LED_Programs_Set(WellID well_id, const LEDProgram *program)
+{
+	ASSERT(WELL_0 <= well_id && well_id <= WELL_15, "invalid well id: %d.", well_id);
+
+	if (well_id < WELL_0 || well_id > WELL_15)
+	{
+		PRINT_ERROR("invalid well id: %d.", well_id);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
+		return false;
+	}
+
+	if ((uint32_t)program->on_time + program->off_time > LED_PROGRAM_MAX_PERIOD)
+	{
+		PRINT_ERROR("period of %lu s is too long.", (uint32_t)program->on_time + program->off_time);
+		Error_Log_Put(ERROR_INVALID_ARGUMENT, CMD_PLD_SET_LED_PROGRAM);
+		return false;
+	}
+
+	s_programs[well_id] = *program;
+	s_programs[well_id].reserved = 0;
+	restart_program(well_id);
+
+	s_unsaved |= 1 << well_id;
+	s_last_change = HAL_GetTick();
+
+	return true;
+}
+
+void LED_Programs_Get_States(LEDProgramState *out)
+{
+	memcpy(out, s_states, sizeof(s_states));
+}
+
+void LED_Programs_Restore_States(const LEDProgramState *states)
+{
+	memcpy(s_states, states, sizeof(s_states));
+}
+
+bool LED_Programs_Test()
+{
+	// the next program tick restores the programmed states.
+	if (!LEDs_Set_All(0xFFFF))
+		return false;
+
+	s_applied = 0xFFFF;
+
+	return true;
+}
+
+/**
+ * @brief Resets the progress of a well to the start of its program.
+ */
+static void restart_program(WellID well_id)
+{
+	const LEDProgram *program = &s_programs[well_id];
+	uint32_t period = (uint32_t)program->on_time + program->off_time;
+
+	s_states[well_id].position = (period != 0) ? program->phase % period : 0;
+	s_states[well_id].cycles = 0;
+}
+
+/**
+ * @brief Evaluates all programs for the current second, then advances them.
+ *
+ * @return bit n is the LED state of well n.
+ */
+static uint16_t tick_programs()
+{
+	uint16_t states = 0x0000;
+
+	for (int i = WELL_0; i <= WELL_15; i++)
+	{
+		const LEDProgram *program = &s_programs[i];
+		LEDProgramState *state = &s_states[i];
+
+		if (program->on_time == 0)
+			continue;
+
+		if (program->repeats != 0 && state->cycles >= program->repeats)
+			continue; // program finished.
+
+		if (state->position < program->on_time)
+			states |= 1 << i;
+
+		// advance to the next second.
+		state->position++;
+		if (state->position >= (uint32_t)program->on_time + program->off_time)
+		{
+			state->position = 0;
+			if (state->cycles < UINT16_MAX)
+				state->cycles++;
+		}
+	}
+
+	return states;
+}
+
+/**
+ * @brief Writes the changed programs to the config store. Those that fail
+ *        stay unsaved, to be retried.
+ *
+ * @return true on success. false on error.
+ */
+static bool save_programs()
+{
+	uint16_t pending = s_unsaved;
+
+	for (int i = WELL_0; i <= WELL_15; i++)
+	{
+		if ((pending & (1 << i)) && Config_Set(CONFIG_KEY_LED_PROGRAMS + i, &s_programs[i], sizeof(LEDProgram)))
+			s_unsaved &= ~(1 << i);
+	}
+
+	if (s_unsaved != 0)
+	{
+		PRINT_ERROR("failed to save programs to flash.");
+		return false;
+	}
+
+	return true;
+}
@@ -9,29 +9,23 @@
 #include "well_id.h"
 #include "tca9539.h"
 #include "expander_pin_location.h"
+#include "board_topology.h"
+#include "error_log.h"
 
 #include <stdbool.h>
 #include "tuk/debug/print.h"
 
-static const ExpanderPinLocation LED_LOCATIONS[] = {
-		{ EXPANDER_1, EXPANDER_PIN_2  }, // LED 0
-		{ EXPANDER_1, EXPANDER_PIN_0  }, // LED 1
-		{ EXPANDER_1, EXPANDER_PIN_16 }, // LED 2
-		{ EXPANDER_1, EXPANDER_PIN_14 }, // LED 3
-		{ EXPANDER_1, EXPANDER_PIN_4  }, // LED 4
-		{ EXPANDER_1, EXPANDER_PIN_6  }, // LED 5
-		{ EXPANDER_1, EXPANDER_PIN_10 }, // LED 6
-		{ EXPANDER_1, EXPANDER_PIN_12 }, // LED 7
-		{ EXPANDER_2, EXPANDER_PIN_2  }, // LED 8
-		{ EXPANDER_2, EXPANDER_PIN_0  }, // LED 9
-		{ EXPANDER_2, EXPANDER_PIN_16 }, // LED 10
-		{ EXPANDER_2, EXPANDER_PIN_14 }, // LED 11
-		{ EXPANDER_2, EXPANDER_PIN_4  }, // LED 12
-		{ EXPANDER_2, EXPANDER_PIN_6  }, // LED 13
-		{ EXPANDER_2, EXPANDER_PIN_10 }, // LED 14
-		{ EXPANDER_2, EXPANDER_PIN_12 }, // LED 15
+static const ExpanderPinLocation LED_LOCATIONS[] = BOARD_LED_LOCATIONS;
+
+// pins driving an LED on each expander.
+static const uint16_t LED_PINS[] = {
+		[EXPANDER_1] = BOARD_LED_PINS(EXPANDER_1),
+		[EXPANDER_2] = BOARD_LED_PINS(EXPANDER_2),
 };
 
+// last successfully written LED states. bit n is well n.
+static uint16_t s_led_states = 0x0000;
+
 #define PRINT_SUBJECT "LEDs"
 
 bool LEDs_Set_LED(WellID well_id, Power power)
@@ -41,7 +35,7 @@ bool LEDs_Set_LED(WellID well_id, Power power)
 	if (well_id < WELL_0 || well_id > WELL_15)
 	{
 		PRINT_ERROR("invalid well id: %d.", well_id);
-		//PUT_ERROR(ERR_PLD_INVALID_WELL_ID);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
 		return false;
 	}
 
@@ -50,9 +44,53 @@ bool LEDs_Set_LED(WellID well_id, Power power)
 
 	if (!success)
 	{
-		PRINT_ERROR("failed to set LED %d to %s", well_id, power ? "ON" : "OFF");
-		//PUT_ERROR(ERR_PLD_TCA9539_SET_PIN);
+		Error_Log_Put(ERROR_TCA9539_SET_PIN, well_id);
+	}
+	else if (power == ON)
+	{
+		s_led_states |= 1 << well_id;
+	}
+	else
+	{
+		s_led_states &= ~(1 << well_id);
 	}
 
 	return success;
 }
+
+bool LEDs_Set_All(uint16_t well_bitmap)
+{
+	// requested pin states per expander.
+	uint16_t outputs[] = { 0x0000, 0x0000 };
+
+	for (int i = WELL_0; i <= WELL_15; i++)
+	{
+		if (well_bitmap & (1 << i))
+		{
+			ExpanderPinLocation location = LED_LOCATIONS[i];
+			outputs[location.device] |= 1 << location.pin;
+		}
+	}
+
+	bool success = true;
+
+	if (!TCA9539_Set_Pins(EXPANDER_1, LED_PINS[EXPANDER_1], outputs[EXPANDER_1]))
+		success = false;
+	if (!TCA9539_Set_Pins(EXPANDER_2, LED_PINS[EXPANDER_2], outputs[EXPANDER_2]))
+		success = false;
+
+	if (!success)
+	{
+		Error_Log_Put(ERROR_TCA9539_SET_PIN, well_bitmap);
+		return false;
+	}
+
+	s_led_states = well_bitmap;
+
+	return true;
+}
+
+uint16_t LEDs_Get_All()
+{
+	return s_led_states;
+}
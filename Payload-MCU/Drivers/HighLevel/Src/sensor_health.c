@@ -0,0 +1,217 @@
+/*
+ * sensor_health.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Judges whether each sensor can be trusted, and takes the ones
+ *           that can't out of the sweep.
+ */
+
+#include "sensor_health.h"
+#include "error_log.h"
+#include "main.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tuk/debug/print.h"
+
+#define ADC_MAX_READING 4095 // MCP3221 is 12-bit.
+
+static const uint8_t QUARANTINE_FAULTS = 3;      // consecutive faults before quarantine.
+static const uint8_t RECOVERY_READINGS = 8;      // consecutive good readings before a sensor is no longer suspect.
+static const uint32_t MIN_REPROBE_DELAY = 10000; // in ms.
+static const uint32_t MAX_REPROBE_DELAY = 300000; // in ms.
+
+typedef struct
+{
+	bool check_rails;     // readings at either rail are faults.
+	uint16_t max_step;    // change always allowed between readings. 0 disables the rate check.
+	uint16_t max_rate;    // change allowed per second on top of max_step.
+	uint16_t stuck_limit; // identical readings in a row before a sensor is suspect. 0 disables.
+} HealthLimits;
+
+// a photocell legitimately reads 0 in the dark, saturates under its LED and
+// jumps when the LED switches, so only failures to read count against it.
+static const HealthLimits LIMITS[NUM_SENSOR_TYPES] = {
+		[SENSOR_THERMISTOR] = { .check_rails = true, .max_step = 32, .max_rate = 100, .stuck_limit = 600 },
+		[SENSOR_PHOTOCELL]  = { .check_rails = false, .max_step = 0, .max_rate = 0, .stuck_limit = 0 },
+};
+
+static const char *const TYPE_NAMES[] = {
+		"thermistor",
+		"photocell",
+};
+
+typedef struct
+{
+	uint16_t last;       // last plausible reading.
+	uint32_t last_time;  // when it was read. see Timebase_Now.
+	uint16_t repeats;    // identical readings in a row.
+	uint8_t faults;      // in a row.
+	uint8_t good;        // plausible readings in a row, up to RECOVERY_READINGS.
+	bool has_last;
+	uint32_t reprobe_at; // HAL tick. only while quarantined.
+	uint32_t delay;      // until the next re-probe, in ms.
+} SensorHealth;
+
+static SensorHealth s_health[NUM_SENSOR_TYPES][16];
+static uint16_t s_quarantined[NUM_SENSOR_TYPES] = {0};
+static uint16_t s_suspect[NUM_SENSOR_TYPES] = {0};
+
+static bool is_plausible(SensorType type, const SensorHealth *health, uint16_t reading, uint32_t timestamp);
+static void quarantine(SensorType type, WellID well_id, SensorHealth *health);
+
+#define PRINT_SUBJECT "Sensor Health"
+
+uint16_t Sensor_Health_Get_Due(SensorType type)
+{
+	if (type >= NUM_SENSOR_TYPES)
+		return 0;
+
+	uint16_t due = ~s_quarantined[type];
+	uint32_t now = HAL_GetTick();
+
+	uint32_t pending = s_quarantined[type];
+	while (pending != 0)
+	{
+		uint32_t well = __builtin_ctz(pending);
+		pending &= pending - 1;
+
+		if ((int32_t)(now - s_health[type][well].reprobe_at) >= 0)
+			due |= 1 << well;
+	}
+
+	return due;
+}
+
+bool Sensor_Health_Update(SensorType type, WellID well_id, bool read, uint16_t reading, uint32_t timestamp)
+{
+	if (type >= NUM_SENSOR_TYPES || well_id < WELL_0 || well_id > WELL_15)
+		return false;
+
+	SensorHealth *health = &s_health[type][well_id];
+	uint16_t bit = 1 << well_id;
+	bool plausible = read && is_plausible(type, health, reading, timestamp);
+
+	if (!plausible)
+	{
+		if (read)
+			Error_Log_Put(ERROR_SENSOR_IMPLAUSIBLE, type << 8 | well_id);
+
+		health->good = 0;
+		if (health->faults < UINT8_MAX)
+			health->faults++;
+
+		if (s_quarantined[type] & bit)
+		{
+			// failed a re-probe. wait longer for the next one.
+			health->delay = health->delay * 2 > MAX_REPROBE_DELAY ? MAX_REPROBE_DELAY : health->delay * 2;
+			health->reprobe_at = HAL_GetTick() + health->delay;
+		}
+		else if (health->faults >= QUARANTINE_FAULTS)
+		{
+			quarantine(type, well_id, health);
+		}
+
+		s_suspect[type] = (s_suspect[type] | bit) & ~s_quarantined[type];
+		return false;
+	}
+
+	if (s_quarantined[type] & bit)
+	{
+		PRINT_INFO("%s %d passed a re-probe. Sweeping it again.", TYPE_NAMES[type], well_id);
+		s_quarantined[type] &= ~bit;
+	}
+
+	if (!health->has_last || reading != health->last)
+		health->repeats = 0;
+	else if (health->repeats < UINT16_MAX)
+		health->repeats++;
+
+	health->last = reading;
+	health->last_time = timestamp;
+	health->has_last = true;
+	health->faults = 0;
+	if (health->good < RECOVERY_READINGS)
+		health->good++;
+
+	// stuck readings may still be right, so they only make a sensor suspect.
+	uint16_t stuck_limit = LIMITS[type].stuck_limit;
+	if (health->good < RECOVERY_READINGS || (stuck_limit != 0 && health->repeats >= stuck_limit))
+		s_suspect[type] |= bit;
+	else
+		s_suspect[type] &= ~bit;
+
+	return true;
+}
+
+uint16_t Sensor_Health_Get_Quarantined(SensorType type)
+{
+	return type < NUM_SENSOR_TYPES ? s_quarantined[type] : 0;
+}
+
+uint16_t Sensor_Health_Get_Suspect(SensorType type)
+{
+	return type < NUM_SENSOR_TYPES ? s_suspect[type] : 0;
+}
+
+void Sensor_Health_Print()
+{
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		PRINT_INFO("%-10s quarantined: 0x%04X, suspect: 0x%04X",
+				TYPE_NAMES[type], s_quarantined[type], s_suspect[type]);
+
+		uint32_t pending = s_quarantined[type];
+		while (pending != 0)
+		{
+			uint32_t well = __builtin_ctz(pending);
+			pending &= pending - 1;
+
+			const SensorHealth *health = &s_health[type][well];
+			PRINT_INFO("  well %lu: %u faults, next probe in %ld ms",
+					well, health->faults, (int32_t)(health->reprobe_at - HAL_GetTick()));
+		}
+	}
+}
+
+/**
+ * @brief Checks a reading against the limits of its type of sensor.
+ */
+static bool is_plausible(SensorType type, const SensorHealth *health, uint16_t reading, uint32_t timestamp)
+{
+	const HealthLimits *limits = &LIMITS[type];
+
+	// an open or shorted thermistor reads at a rail.
+	if (limits->check_rails && (reading == 0 || reading >= ADC_MAX_READING))
+		return false;
+
+	if (limits->max_step != 0 && health->has_last)
+	{
+		uint32_t change = reading > health->last ? reading - health->last : health->last - reading;
+		uint32_t elapsed = timestamp - health->last_time; // in us.
+
+		// in 64-bit, as the gap after a quarantine can be long.
+		uint64_t allowed = limits->max_step + (uint64_t)limits->max_rate * elapsed / 1000000;
+		if (change > allowed)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Takes a sensor out of the sweep until it passes a re-probe.
+ */
+static void quarantine(SensorType type, WellID well_id, SensorHealth *health)
+{
+	s_quarantined[type] |= 1 << well_id;
+	health->delay = MIN_REPROBE_DELAY;
+	health->reprobe_at = HAL_GetTick() + health->delay;
+
+	// the quantity may really have jumped. judge re-probes on their own.
+	health->has_last = false;
+
+	PRINT_ERROR("%s %d failed %u times in a row. Quarantined.", TYPE_NAMES[type], well_id, health->faults);
+	Error_Log_Put(ERROR_SENSOR_QUARANTINED, type << 8 | well_id);
+}
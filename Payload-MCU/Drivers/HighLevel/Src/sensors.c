@@ -0,0 +1,131 @@
+/*
+ * sensors.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Common read path for the ADCs behind the multiplexer.
+ */
+
+#include "sensors.h"
+#include "board_topology.h"
+#include "tca9548.h"
+#include "i2c_bus.h"
+#include "sensor_health.h"
+#include "calibration.h"
+#include "error_log.h"
+#include "timebase.h"
+#include "assert.h"
+#include "main.h"
+#include "tuk/tuk.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+static const MuxADCLocation ADC_LOCATIONS[NUM_SENSOR_TYPES][BOARD_NUM_WELLS] = {
+		[SENSOR_THERMISTOR] = BOARD_THERMISTOR_LOCATIONS,
+		[SENSOR_PHOTOCELL]  = BOARD_PHOTOCELL_LOCATIONS,
+};
+
+#define CHANNEL_BATCH(channel) [channel] = { \
+		[SENSOR_THERMISTOR] = BOARD_THERMISTORS_ON_CHANNEL(channel), \
+		[SENSOR_PHOTOCELL]  = BOARD_PHOTOCELLS_ON_CHANNEL(channel) }
+
+// wells to read on each channel, by type. bit n is well n.
+static const uint16_t CHANNEL_BATCHES[BOARD_NUM_MUX_CHANNELS][NUM_SENSOR_TYPES] = {
+		CHANNEL_BATCH(MUX_CHANNEL_0),
+		CHANNEL_BATCH(MUX_CHANNEL_1),
+		CHANNEL_BATCH(MUX_CHANNEL_2),
+		CHANNEL_BATCH(MUX_CHANNEL_3),
+		CHANNEL_BATCH(MUX_CHANNEL_4),
+		CHANNEL_BATCH(MUX_CHANNEL_5),
+};
+
+#define PRINT_SUBJECT "Sensors"
+
+bool Sensors_Read(SensorType type, WellID well_id, uint16_t *out)
+{
+	ASSERT(type < NUM_SENSOR_TYPES, "invalid sensor type: %d.", type);
+	ASSERT(WELL_0 <= well_id && well_id <= WELL_15, "invalid well id: %d.", well_id);
+
+	if (type >= NUM_SENSOR_TYPES || well_id < WELL_0 || well_id > WELL_15)
+	{
+		PRINT_ERROR("invalid sensor: type %d, well %d.", type, well_id);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
+		return false;
+	}
+
+	MuxADCLocation location = ADC_LOCATIONS[type][well_id];
+
+	if (!TCA9548_Select(location.channel))
+	{
+		Error_Log_Put(ERROR_SENSOR_READ, type << 8 | well_id);
+		return false;
+	}
+
+	uint8_t data[2];
+	if (!I2C_Bus_Receive(location.channel, location.address, data, sizeof(data)))
+	{
+		Error_Log_Put(ERROR_SENSOR_READ, type << 8 | well_id);
+		return false;
+	}
+
+	*out = BE_To_Native_16(data); // convert from BE to LE.
+
+	return true;
+}
+
+bool Sensors_Sweep(SensorSnapshot *out)
+{
+	memset(out->valid, 0, sizeof(out->valid));
+	out->timestamp = Timebase_Now();
+
+	// quarantined sensors are skipped, so a channel with none due is never
+	// selected.
+	uint16_t due[NUM_SENSOR_TYPES];
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		due[type] = Sensor_Health_Get_Due(type);
+	}
+
+	for (int channel = MUX_CHANNEL_0; channel < BOARD_NUM_MUX_CHANNELS; channel++)
+	{
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			uint16_t batch = CHANNEL_BATCHES[channel][type] & due[type];
+
+			for (int i = WELL_0; i <= WELL_15; i++)
+			{
+				if (!(batch & (1 << i)))
+					continue;
+
+				uint16_t reading = 0;
+				bool read = Sensors_Read(type, i, &reading);
+
+				if (Sensor_Health_Update(type, i, read, reading, out->timestamp))
+				{
+					out->readings[type][i] = reading;
+					out->valid[type] |= 1 << i;
+				}
+			}
+		}
+	}
+
+	Calibration_Apply(out);
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		if (out->valid[type] != 0xFFFF)
+			return false;
+	}
+
+	return true;
+}
+
+MuxADCLocation Sensors_Get_Location(SensorType type, WellID well_id)
+{
+	ASSERT(type < NUM_SENSOR_TYPES, "invalid sensor type: %d.", type);
+	ASSERT(WELL_0 <= well_id && well_id <= WELL_15, "invalid well id: %d.", well_id);
+
+	return ADC_LOCATIONS[type][well_id];
+}
@@ -0,0 +1,352 @@
+/*
+ * snapshot_codec.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Lossless compression of sensor snapshots for the flash log and
+ *           downlink.
+ */
+
+#include "snapshot_codec.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define CONTEXT_TIME NUM_SENSOR_TYPES
+
+static const uint32_t ADAPT_WINDOW = 64; // values after which the statistics are halved.
+static const uint32_t MAX_RICE_K = 24;
+
+static bool write_bits(BitStream *stream, uint32_t value, uint32_t count);
+static bool read_bits(BitStream *stream, uint32_t count, uint32_t *out);
+static bool write_rice(SnapshotCodec *codec, BitStream *stream, int context, uint32_t value);
+static bool read_rice(SnapshotCodec *codec, BitStream *stream, int context, uint32_t *out);
+static uint32_t get_rice_k(const SnapshotCodec *codec, int context);
+static void adapt(SnapshotCodec *codec, int context, uint32_t value);
+static bool encode(SnapshotCodec *codec, const SensorSnapshot *snapshot, BitStream *stream);
+
+static inline uint32_t zig_zag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unzig_zag(uint32_t value)
+{
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+void Snapshot_Codec_Reset(SnapshotCodec *codec)
+{
+	memset(codec, 0, sizeof(*codec));
+
+	for (int context = 0; context < CODEC_NUM_CONTEXTS; context++)
+	{
+		codec->magnitude[context] = 4;
+		codec->count[context] = 1;
+	}
+}
+
+bool Snapshot_Codec_Encode(SnapshotCodec *codec, const SensorSnapshot *snapshot, BitStream *stream)
+{
+	// work on copies, so nothing changes if the record doesn't fit.
+	SnapshotCodec next = *codec;
+	uint32_t position = stream->position;
+
+	if (!encode(&next, snapshot, stream))
+	{
+		stream->position = position;
+		return false;
+	}
+
+	*codec = next;
+	return true;
+}
+
+bool Snapshot_Codec_Decode(SnapshotCodec *codec, BitStream *stream, SensorSnapshot *snapshot)
+{
+	uint32_t key;
+	if (!read_bits(stream, 1, &key))
+		return false;
+
+	if (key)
+	{
+		Snapshot_Codec_Reset(codec);
+
+		uint32_t valid;
+		if (!read_bits(stream, 32, &snapshot->timestamp))
+			return false;
+
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			if (!read_bits(stream, 16, &valid))
+				return false;
+			codec->valid[type] = valid;
+		}
+
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			for (int well = WELL_0; well <= WELL_15; well++)
+			{
+				if (!(codec->valid[type] & (1 << well)))
+					continue;
+
+				uint32_t reading;
+				if (!read_bits(stream, 16, &reading))
+					return false;
+				codec->previous[type][well] = reading;
+			}
+		}
+
+		codec->started = true;
+		codec->interval = 0;
+	}
+	else
+	{
+		if (!codec->started)
+			return false; // joined the stream part way through.
+
+		uint32_t change;
+		if (!read_rice(codec, stream, CONTEXT_TIME, &change))
+			return false;
+		codec->interval += unzig_zag(change);
+		snapshot->timestamp = codec->timestamp + codec->interval;
+
+		uint32_t unchanged;
+		if (!read_bits(stream, 1, &unchanged))
+			return false;
+		for (int type = 0; !unchanged && type < NUM_SENSOR_TYPES; type++)
+		{
+			uint32_t valid;
+			if (!read_bits(stream, 16, &valid))
+				return false;
+			codec->valid[type] = valid;
+		}
+
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			for (int well = WELL_0; well <= WELL_15; well++)
+			{
+				if (!(codec->valid[type] & (1 << well)))
+					continue;
+
+				uint32_t difference;
+				if (!read_rice(codec, stream, type, &difference))
+					return false;
+				codec->previous[type][well] += unzig_zag(difference);
+			}
+		}
+	}
+
+	codec->timestamp = snapshot->timestamp;
+	memcpy(snapshot->readings, codec->previous, sizeof(snapshot->readings));
+	memcpy(snapshot->valid, codec->valid, sizeof(snapshot->valid));
+
+	return true;
+}
+
+/**
+ * @brief Writes a whole record.
+ *
+ * @return true on success. false if the stream is full, leaving it partly
+ *         written.
+ */
+static bool encode(SnapshotCodec *codec, const SensorSnapshot *snapshot, BitStream *stream)
+{
+	if (!codec->started)
+	{
+		if (!write_bits(stream, 1, 1) || !write_bits(stream, snapshot->timestamp, 32))
+			return false;
+
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			if (!write_bits(stream, snapshot->valid[type], 16))
+				return false;
+		}
+
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			for (int well = WELL_0; well <= WELL_15; well++)
+			{
+				if ((snapshot->valid[type] & (1 << well))
+						&& !write_bits(stream, snapshot->readings[type][well], 16))
+					return false;
+			}
+		}
+
+		codec->started = true;
+		codec->interval = 0;
+	}
+	else
+	{
+		uint32_t interval = snapshot->timestamp - codec->timestamp;
+		uint32_t change = zig_zag((int32_t)(interval - codec->interval));
+		if (!write_bits(stream, 0, 1) || !write_rice(codec, stream, CONTEXT_TIME, change))
+			return false;
+		codec->interval = interval;
+
+		bool unchanged = memcmp(snapshot->valid, codec->valid, sizeof(codec->valid)) == 0;
+		if (!write_bits(stream, unchanged, 1))
+			return false;
+		for (int type = 0; !unchanged && type < NUM_SENSOR_TYPES; type++)
+		{
+			if (!write_bits(stream, snapshot->valid[type], 16))
+				return false;
+		}
+
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			for (int well = WELL_0; well <= WELL_15; well++)
+			{
+				if (!(snapshot->valid[type] & (1 << well)))
+					continue;
+
+				int16_t difference = (int16_t)(snapshot->readings[type][well] - codec->previous[type][well]);
+				if (!write_rice(codec, stream, type, zig_zag(difference)))
+					return false;
+			}
+		}
+	}
+
+	// wells that weren't read keep their last reading as the reference.
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		for (int well = WELL_0; well <= WELL_15; well++)
+		{
+			if (snapshot->valid[type] & (1 << well))
+				codec->previous[type][well] = snapshot->readings[type][well];
+		}
+	}
+	memcpy(codec->valid, snapshot->valid, sizeof(codec->valid));
+	codec->timestamp = snapshot->timestamp;
+
+	return true;
+}
+
+static bool write_bits(BitStream *stream, uint32_t value, uint32_t count)
+{
+	if (stream->position + count > stream->size * 8)
+		return false;
+
+	while (count > 0)
+	{
+		uint32_t byte = stream->position >> 3;
+		uint32_t offset = stream->position & 7;
+		uint32_t length = 8 - offset < count ? 8 - offset : count;
+		uint32_t mask = (1U << length) - 1;
+
+		stream->data[byte] = (stream->data[byte] & ~(mask << offset)) | ((value & mask) << offset);
+
+		value >>= length;
+		count -= length;
+		stream->position += length;
+	}
+
+	return true;
+}
+
+static bool read_bits(BitStream *stream, uint32_t count, uint32_t *out)
+{
+	if (stream->position + count > stream->size * 8)
+		return false;
+
+	uint32_t value = 0;
+	uint32_t shift = 0;
+
+	while (shift < count)
+	{
+		uint32_t byte = stream->position >> 3;
+		uint32_t offset = stream->position & 7;
+		uint32_t length = 8 - offset < count - shift ? 8 - offset : count - shift;
+
+		value |= ((stream->data[byte] >> offset) & ((1U << length) - 1)) << shift;
+
+		shift += length;
+		stream->position += length;
+	}
+
+	*out = value;
+	return true;
+}
+
+static bool write_rice(SnapshotCodec *codec, BitStream *stream, int context, uint32_t value)
+{
+	uint32_t k = get_rice_k(codec, context);
+	uint32_t quotient = value >> k;
+
+	if (quotient >= CODEC_ESCAPE)
+	{
+		if (!write_bits(stream, (1U << CODEC_ESCAPE) - 1, CODEC_ESCAPE) || !write_bits(stream, value, 32))
+			return false;
+	}
+	else
+	{
+		// the ones, then the terminating zero.
+		if (!write_bits(stream, (1U << quotient) - 1, quotient + 1) || !write_bits(stream, value, k))
+			return false;
+	}
+
+	adapt(codec, context, value);
+	return true;
+}
+
+static bool read_rice(SnapshotCodec *codec, BitStream *stream, int context, uint32_t *out)
+{
+	uint32_t k = get_rice_k(codec, context);
+	uint32_t quotient = 0;
+	uint32_t bit;
+
+	while (quotient < CODEC_ESCAPE)
+	{
+		if (!read_bits(stream, 1, &bit))
+			return false;
+		if (!bit)
+			break;
+		quotient++;
+	}
+
+	uint32_t value;
+	if (quotient >= CODEC_ESCAPE)
+	{
+		if (!read_bits(stream, 32, &value))
+			return false;
+	}
+	else
+	{
+		uint32_t remainder;
+		if (!read_bits(stream, k, &remainder))
+			return false;
+		value = (quotient << k) | remainder;
+	}
+
+	adapt(codec, context, value);
+	*out = value;
+	return true;
+}
+
+/**
+ * @brief Picks the smallest k for which 2^k is at least the mean recent
+ *        value, as in LOCO-I.
+ */
+static uint32_t get_rice_k(const SnapshotCodec *codec, int context)
+{
+	uint32_t k = 0;
+	while (k < MAX_RICE_K && (codec->count[context] << k) < codec->magnitude[context])
+		k++;
+
+	return k;
+}
+
+static void adapt(SnapshotCodec *codec, int context, uint32_t value)
+{
+	// saturate so a burst of escapes can't overflow the sum.
+	uint32_t magnitude = codec->magnitude[context] + value;
+	codec->magnitude[context] = magnitude < codec->magnitude[context] ? UINT32_MAX : magnitude;
+	codec->count[context]++;
+
+	if (codec->count[context] >= ADAPT_WINDOW)
+	{
+		codec->magnitude[context] >>= 1;
+		codec->count[context] >>= 1;
+	}
+}
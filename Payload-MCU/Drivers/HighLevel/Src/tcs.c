@@ -7,5 +7,465 @@
  *  Purpose: Thermal Control System.
  */
 
-static const double ERROR_MARGIN = 0.1; // in deg C.
+#include "tcs.h"
+#include "tcs_model.h"
+#include "well_id.h"
+#include "sensors.h"
+#include "sensor_health.h"
+#include "calibration.h"
+#include "thermistors.h"
+#include "tmp235.h"
+#include "heaters.h"
+#include "heater_budget.h"
+#include "profile.h"
+#include "config_store.h"
+#include "assert.h"
+#include "error_log.h"
+#include "main.h"
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tuk/debug/print.h"
+
+#define NUM_WELLS 16
+#define MODEL_SHIFT 24     // A, and the matrices derived from it, are Q24.
+#define DUTY_SHIFT 10      // duties are Q10.
+#define DUTY_MAX (1 << DUTY_SHIFT)
+#define B_SHIFT 8          // B, and the gains derived from it, are in 1/256ths of a hundredth of a degree.
+#define HORIZON_DOUBLINGS 6 // the horizon is 2^6 = 64 periods.
+
+static const uint32_t SOLVER_ITERATIONS = 4; // Gauss-Seidel sweeps per step. each is 256 MACs.
+static const uint32_t MAX_PREDICTED_STEPS = 30; // steps a regulated well can go unread before its heater is cut.
+static const int32_t OFFSET_DIVISOR = 64;        // how slowly the offsets follow the prediction error.
+static const int32_t OFFSET_MAX = DUTY_MAX / 2;
+
+static const int32_t A[NUM_WELLS][NUM_WELLS] = TCS_MODEL_A;
+static const int32_t B[NUM_WELLS] = TCS_MODEL_B;
+
+static int16_t s_setpoints[] = {
+		TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF,
+		TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF,
+		TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF,
+		TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF, TCS_SETPOINT_OFF,
+};
+
+static int32_t s_free[NUM_WELLS][NUM_WELLS]; // A^H. where the wells drift with the heaters off. Q24.
+static int32_t s_gain[NUM_WELLS][NUM_WELLS]; // (A^0 + .. + A^(H-1)) B. rise of well i at the horizon from full duty on heater j.
+static int32_t s_inverse_gain[NUM_WELLS];    // 2^(DUTY_SHIFT + B_SHIFT + 16) / s_gain[i][i].
+static bool s_ready = false;
+
+static int32_t s_excess[NUM_WELLS];      // temperature above ambient, in hundredths of a degree.
+static uint8_t s_predicted[NUM_WELLS];   // steps since each well was last read. UINT8_MAX if never.
+static bool s_has_ambient = false;
+static int16_t s_ambient;                // in hundredths of a degree.
+static uint16_t s_duties[NUM_WELLS];     // Q10.
+static int32_t s_offsets[NUM_WELLS];     // heat the model misses, as a duty of each heater. Q10.
+static uint16_t s_starts[NUM_WELLS];     // start of each heater's on-time within the period, in ms.
+static uint16_t s_regulated = 0;         // wells regulated in the current period.
+static uint16_t s_outputs = 0;           // heaters switched on by the TCS.
+static uint32_t s_period_start = 0;      // HAL tick.
+
+static uint32_t s_last_cycles = 0;       // to compute the last step, excluding reads.
+static uint32_t s_worst_cycles = 0;
+
+static void multiply(int32_t out[NUM_WELLS][NUM_WELLS], const int32_t a[NUM_WELLS][NUM_WELLS],
+		const int32_t b[NUM_WELLS][NUM_WELLS]);
+static void sample(bool may_sample);
+static void step();
+static void limit_power(uint16_t regulated, uint16_t manual);
+static void schedule();
+static void drive(uint32_t phase);
+
+#define PRINT_SUBJECT "TCS"
+
+bool TCS_Set_Setpoint(WellID well_id, int16_t setpoint)
+{
+	ASSERT(WELL_0 <= well_id && well_id <= WELL_15, "invalid well id: %d.", well_id);
+
+	if (well_id < WELL_0 || well_id > WELL_15)
+	{
+		PRINT_ERROR("invalid well id: %d.", well_id);
+		Error_Log_Put(ERROR_INVALID_WELL_ID, well_id);
+		return false;
+	}
+
+	s_setpoints[well_id] = setpoint;
+
+	// the setpoint is in use even if it couldn't be saved.
+	Config_Set(CONFIG_KEY_SETPOINTS, s_setpoints, sizeof(s_setpoints));
+
+	return true;
+}
+
+int16_t TCS_Get_Setpoint(WellID well_id)
+{
+	if (well_id < WELL_0 || well_id > WELL_15)
+		return TCS_SETPOINT_OFF;
+
+	return s_setpoints[well_id];
+}
+
+void TCS_Init()
+{
+	static int32_t s_scratch[NUM_WELLS][NUM_WELLS];
+
+	Profile_Init();
+
+	int16_t setpoints[NUM_WELLS];
+	if (Config_Get(CONFIG_KEY_SETPOINTS, setpoints, sizeof(setpoints)) == sizeof(setpoints))
+	{
+		memcpy(s_setpoints, setpoints, sizeof(s_setpoints));
+	}
+
+	// with P = A^n and S = A^0 + .. + A^(n-1), S + P S and P P are the
+	// same sums for 2n, so the horizon takes a few products to reach.
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		for (int j = 0; j < NUM_WELLS; j++)
+		{
+			s_free[i][j] = A[i][j];
+			s_gain[i][j] = i == j ? 1 << MODEL_SHIFT : 0;
+		}
+	}
+
+	for (int n = 0; n < HORIZON_DOUBLINGS; n++)
+	{
+		multiply(s_scratch, s_free, s_gain);
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			for (int j = 0; j < NUM_WELLS; j++)
+				s_gain[i][j] += s_scratch[i][j];
+		}
+
+		multiply(s_scratch, s_free, s_free);
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			for (int j = 0; j < NUM_WELLS; j++)
+				s_free[i][j] = s_scratch[i][j];
+		}
+	}
+
+	// scale each column by its heater.
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		for (int j = 0; j < NUM_WELLS; j++)
+			s_gain[i][j] = ((int64_t)s_gain[i][j] * B[j]) >> MODEL_SHIFT;
+	}
+
+	s_ready = true;
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (s_gain[i][i] <= 0)
+		{
+			PRINT_ERROR("heater %d has no effect in the model. Regulation is disabled.", i);
+			s_ready = false;
+			continue;
+		}
+
+		s_inverse_gain[i] = (int32_t)((1LL << (DUTY_SHIFT + B_SHIFT + 16)) / s_gain[i][i]);
+	}
+
+	// no well has been read yet. the first reading seeds its state rather
+	// than being compared against a prediction from nothing, which would
+	// drive the offset of a well that is already warm to its limit.
+	memset(s_predicted, UINT8_MAX, sizeof(s_predicted));
+
+	s_period_start = HAL_GetTick();
+}
+
+void TCS_Update(bool may_sample)
+{
+	uint32_t now = HAL_GetTick();
+
+	if (now - s_period_start >= TCS_MODEL_PERIOD)
+	{
+		// skip periods that were missed rather than running them back to back.
+		s_period_start = now - (now - s_period_start) % TCS_MODEL_PERIOD;
+
+		sample(may_sample);
+
+		uint32_t start = Profile_Cycles();
+		step();
+		schedule();
+
+		s_last_cycles = Profile_Cycles() - start;
+		if (s_last_cycles > s_worst_cycles)
+			s_worst_cycles = s_last_cycles;
+	}
+
+	drive(now - s_period_start);
+}
+
+void TCS_Print_Stats()
+{
+	PRINT_INFO("ambient: %d, regulated: 0x%04X, heaters on: 0x%04X", s_ambient, s_regulated, s_outputs);
+
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (!(s_regulated & (1 << i)))
+			continue;
+
+		PRINT_INFO("  well %2d: %5ld / %5d, duty %4u/1024, predicted for %u steps",
+				i, s_excess[i] + s_ambient, s_setpoints[i], s_duties[i], s_predicted[i]);
+	}
+
+	PRINT_INFO("last step took %lu cycles, worst: %lu cycles", s_last_cycles, s_worst_cycles);
+}
+
+/**
+ * @brief Multiplies two Q24 matrices.
+ */
+static void multiply(int32_t out[NUM_WELLS][NUM_WELLS], const int32_t a[NUM_WELLS][NUM_WELLS],
+		const int32_t b[NUM_WELLS][NUM_WELLS])
+{
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		for (int j = 0; j < NUM_WELLS; j++)
+		{
+			int64_t sum = 1 << (MODEL_SHIFT - 1);
+			for (int k = 0; k < NUM_WELLS; k++)
+				sum += (int64_t)a[i][k] * b[k][j];
+
+			out[i][j] = (int32_t)(sum >> MODEL_SHIFT);
+		}
+	}
+}
+
+/**
+ * @brief Updates the state with fresh readings where there are any, and
+ *        with the model's prediction from the last step elsewhere.
+ */
+static void sample(bool may_sample)
+{
+	// one step of the model, from the last state and duties. in 1/256ths of a
+	// hundredth of a degree, as a step is only a few hundredths.
+	int32_t predicted[NUM_WELLS];
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		int64_t sum = (int64_t)B[i] * (s_duties[i] + s_offsets[i]) << (MODEL_SHIFT - DUTY_SHIFT);
+		for (int j = 0; j < NUM_WELLS; j++)
+			sum += (int64_t)A[i][j] * s_excess[j] << B_SHIFT;
+
+		predicted[i] = (int32_t)(sum >> MODEL_SHIFT);
+	}
+
+	uint16_t ambient_raw;
+	if (may_sample && TMP235_Read_Temp(&ambient_raw))
+	{
+		int16_t ambient = TMP235_To_Centidegrees(ambient_raw);
+
+		// keep the wells where they are while ambient moves under them.
+		if (s_has_ambient)
+		{
+			for (int i = 0; i < NUM_WELLS; i++)
+				predicted[i] -= (ambient - s_ambient) << B_SHIFT;
+		}
+
+		s_ambient = ambient;
+		s_has_ambient = true;
+	}
+
+	uint16_t quarantined = Sensor_Health_Get_Quarantined(SENSOR_THERMISTOR);
+
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		uint16_t raw;
+		if (may_sample && s_has_ambient && !(quarantined & (1 << i))
+		 && Sensors_Read(SENSOR_THERMISTOR, i, &raw))
+		{
+			raw = Calibration_Apply_One(SENSOR_THERMISTOR, i, raw);
+			s_excess[i] = Thermistors_To_Centidegrees(raw) - s_ambient;
+
+			// whatever the model keeps missing (a wrong gain, a draught) is
+			// taken as an offset on the heater, so it is regulated out.
+			if (s_predicted[i] == 0)
+			{
+				int32_t offset = s_offsets[i] + (((s_excess[i] << B_SHIFT) - predicted[i]) << DUTY_SHIFT) / (B[i] * OFFSET_DIVISOR);
+				s_offsets[i] = offset < -OFFSET_MAX ? -OFFSET_MAX : offset > OFFSET_MAX ? OFFSET_MAX : offset;
+			}
+
+			s_predicted[i] = 0;
+		}
+		else
+		{
+			s_excess[i] = (predicted[i] + (1 << (B_SHIFT - 1))) >> B_SHIFT;
+			if (s_predicted[i] < UINT8_MAX)
+				s_predicted[i]++;
+		}
+	}
+}
+
+/**
+ * @brief Picks the duty of each regulated heater.
+ *
+ * The duties are held over the horizon, so the predicted excess of well i
+ * at its end is free[i] + sum over j of gain[i][j] duty[j]. Setting that to
+ * each setpoint gives a linear system that is dominated by its diagonal,
+ * which a few sweeps of Gauss-Seidel, clamping each duty to [0, 1], settle.
+ * The offsets are held over the horizon too. The work is fixed: 512 MACs
+ * for the free response and the offsets, and 256 per sweep.
+ */
+static void step()
+{
+	uint16_t regulated = 0;
+	if (s_ready && s_has_ambient)
+	{
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			if (s_setpoints[i] != TCS_SETPOINT_OFF && s_predicted[i] <= MAX_PREDICTED_STEPS)
+				regulated |= 1 << i;
+		}
+	}
+
+	// heaters that aren't regulated keep whatever they were set to, and
+	// count as fixed duties. regulated ones start from their last duty.
+	uint16_t manual = Heaters_Get_All() & ~s_outputs;
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (!(regulated & (1 << i)))
+			s_duties[i] = (manual & (1 << i)) ? DUTY_MAX : 0;
+	}
+
+	int32_t targets[NUM_WELLS];
+
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (!(regulated & (1 << i)))
+			continue;
+
+		int64_t sum = 0;
+		int64_t offsets = 0;
+		for (int j = 0; j < NUM_WELLS; j++)
+		{
+			sum += (int64_t)s_free[i][j] * s_excess[j];
+			offsets += (int64_t)s_gain[i][j] * s_offsets[j];
+		}
+
+		targets[i] = (s_setpoints[i] - s_ambient) - (int32_t)(sum >> MODEL_SHIFT)
+				- (int32_t)(offsets >> (B_SHIFT + DUTY_SHIFT));
+	}
+
+	for (uint32_t n = 0; n < SOLVER_ITERATIONS; n++)
+	{
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			if (!(regulated & (1 << i)))
+				continue;
+
+			// what the other heaters already give well i.
+			int64_t others = 0;
+			for (int j = 0; j < NUM_WELLS; j++)
+			{
+				if (j != i)
+					others += (int64_t)s_gain[i][j] * s_duties[j];
+			}
+
+			int32_t needed = targets[i] - (int32_t)(others >> (B_SHIFT + DUTY_SHIFT));
+			int32_t duty = (int32_t)(((int64_t)needed * s_inverse_gain[i]) >> 16);
+
+			s_duties[i] = duty < 0 ? 0 : duty > DUTY_MAX ? DUTY_MAX : duty;
+		}
+	}
+
+	limit_power(regulated, manual & ~regulated);
+
+	s_regulated = regulated;
+}
+
+/**
+ * @brief Keeps the total duty of the regulated heaters within what the heater
+ *        budget leaves after the manual ones, cutting the lowest ranked first.
+ *
+ * As schedule() lays the on-times end to end, a total duty of n heaters
+ * never has more than n on at once.
+ */
+static void limit_power(uint16_t regulated, uint16_t manual)
+{
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		int32_t error = (regulated & (1 << i)) ? s_setpoints[i] - (s_ambient + s_excess[i]) : 0;
+		if (error > INT16_MAX)
+			error = INT16_MAX;
+		else if (error < INT16_MIN)
+			error = INT16_MIN;
+		Heater_Budget_Set_Error(i, error);
+	}
+
+	int32_t available = ((int32_t)Heater_Budget_Get_Max_Heaters() - __builtin_popcount(manual)) * DUTY_MAX;
+	int32_t total = 0;
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (regulated & (1 << i))
+			total += s_duties[i];
+	}
+
+	while (total > available && total > 0)
+	{
+		int lowest = -1;
+		for (int i = 0; i < NUM_WELLS; i++)
+		{
+			if ((regulated & (1 << i)) && s_duties[i] != 0
+			 && (lowest < 0 || Heater_Budget_Get_Rank(i) <= Heater_Budget_Get_Rank(lowest)))
+				lowest = i;
+		}
+
+		int32_t cut = total - available < s_duties[lowest] ? total - available : s_duties[lowest];
+		s_duties[lowest] -= cut;
+		total -= cut;
+	}
+}
+
+/**
+ * @brief Lays the on-times of the regulated heaters end to end around the
+ *        period, so at most the total duty, rounded up, are on at once.
+ */
+static void schedule()
+{
+	uint32_t offset = 0;
+
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (!(s_regulated & (1 << i)))
+			continue;
+
+		s_starts[i] = offset;
+		offset = (offset + ((s_duties[i] * TCS_MODEL_PERIOD) >> DUTY_SHIFT)) % TCS_MODEL_PERIOD;
+	}
+}
+
+/**
+ * @brief Switches the regulated heaters that should be on at this point of
+ *        the period.
+ *
+ * @param phase	ms since the start of the period.
+ */
+static void drive(uint32_t phase)
+{
+	uint16_t outputs = 0;
+
+	for (int i = 0; i < NUM_WELLS; i++)
+	{
+		if (!(s_regulated & (1 << i)))
+			continue;
+
+		uint32_t on_time = (s_duties[i] * TCS_MODEL_PERIOD) >> DUTY_SHIFT;
+		uint32_t since_start = (phase + TCS_MODEL_PERIOD - s_starts[i]) % TCS_MODEL_PERIOD;
+
+		if (since_start < on_time)
+			outputs |= 1 << i;
+	}
+
+	// heaters of wells that just left regulation are switched off here too.
+	// the heaters the budget held off last time are still asked for, so
+	// they aren't rewritten on every call.
+	uint16_t heaters = (Heaters_Get_All() & ~(s_regulated | s_outputs)) | outputs;
+	if (heaters == (Heaters_Get_All() | Heater_Budget_Get_Held()))
+	{
+		s_outputs = outputs;
+		return;
+	}
+
+	if (Heaters_Set_All(heaters))
+		s_outputs = outputs;
+}
@@ -7,80 +7,37 @@
 
 #include "thermistors.h"
 #include "well_id.h"
-#include "mux_adc_location.h"
-#include "tca9548.h"
+#include "sensors.h"
 #include "assert.h"
+#include "pp.h"
 #include "tuk/tuk.h"
 
 // remove later
 #include "power.h"
 #include "tca9539.h"
 
-#include "i2c.h"
-
 #include <stdint.h>
 #include <stdbool.h>
 
-static const uint32_t TIMEOUT = 100; // in ms
-
-static const uint16_t ADC_MAX_OUTPUT = 4095;
+#define CURVE_SHIFT 7 // the curve has a point every 128 counts.
 
-static const MuxADCLocation ADC_LOCATIONS[] = {
-		{ MUX_CHANNEL_3, ADC_A0 }, // THERM 0
-		{ MUX_CHANNEL_3, ADC_A1 }, // THERM 1
-		{ MUX_CHANNEL_3, ADC_A2 }, // THERM 2
-		{ MUX_CHANNEL_3, ADC_A4 }, // THERM 3
-		{ MUX_CHANNEL_3, ADC_A5 }, // THERM 4
-		{ MUX_CHANNEL_3, ADC_A6 }, // THERM 5
-		{ MUX_CHANNEL_3, ADC_A7 }, // THERM 6
-		{ MUX_CHANNEL_5, ADC_A0 }, // THERM 7
-		{ MUX_CHANNEL_0, ADC_A0 }, // THERM 8
-		{ MUX_CHANNEL_0, ADC_A1 }, // THERM 9
-		{ MUX_CHANNEL_0, ADC_A2 }, // THERM 10
-		{ MUX_CHANNEL_0, ADC_A4 }, // THERM 11
-		{ MUX_CHANNEL_0, ADC_A5 }, // THERM 12
-		{ MUX_CHANNEL_0, ADC_A6 }, // THERM 13
-		{ MUX_CHANNEL_0, ADC_A7 }, // THERM 14
-		{ MUX_CHANNEL_2, ADC_A0 }, // THERM 15
+// nominal curve of a 10k, B = 3950 NTC to ground under a 10k pull-up to the
+// ADC reference, in hundredths of a degree. the ends are clamped.
+static const int16_t CURVE[] = {
+		15000, 12932, 10160, 8661, 7633, 6849, 6211, 5669,
+		5196, 4772, 4387, 4030, 3696, 3379, 3077, 2784,
+		2500, 2221, 1945, 1670, 1393, 1113, 825, 528,
+		217, -114, -471, -867, -1318, -1859, -2560, -3637,
+		-5500,
 };
 
+CASSERT(sizeof(CURVE) / sizeof(CURVE[0]) == (4096 >> CURVE_SHIFT) + 1, thermistors)
+
 #define PRINT_SUBJECT "Thermistors"
 
 bool Thermistors_Get_Temp(WellID well_id, uint16_t *out)
 {
-	ASSERT(WELL_0 <= well_id && well_id <= WELL_15, "invalid well id: %d.", well_id);
-
-	if (well_id < WELL_0 || well_id > WELL_15)
-	{
-		PRINT_ERROR("invalid well id: %d.", well_id);
-		//PUT_ERROR(ERR_PLD_INVALID_WELL_ID);
-		return false;
-	}
-
-	if (!TCA9548_Set_I2C_Channel(ADC_LOCATIONS[well_id].channel))
-	{
-		PRINT_ERROR("failed to read temperature in well %d: could not switch channel.", well_id);
-		//PUT_ERROR(ERR_PLD_TCA9548_SET_CHANNEL);
-		return false;
-	}
-
-	uint8_t data[2];
-	HAL_StatusTypeDef status;
-	status = HAL_I2C_Master_Receive(&hi2c1,
-			ADC_LOCATIONS[well_id].address, data, sizeof(data), TIMEOUT);
-
-	if (status != HAL_OK)
-	{
-		PRINT_ERROR("failed to read temperature in well %d. (HAL error code: %d)", well_id, status);
-		//PUT_ERROR(ERR_I2C_RECEIVE, status);
-		return false;
-	}
-
-	uint16_t temp = BE_To_Native_16(data); // convert from BE to LE.
-
-	*out = temp;
-
-	return true;
+	return Sensors_Read(SENSOR_THERMISTOR, well_id, out);
 }
 
 bool Thermistors_Get_Temp_Celsius(WellID well_id, double *out)
@@ -90,7 +47,21 @@ bool Thermistors_Get_Temp_Celsius(WellID well_id, double *out)
 	uint16_t adc_value;
 	success = Thermistors_Get_Temp(well_id, &adc_value);
 
-	double normalised_value = (double)adc_value / (double)ADC_MAX_OUTPUT;
+	if (success)
+		*out = Thermistors_To_Centidegrees(adc_value) / 100.0;
 
 	return success;
 }
+
+int16_t Thermistors_To_Centidegrees(uint16_t raw)
+{
+	if (raw > 4095)
+		raw = 4095;
+
+	// interpolate between the two nearest points.
+	uint32_t index = raw >> CURVE_SHIFT;
+	int32_t fraction = raw & ((1 << CURVE_SHIFT) - 1);
+	int32_t step = CURVE[index + 1] - CURVE[index];
+
+	return (int16_t)(CURVE[index] + step * fraction / (1 << CURVE_SHIFT));
+}
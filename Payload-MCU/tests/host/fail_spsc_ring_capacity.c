@@ -0,0 +1,16 @@
+/*
+ * fail_spsc_ring_capacity.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Must not compile: a ring's capacity has to be a power of two.
+ */
+
+#include "spsc_ring.h"
+
+static SPSC_RING(uint32_t, 6) s_ring;
+
+int main()
+{
+	return SPSC_RING_COUNT(&s_ring);
+}
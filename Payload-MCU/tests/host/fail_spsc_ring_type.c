@@ -0,0 +1,17 @@
+/*
+ * fail_spsc_ring_type.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Must not compile: items pushed must be of the ring's element type.
+ */
+
+#include "spsc_ring.h"
+
+static SPSC_RING(uint32_t, 8) s_ring;
+
+int main()
+{
+	uint16_t item = 0;
+	return SPSC_RING_PUSH(&s_ring, &item, 1);
+}
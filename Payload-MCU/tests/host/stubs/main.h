@@ -0,0 +1,84 @@
+/*
+ * main.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Stands in for the firmware's main.h in host tests. Provides host
+ *           versions of the CMSIS DSP intrinsics used by sensor_math.c, written
+ *           from their definitions in the ARMv7-M Architecture Reference Manual.
+ *           Tests that need the HAL tick define HAL_GetTick.
+ */
+
+#ifndef HOST_MAIN_H_
+#define HOST_MAIN_H_
+
+#include <stdint.h>
+#include <string.h>
+
+uint32_t HAL_GetTick();
+
+// the GE flags set by the last __USUB16, one per halfword.
+static int s_ge[2];
+
+static inline int32_t saturate16(int32_t value)
+{
+	return value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value;
+}
+
+static inline uint32_t __SMUAD(uint32_t a, uint32_t b)
+{
+	return (uint32_t)((int16_t)a * (int16_t)b + (int16_t)(a >> 16) * (int16_t)(b >> 16));
+}
+
+static inline uint32_t __PKHBT(uint32_t a, uint32_t b, int shift)
+{
+	return (a & 0xFFFF) | ((b << shift) & 0xFFFF0000);
+}
+
+static inline uint32_t __QADD16(uint32_t a, uint32_t b)
+{
+	return (uint16_t)saturate16((int16_t)a + (int16_t)b)
+		| (uint32_t)(uint16_t)saturate16((int16_t)(a >> 16) + (int16_t)(b >> 16)) << 16;
+}
+
+static inline uint32_t __QSUB16(uint32_t a, uint32_t b)
+{
+	return (uint16_t)saturate16((int16_t)a - (int16_t)b)
+		| (uint32_t)(uint16_t)saturate16((int16_t)(a >> 16) - (int16_t)(b >> 16)) << 16;
+}
+
+static inline uint32_t __UQADD16(uint32_t a, uint32_t b)
+{
+	uint32_t low = (a & 0xFFFF) + (b & 0xFFFF);
+	uint32_t high = (a >> 16) + (b >> 16);
+	return (low > UINT16_MAX ? UINT16_MAX : low) | (high > UINT16_MAX ? UINT16_MAX : high) << 16;
+}
+
+static inline uint32_t __USAT16(uint32_t a, int bits)
+{
+	int32_t max = (1 << bits) - 1;
+	int32_t low = (int16_t)a;
+	int32_t high = (int16_t)(a >> 16);
+	low = low < 0 ? 0 : low > max ? max : low;
+	high = high < 0 ? 0 : high > max ? max : high;
+	return (uint32_t)low | (uint32_t)high << 16;
+}
+
+static inline uint32_t __USUB16(uint32_t a, uint32_t b)
+{
+	int32_t low = (int32_t)(a & 0xFFFF) - (int32_t)(b & 0xFFFF);
+	int32_t high = (int32_t)(a >> 16) - (int32_t)(b >> 16);
+	s_ge[0] = low >= 0;
+	s_ge[1] = high >= 0;
+	return (uint16_t)low | (uint32_t)(uint16_t)high << 16;
+}
+
+static inline uint32_t __SEL(uint32_t a, uint32_t b)
+{
+	return ((s_ge[0] ? a : b) & 0xFFFF) | ((s_ge[1] ? a : b) & 0xFFFF0000);
+}
+
+#define __UNALIGNED_UINT32_READ(address) ({ uint32_t v; memcpy(&v, (address), 4); v; })
+#define __UNALIGNED_UINT32_WRITE(address, value) do { uint32_t v = (value); memcpy((address), &v, 4); } while (0)
+
+#endif /* HOST_MAIN_H_ */
@@ -0,0 +1,18 @@
+/*
+ * profile.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Stands in for the firmware's profile.h in host tests. There is
+ *           no cycle counter, so every count is 0.
+ */
+
+#ifndef HOST_PROFILE_H_
+#define HOST_PROFILE_H_
+
+#include <stdint.h>
+
+static inline void Profile_Init() {}
+static inline uint32_t Profile_Cycles() { return 0; }
+
+#endif /* HOST_PROFILE_H_ */
@@ -0,0 +1,17 @@
+/*
+ * print.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Stands in for the debug logger in host tests, printing to stdout.
+ */
+
+#ifndef HOST_PRINT_H_
+#define HOST_PRINT_H_
+
+#include <stdio.h>
+
+#define PRINT_INFO(...) (printf("[" PRINT_SUBJECT "] " __VA_ARGS__), printf("\n"))
+#define PRINT_ERROR(...) (printf("[" PRINT_SUBJECT "] error: " __VA_ARGS__), printf("\n"))
+
+#endif /* HOST_PRINT_H_ */
@@ -0,0 +1,61 @@
+/*
+ * tuk.h
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Stands in for the utilities kit and the CAN wrapper in host
+ *           tests. Tests that send frames define CANWrapper_Transmit.
+ */
+
+#ifndef HOST_TUK_H_
+#define HOST_TUK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tuk/debug/print.h"
+
+// the command IDs that are in the CAN wrapper. the rest are in payload_cmds.h.
+enum {
+	CMD_COMM_RESET = 1,
+	CMD_COMM_SET_TELEMETRY_INTERVAL,
+	CMD_PLD_TEST_LEDS,
+	CMD_PLD_SET_WELL_LED,
+	CMD_PLD_SET_WELL_HEATER,
+	CMD_PLD_SET_SETPOINT,
+	CMD_PLD_GET_WELL_LIGHT,
+	CMD_PLD_GET_WELL_TEMP,
+	CMD_CDH_PROCESS_TELEMETRY_REPORT,
+	CMD_CDH_PROCESS_RUNTIME_ERROR,
+	CMD_CDH_PROCESS_WELL_LIGHT,
+	CMD_CDH_PROCESS_WELL_TEMP,
+};
+
+enum {
+	TEL_WELL_TEMP,
+	TEL_WELL_LUMINOSITY
+};
+
+typedef enum {
+	NODE_CDH,
+	NODE_PAYLOAD
+} NodeID;
+
+typedef enum {
+	CAN_WRAPPER_HAL_OK,
+	CAN_WRAPPER_HAL_BUSY
+} CANWrapper_StatusTypeDef;
+
+typedef struct
+{
+	uint8_t cmd;
+	uint8_t data[7];
+} CANMessage;
+
+#define GET_ARG(msg, index, type) ({ type v; memcpy(&v, &(msg).data[index], sizeof(type)); v; })
+#define SET_ARG(msg, index, type, value) do { type v = (value); memcpy(&(msg).data[index], &v, sizeof(type)); } while (0)
+#define CREATE_TELEMETRY_KEY(type, well_id) ((uint8_t)(((type) << 4) | (well_id)))
+
+CANWrapper_StatusTypeDef CANWrapper_Transmit(NodeID recipient, const CANMessage *msg);
+
+#endif /* HOST_TUK_H_ */
@@ -0,0 +1,330 @@
+/*
+ * test_bulk.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Runs bulk transfers on the host against a stand-in for CDH, over
+ *           a link that loses, reorders and refuses frames.
+ *
+ *  Each run checks that the transfer completes, that CDH ends up with the
+ *  block and a matching CRC, and that no packet is ever sent past the
+ *  window. A run that loses one packet checks it is resent on request,
+ *  before any timeout. The largest block, BULK_MAX_SIZE, is sent too.
+ */
+
+// the window is checked against the sender's state, so the sources are
+// included. there is no CRC peripheral on the host.
+#include "crc.c"
+#include "bulk.c"
+
+#include <stdio.h>
+
+#define MAX_IN_FLIGHT 64           // frames the link holds before it refuses more.
+#define MAX_TICKS 10000000         // a transfer that takes longer has stalled.
+#define CDH_ACK_EVERY 8            // CDH acknowledges after this many frames...
+#define CDH_ACK_IDLE 50            // ...or after this many ms without one.
+
+// a direction of the link.
+typedef struct
+{
+	CANMessage frames[MAX_IN_FLIGHT];
+	uint32_t count;
+} Link;
+
+typedef struct
+{
+	uint32_t loss_permille;    // of frames dropped each way.
+	uint32_t busy_permille;    // of transmits refused, to be retried.
+	bool reorder;
+	int32_t drop_packet;       // a data packet dropped the first time only. -1 for none.
+} LinkConfig;
+
+// what CDH has received of the transfer.
+typedef struct
+{
+	uint8_t id;
+	bool started;
+	uint32_t size;
+	uint32_t num_packets;
+	bool received[BULK_MAX_SIZE / BULK_PACKET_SIZE];
+	bool end_received;
+	uint32_t crc;
+	uint32_t frames_since_ack;
+	uint32_t last_ack;
+	uint32_t duplicates;
+	uint32_t duplicate_packet;  // the last packet received twice.
+} Cdh;
+
+static uint32_t s_now = 0;
+static LinkConfig s_config;
+static Link s_to_cdh;
+static Link s_to_payload;
+static Cdh s_cdh;
+static uint8_t s_received_data[BULK_MAX_SIZE];
+static uint32_t s_window_violations = 0;
+static uint32_t s_seed = 0x2545F491;
+
+uint32_t HAL_GetTick()
+{
+	return s_now;
+}
+
+void Error_Log_Put(ErrorID id, uint32_t arg)
+{
+	printf("error %d logged, arg %u.\n", id, arg);
+}
+
+static uint32_t next_random()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static bool chance(uint32_t permille)
+{
+	return next_random() % 1000 < permille;
+}
+
+static void link_push(Link *link, const CANMessage *msg)
+{
+	if (chance(s_config.loss_permille))
+		return;
+
+	link->frames[link->count++] = *msg;
+}
+
+/**
+ * @brief Takes a frame off the link, the oldest one unless reordering.
+ */
+static bool link_pop(Link *link, CANMessage *msg)
+{
+	if (link->count == 0)
+		return false;
+
+	uint32_t index = s_config.reorder ? next_random() % link->count : 0;
+	*msg = link->frames[index];
+	memmove(&link->frames[index], &link->frames[index + 1], (link->count - index - 1) * sizeof(CANMessage));
+	link->count--;
+
+	return true;
+}
+
+CANWrapper_StatusTypeDef CANWrapper_Transmit(NodeID recipient, const CANMessage *msg)
+{
+	if (s_to_cdh.count == MAX_IN_FLIGHT || chance(s_config.busy_permille))
+		return CAN_WRAPPER_HAL_BUSY;
+
+	if (msg->cmd == CMD_CDH_PROCESS_BULK_DATA)
+	{
+		uint16_t packet = GET_ARG(*msg, 1, uint16_t);
+		if (packet >= s_acked + BULK_WINDOW)
+			s_window_violations++;
+
+		if (packet == s_config.drop_packet)
+		{
+			s_config.drop_packet = -1;
+			return CAN_WRAPPER_HAL_OK;
+		}
+	}
+
+	link_push(&s_to_cdh, msg);
+	return CAN_WRAPPER_HAL_OK;
+}
+
+/**
+ * @brief Acknowledges as CDH: the first packet missing, and a request for
+ *        any after it that are missing below the newest received.
+ */
+static void cdh_ack()
+{
+	uint32_t next = 0;
+	while (next < s_cdh.num_packets && s_cdh.received[next])
+		next++;
+
+	uint32_t newest = next;
+	for (uint32_t packet = next; packet < s_cdh.num_packets; packet++)
+	{
+		if (s_cdh.received[packet])
+			newest = packet;
+	}
+
+	uint32_t resend = 0;
+	for (uint32_t n = 0; n < 32 && next + n < newest; n++)
+	{
+		if (!s_cdh.received[next + n])
+			resend |= 1UL << n;
+	}
+
+	// the end frame is acknowledged once the block checks out.
+	if (next == s_cdh.num_packets && s_cdh.end_received
+	 && s_cdh.crc == CRC_Compute_Software(s_received_data, s_cdh.size))
+	{
+		next++;
+	}
+
+	CANMessage msg;
+	msg.cmd = CMD_PLD_BULK_ACK;
+	SET_ARG(msg, 0, uint8_t, s_cdh.id);
+	SET_ARG(msg, 1, uint16_t, (uint16_t)next);
+	SET_ARG(msg, 3, uint32_t, resend);
+	link_push(&s_to_payload, &msg);
+
+	s_cdh.frames_since_ack = 0;
+	s_cdh.last_ack = s_now;
+}
+
+static void cdh_receive(const CANMessage *msg)
+{
+	uint8_t id = GET_ARG(*msg, 0, uint8_t);
+
+	if (msg->cmd == CMD_CDH_PROCESS_BULK_START)
+	{
+		if (s_cdh.started && id == s_cdh.id)
+			return; // resent.
+
+		memset(&s_cdh, 0, sizeof(s_cdh));
+		s_cdh.id = id;
+		s_cdh.started = true;
+		s_cdh.size = GET_ARG(*msg, 1, uint32_t);
+		s_cdh.num_packets = (s_cdh.size + BULK_PACKET_SIZE - 1) / BULK_PACKET_SIZE;
+		s_cdh.last_ack = s_now;
+		memset(s_received_data, 0, sizeof(s_received_data));
+		return;
+	}
+
+	if (!s_cdh.started || id != s_cdh.id)
+		return;
+
+	if (msg->cmd == CMD_CDH_PROCESS_BULK_DATA)
+	{
+		uint16_t packet = GET_ARG(*msg, 1, uint16_t);
+		if (packet >= s_cdh.num_packets)
+			return;
+
+		if (s_cdh.received[packet])
+		{
+			s_cdh.duplicates++;
+			s_cdh.duplicate_packet = packet;
+		}
+
+		uint32_t offset = packet * BULK_PACKET_SIZE;
+		uint32_t length = s_cdh.size - offset < BULK_PACKET_SIZE ? s_cdh.size - offset : BULK_PACKET_SIZE;
+		memcpy(&s_received_data[offset], &msg->data[3], length);
+		s_cdh.received[packet] = true;
+	}
+	else if (msg->cmd == CMD_CDH_PROCESS_BULK_END)
+	{
+		s_cdh.crc = GET_ARG(*msg, 1, uint32_t);
+		s_cdh.end_received = true;
+		cdh_ack();
+		return;
+	}
+
+	if (++s_cdh.frames_since_ack >= CDH_ACK_EVERY)
+		cdh_ack();
+}
+
+/**
+ * @brief Sends a block over the link until the transfer ends.
+ *
+ * @return The number of failed checks.
+ */
+static uint32_t run(const char *name, const uint8_t *data, uint32_t size, LinkConfig config)
+{
+	s_config = config;
+	s_to_cdh.count = 0;
+	s_to_payload.count = 0;
+	s_window_violations = 0;
+	memset(&s_cdh, 0, sizeof(s_cdh));
+
+	uint32_t start = s_now;
+	uint32_t failures = 0;
+
+	if (!Bulk_Start(BULK_SOURCE_LOG, data, size))
+	{
+		printf("bulk: %s: didn't start.\n", name);
+		return 1;
+	}
+
+	while (Bulk_Get_Source() != BULK_SOURCE_NONE && s_now - start < MAX_TICKS)
+	{
+		Bulk_Update();
+
+		CANMessage msg;
+		for (int i = 0; i < 8 && link_pop(&s_to_cdh, &msg); i++)
+			cdh_receive(&msg);
+
+		if (s_cdh.started && s_now - s_cdh.last_ack >= CDH_ACK_IDLE)
+			cdh_ack();
+
+		while (link_pop(&s_to_payload, &msg))
+		{
+			Bulk_On_Ack(GET_ARG(msg, 0, uint8_t), GET_ARG(msg, 1, uint16_t), GET_ARG(msg, 3, uint32_t));
+		}
+
+		s_now++;
+	}
+
+	bool complete = Bulk_Get_Source() == BULK_SOURCE_NONE && s_acked == s_num_packets + 1;
+	bool intact = s_cdh.size == size && memcmp(s_received_data, data, size) == 0;
+	bool crc_ok = s_cdh.end_received && s_cdh.crc == CRC_Compute_Software(data, size);
+
+	failures += !complete;
+	failures += !intact;
+	failures += !crc_ok;
+	failures += s_window_violations != 0;
+
+	printf("bulk: %s: %u bytes in %u ms, %u duplicates. %s%s%s%s\n",
+			name, size, s_now - start, s_cdh.duplicates,
+			complete ? "" : "incomplete. ", intact ? "" : "corrupt. ",
+			crc_ok ? "" : "bad crc. ", s_window_violations == 0 ? "" : "window exceeded.");
+
+	Bulk_Cancel(BULK_SOURCE_LOG);
+	return failures;
+}
+
+int main()
+{
+	static uint8_t data[BULK_MAX_SIZE];
+	for (uint32_t i = 0; i < sizeof(data); i++)
+		data[i] = (uint8_t)next_random();
+
+	const LinkConfig clean = { .drop_packet = -1 };
+	const LinkConfig lossy = { .loss_permille = 50, .busy_permille = 50, .reorder = true, .drop_packet = -1 };
+	uint32_t failures = 0;
+
+	failures += run("one byte", data, 1, clean);
+	failures += run("clean", data, 1001, clean);
+
+	// one lost packet is asked for again, well before a timeout.
+	LinkConfig single = clean;
+	single.drop_packet = 5;
+	uint32_t start = s_now;
+	failures += run("one lost packet", data, 1001, single);
+	if (s_cdh.duplicates != 0 || s_now - start >= ACK_TIMEOUT)
+	{
+		printf("bulk: the lost packet wasn't resent on its own, before a timeout.\n");
+		failures++;
+	}
+
+	for (int i = 0; i < 20; i++)
+	{
+		uint32_t size = 1 + next_random() % 4096;
+		failures += run("lossy", data + next_random() % 4, size, lossy);
+	}
+
+	failures += run("largest, clean", data, BULK_MAX_SIZE, clean);
+	failures += run("largest, lossy", data, BULK_MAX_SIZE, lossy);
+
+	if (Bulk_Start(BULK_SOURCE_LOG, data, BULK_MAX_SIZE + 1))
+	{
+		printf("bulk: a block over BULK_MAX_SIZE was accepted.\n");
+		failures++;
+	}
+
+	printf("bulk: %u failures.\n", failures);
+
+	return failures == 0 ? 0 : 1;
+}
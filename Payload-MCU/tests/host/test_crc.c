@@ -0,0 +1,93 @@
+/*
+ * test_crc.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Checks CRC_Compute_Software on the host, against the standard
+ *           CRC-32 check values and a bit-at-a-time reference.
+ *
+ *  CRC_Init takes the software CRC as the reference for the peripheral's
+ *  byte order and final XOR, so it has to be right on its own. Random
+ *  buffers cover every length up to a few words at every alignment.
+ */
+
+// built with CRC_USE_HARDWARE set to 0, so only the software CRC is left.
+#include "crc.c"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_LENGTH 67
+
+static uint32_t s_seed = 0x2545F491;
+
+static uint32_t next_random()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+// the CRC-32 of IEEE 802.3, straight from its definition.
+static uint32_t crc_reference(const uint8_t *bytes, size_t size)
+{
+	uint32_t crc = 0xFFFFFFFF;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		crc ^= bytes[i];
+		for (int bit = 0; bit < 8; bit++)
+			crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+	}
+
+	return ~crc;
+}
+
+static uint32_t check(const char *name, uint32_t actual, uint32_t expected)
+{
+	if (actual == expected)
+		return 0;
+
+	printf("crc: %s is %08X, expected %08X.\n", name, actual, expected);
+	return 1;
+}
+
+int main()
+{
+	uint32_t mismatches = 0;
+
+	const char *digits = "123456789";
+	mismatches += check("\"123456789\"", CRC_Compute_Software(digits, strlen(digits)), 0xCBF43926);
+
+	const char *fox = "The quick brown fox jumps over the lazy dog";
+	mismatches += check("the fox", CRC_Compute_Software(fox, strlen(fox)), 0x414FA339);
+
+	mismatches += check("an empty buffer", CRC_Compute_Software(NULL, 0), 0x00000000);
+
+	uint8_t zero = 0;
+	mismatches += check("a zero byte", CRC_Compute_Software(&zero, 1), 0xD202EF8D);
+
+	uint32_t cases = 0;
+	uint8_t buffer[MAX_LENGTH + 4];
+	for (int round = 0; round < 100; round++)
+	{
+		for (size_t i = 0; i < sizeof(buffer); i++)
+			buffer[i] = (uint8_t)next_random();
+
+		for (size_t offset = 0; offset < 4; offset++)
+		{
+			for (size_t length = 0; length <= MAX_LENGTH; length++)
+			{
+				uint32_t expected = crc_reference(buffer + offset, length);
+				mismatches += CRC_Compute_Software(buffer + offset, length) != expected;
+				mismatches += CRC_Compute(buffer + offset, length) != expected;
+				cases++;
+			}
+		}
+	}
+
+	printf("crc: %u cases, %u mismatches.\n", cases, mismatches);
+
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+/*
+ * test_sensor_math.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Checks the DSP kernels of sensor_math.c against their scalar
+ *           references on the host, on random readings, gains and offsets.
+ *
+ *  The kernels are built with __ARM_FEATURE_DSP, using the host versions of
+ *  the intrinsics in stubs/main.h. Inputs are read from odd addresses, as
+ *  readings inside a snapshot need not be word aligned.
+ */
+
+// the scalar references are static, so the source is included.
+#include "sensor_math.c"
+
+#include <stdio.h>
+
+#define NUM_CASES 200000
+
+static uint32_t s_seed = 0x2545F491;
+
+static uint32_t next_random()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+int main()
+{
+	uint32_t mismatches = 0;
+
+	for (uint32_t n = 0; n < NUM_CASES; n++)
+	{
+		uint16_t a_storage[LANES + 1];
+		uint16_t *a = &a_storage[1];
+		uint16_t b[LANES];
+		int16_t gains[LANES];
+		int16_t offsets[LANES];
+		uint16_t sums[2][LANES];
+
+		for (int i = 0; i < LANES; i++)
+		{
+			a[i] = next_random() & SENSOR_MATH_MAX_READING;
+			b[i] = next_random() & SENSOR_MATH_MAX_READING;
+			gains[i] = next_random() & INT16_MAX;
+			offsets[i] = (int16_t)next_random();
+			sums[0][i] = sums[1][i] = (uint16_t)next_random();
+		}
+
+		// half the cases are close together, to exercise small deadbands.
+		if (n & 1)
+		{
+			for (int i = 0; i < LANES; i++)
+				b[i] = a[i] + next_random() % 9 - 4;
+		}
+
+		uint16_t fast[LANES];
+		uint16_t reference[LANES];
+
+		Sensor_Math_Calibrate(fast, a, gains, offsets);
+		calibrate_scalar(reference, a, gains, offsets);
+		mismatches += memcmp(fast, reference, sizeof(fast)) != 0;
+
+		int16_t fast_deltas[LANES];
+		int16_t reference_deltas[LANES];
+		Sensor_Math_Delta(fast_deltas, a, b);
+		delta_scalar(reference_deltas, a, b);
+		mismatches += memcmp(fast_deltas, reference_deltas, sizeof(fast_deltas)) != 0;
+
+		uint16_t deadband = next_random() % (n & 1 ? 6 : 5000);
+		mismatches += Sensor_Math_Outside(a, b, deadband) != outside_scalar(a, b, deadband);
+		mismatches += Sensor_Math_Outside(a, b, 0) != outside_scalar(a, b, 0);
+
+		Sensor_Math_Accumulate(sums[0], a);
+		accumulate_scalar(sums[1], a);
+		mismatches += memcmp(sums[0], sums[1], sizeof(sums[0])) != 0;
+
+		uint32_t shift = next_random() % 16;
+		Sensor_Math_Average(fast, sums[0], shift);
+		average_scalar(reference, sums[1], shift);
+		mismatches += memcmp(fast, reference, sizeof(fast)) != 0;
+	}
+
+	bool self_test = Sensor_Math_Self_Test();
+
+	printf("sensor math: %u cases, %u mismatches, self test %s.\n",
+			NUM_CASES, mismatches, self_test ? "passed" : "failed");
+
+	return mismatches == 0 && self_test ? 0 : 1;
+}
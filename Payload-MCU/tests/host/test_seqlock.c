@@ -0,0 +1,161 @@
+/*
+ * test_seqlock.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Checks that seqlock.h never hands out a torn value, on the host.
+ *
+ *  The target has one core, so a reader and a writer only overlap when one
+ *  interrupts the other. That is simulated here: the byte copies inside the
+ *  seqlock call back at every byte, and the callback may run a complete
+ *  write or read, as an ISR would, in the middle of the other side's copy.
+ *  Both ways round are covered: the main loop reading under an ISR writer,
+ *  and the main loop writing under an ISR reader.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// called before every byte the seqlock copies. NULL outside of a copy that
+// may be interrupted.
+static void (*s_interrupt)(void);
+
+static void *interruptible_copy(void *destination, const void *source, size_t size)
+{
+	volatile uint8_t *to = destination;
+	const volatile uint8_t *from = source;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (s_interrupt != NULL)
+			s_interrupt();
+		to[i] = from[i];
+	}
+
+	return destination;
+}
+
+#define memcpy interruptible_copy
+#include "seqlock.h"
+#undef memcpy
+
+#define NUM_ROUNDS 200000
+#define ISR_CHANCE 40 // an ISR runs at 1 in this many bytes.
+
+// the size and shape of a sensor snapshot.
+typedef struct
+{
+	uint16_t readings[2][16];
+	uint16_t valid[2];
+	uint32_t timestamp;
+} Snapshot;
+
+static SEQLOCK(Snapshot) s_shared;
+static uint32_t s_next = 1;      // timestamp of the next value written.
+static uint32_t s_last_seen = 0; // newest timestamp the main loop has read.
+
+static uint32_t s_torn = 0;      // values mixed from two writes, or older than one already read.
+static uint32_t s_reads = 0;
+static uint32_t s_retries = 0;
+static uint32_t s_isr_reads = 0;
+static uint32_t s_isr_retries = 0;
+
+// every field of a value is derived from its timestamp, so a torn one shows.
+static void fill(Snapshot *value, uint32_t timestamp)
+{
+	for (int type = 0; type < 2; type++)
+	{
+		for (int i = 0; i < 16; i++)
+			value->readings[type][i] = (uint16_t)(timestamp * 31 + type * 16 + i);
+		value->valid[type] = (uint16_t)timestamp;
+	}
+	value->timestamp = timestamp;
+}
+
+static void check(const Snapshot *value)
+{
+	Snapshot expected;
+	fill(&expected, value->timestamp);
+
+	// the zero initialised value is the only one not written by fill.
+	if (value->timestamp != 0 && memcmp(value, &expected, sizeof(expected)) != 0)
+		s_torn++;
+}
+
+static bool chance()
+{
+	return rand() % ISR_CHANCE == 0;
+}
+
+static void isr_write()
+{
+	if (!chance())
+		return;
+
+	// an ISR runs to completion.
+	void (*interrupt)(void) = s_interrupt;
+	s_interrupt = NULL;
+
+	Snapshot value;
+	fill(&value, s_next++);
+	SEQLOCK_WRITE(&s_shared, &value);
+
+	s_interrupt = interrupt;
+}
+
+static void isr_read()
+{
+	if (!chance())
+		return;
+
+	void (*interrupt)(void) = s_interrupt;
+	s_interrupt = NULL;
+
+	Snapshot value;
+	s_isr_retries += SEQLOCK_READ(&s_shared, &value);
+	s_isr_reads++;
+	check(&value);
+	if (value.timestamp < s_last_seen)
+		s_torn++;
+
+	s_interrupt = interrupt;
+}
+
+int main()
+{
+	srand(12345);
+
+	for (int round = 0; round < NUM_ROUNDS; round++)
+	{
+		Snapshot value;
+
+		if (rand() % 2 == 0)
+		{
+			s_interrupt = isr_write;
+			s_retries += SEQLOCK_READ(&s_shared, &value);
+			s_interrupt = NULL;
+			s_reads++;
+
+			check(&value);
+			if (value.timestamp < s_last_seen)
+				s_torn++;
+			s_last_seen = value.timestamp;
+		}
+		else
+		{
+			fill(&value, s_next++);
+			s_interrupt = isr_read;
+			SEQLOCK_WRITE(&s_shared, &value);
+			s_interrupt = NULL;
+		}
+	}
+
+	printf("seqlock: %u main loop reads (%u retries), %u ISR reads (%u retries), %u torn.\n",
+			s_reads, s_retries, s_isr_reads, s_isr_retries, s_torn);
+
+	// an ISR reader always gets the copy that isn't being written.
+	return s_torn == 0 && s_isr_retries == 0 ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+/*
+ * test_snapshot_codec.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Round-trips synthetic sensor traces through the snapshot codec on
+ *           the host, and reports how well and how fast they compress.
+ *
+ *  Each trace is packed into streams the size of a flash log chunk, as the
+ *  flash log does, and into streams of 100 snapshots, which the codec is
+ *  capable of with a larger buffer. Each full stream is decoded and compared
+ *  bit-exact: timestamps, valid masks and every valid reading. A snapshot
+ *  that doesn't fit must leave the encoder and the stream as they were. Each
+ *  trace also has to compress at least as well as it did when this test was
+ *  written.
+ */
+
+// the chunk size comes from the flash log. the codec itself only needs its
+// own source.
+#include "snapshot_codec.c"
+#include "flash_log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_SNAPSHOTS 20000
+#define CHUNK_DATA_SIZE sizeof(((FlashLogChunk *)0)->data)
+#define LONG_STREAM_RECORDS 100
+#define MAX_STREAM_SIZE (LONG_STREAM_RECORDS * sizeof(SensorSnapshot))
+
+typedef enum {
+	TRACE_DRIFT = 0,      // temperatures creeping, lights steady.
+	TRACE_SWITCHING,      // temperatures cycling, lights switching on and off.
+	TRACE_MISSING,        // slow drift, with wells dropping out at random.
+	TRACE_RAILS,          // readings pinned at either end, and jumps between them.
+	NUM_TRACES
+} Trace;
+
+static const char *NAMES[NUM_TRACES] = { "slow drift", "switching", "missing wells", "rails" };
+
+// compression ratios x100 the traces must reach, in flash log chunks and in
+// streams of 100, a little under what they reached when this test was
+// written. rails are only there to be exact.
+static const uint32_t MIN_CHUNK_RATIOS[NUM_TRACES] = { 360, 180, 225, 0 };
+static const uint32_t MIN_LONG_RATIOS[NUM_TRACES] = { 490, 205, 380, 0 };
+
+static uint32_t s_seed = 0x2545F491;
+
+static uint32_t next_random()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static uint16_t clamp_reading(int32_t reading)
+{
+	return reading < 0 ? 0 : reading > 4095 ? 4095 : reading;
+}
+
+/**
+ * @brief Makes the next snapshot of a trace from the one before.
+ */
+static void next_snapshot(Trace trace, uint32_t n, SensorSnapshot *snapshot)
+{
+	// sweeps a second apart, with some jitter. starts close to a wrap.
+	snapshot->timestamp += 1000000 + next_random() % 64 - 32;
+
+	for (int well = 0; well < 16; well++)
+	{
+		uint16_t *temperature = &snapshot->readings[SENSOR_THERMISTOR][well];
+		uint16_t *light = &snapshot->readings[SENSOR_PHOTOCELL][well];
+
+		switch (trace)
+		{
+		case TRACE_DRIFT:
+		case TRACE_MISSING:
+			*temperature = clamp_reading(*temperature + (int32_t)(next_random() % 3) - 1);
+			*light = clamp_reading(3000 + well * 40 + (int32_t)(next_random() % 5) - 2);
+			break;
+
+		case TRACE_SWITCHING:
+		{
+			// a heater cycling over 4 minutes, and LEDs blinking per well.
+			int32_t phase = (n + well * 15) % 240;
+			int32_t triangle = phase < 120 ? phase : 240 - phase;
+			*temperature = clamp_reading(1800 + triangle * 4 + (int32_t)(next_random() % 7) - 3);
+			bool on = (n / (20 + well)) & 1;
+			*light = clamp_reading((on ? 3500 : 200) + (int32_t)(next_random() % 9) - 4);
+			break;
+		}
+
+		case TRACE_RAILS:
+		{
+			static const uint16_t RAILS[] = { 0, 4095, UINT16_MAX, 1 };
+			*temperature = RAILS[next_random() % 4];
+			*light = next_random() % 8 == 0 ? (uint16_t)next_random() : RAILS[(n + well) % 4];
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		snapshot->valid[type] = 0xFFFF;
+		if (trace == TRACE_MISSING || trace == TRACE_RAILS)
+		{
+			for (int well = 0; well < 16; well++)
+			{
+				if (next_random() % 100 < 3)
+					snapshot->valid[type] &= ~(1 << well);
+			}
+		}
+	}
+}
+
+static bool is_same(const SensorSnapshot *a, const SensorSnapshot *b)
+{
+	if (a->timestamp != b->timestamp || memcmp(a->valid, b->valid, sizeof(a->valid)) != 0)
+		return false;
+
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		for (int well = 0; well < 16; well++)
+		{
+			if ((a->valid[type] & (1 << well)) && a->readings[type][well] != b->readings[type][well])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Decodes a full stream and compares it to the snapshots encoded.
+ *
+ * @return The number of snapshots that didn't match.
+ */
+static uint32_t check_chunk(const uint8_t *data, uint32_t size, const SensorSnapshot *expected, uint32_t count)
+{
+	SnapshotCodec decoder;
+	Snapshot_Codec_Reset(&decoder);
+	BitStream stream = { .data = (uint8_t *)data, .size = size, .position = 0 };
+
+	uint32_t mismatches = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		SensorSnapshot decoded;
+		if (!Snapshot_Codec_Decode(&decoder, &stream, &decoded) || !is_same(&decoded, &expected[i]))
+			mismatches++;
+	}
+
+	return mismatches;
+}
+
+static uint64_t get_nanos()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Runs a trace through the codec, stream by stream.
+ *
+ * @param stream_size	Bytes in a stream.
+ * @param max_records	Snapshots in a stream, if it doesn't fill up first.
+ * @param min_ratio		Compression ratio x100 to reach.
+ * @return				The number of failed checks.
+ */
+static uint32_t run(Trace trace, uint32_t stream_size, uint32_t max_records, uint32_t min_ratio)
+{
+	static SensorSnapshot s_chunk_snapshots[MAX_STREAM_SIZE * 8];
+	static uint8_t data[MAX_STREAM_SIZE];
+	s_seed = 0x2545F491;
+
+	SensorSnapshot snapshot = { .timestamp = UINT32_MAX - 5000000 };
+	for (int well = 0; well < 16; well++)
+		snapshot.readings[SENSOR_THERMISTOR][well] = 1500 + well * 50;
+
+	SnapshotCodec encoder;
+	Snapshot_Codec_Reset(&encoder);
+	BitStream stream = { .data = data, .size = stream_size, .position = 0 };
+	uint32_t count = 0;
+
+	uint32_t failures = 0;
+	uint32_t chunks = 0;
+	uint64_t compressed_bits = 0;
+	uint64_t nanos = 0;
+
+	for (uint32_t n = 0; n <= NUM_SNAPSHOTS; n++)
+	{
+		bool last = n == NUM_SNAPSHOTS;
+		if (!last)
+			next_snapshot(trace, n, &snapshot);
+
+		uint64_t start = get_nanos();
+		SnapshotCodec before = encoder;
+		uint32_t position = stream.position;
+		bool fits = !last && count < max_records && Snapshot_Codec_Encode(&encoder, &snapshot, &stream);
+		nanos += get_nanos() - start;
+
+		if (fits)
+		{
+			s_chunk_snapshots[count++] = snapshot;
+			continue;
+		}
+
+		if (!last && count < max_records && (stream.position != position || memcmp(&before, &encoder, sizeof(encoder)) != 0))
+		{
+			printf("snapshot codec: %s: a snapshot that didn't fit changed the stream.\n", NAMES[trace]);
+			failures++;
+		}
+
+		// the chunk is full. check it, then start the next with this snapshot.
+		uint32_t mismatches = check_chunk(data, stream_size, s_chunk_snapshots, count);
+		if (mismatches != 0)
+		{
+			printf("snapshot codec: %s: %u of %u snapshots in chunk %u decoded wrong.\n",
+					NAMES[trace], mismatches, count, chunks);
+			failures++;
+		}
+
+		compressed_bits += position;
+		chunks++;
+
+		if (last)
+			break;
+
+		Snapshot_Codec_Reset(&encoder);
+		stream.position = 0;
+		count = 0;
+		if (!Snapshot_Codec_Encode(&encoder, &snapshot, &stream))
+		{
+			printf("snapshot codec: %s: a key record doesn't fit an empty chunk.\n", NAMES[trace]);
+			failures++;
+		}
+		s_chunk_snapshots[count++] = snapshot;
+	}
+
+	uint64_t raw_bytes = (uint64_t)NUM_SNAPSHOTS * sizeof(SensorSnapshot);
+	uint32_t ratio = (uint32_t)(raw_bytes * 8 * 100 / compressed_bits);
+
+	printf("snapshot codec: %s: %u snapshots in %u streams of %u bytes, ratio x100: %u, %u ns per snapshot.\n",
+			NAMES[trace], NUM_SNAPSHOTS, chunks, stream_size, ratio, (uint32_t)(nanos / NUM_SNAPSHOTS));
+
+	if (ratio < min_ratio)
+	{
+		printf("snapshot codec: %s: expected a ratio x100 of at least %u.\n", NAMES[trace], min_ratio);
+		failures++;
+	}
+
+	return failures;
+}
+
+int main()
+{
+	uint32_t failures = 0;
+	for (int trace = 0; trace < NUM_TRACES; trace++)
+	{
+		failures += run(trace, CHUNK_DATA_SIZE, UINT32_MAX, MIN_CHUNK_RATIOS[trace]);
+		failures += run(trace, MAX_STREAM_SIZE, LONG_STREAM_RECORDS, MIN_LONG_RATIOS[trace]);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/*
+ * test_spsc_ring.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Checks spsc_ring.h on the host, from two threads at once, and
+ *           across the wrap of its 32-bit counts.
+ *
+ *  The producer pushes and the consumer pops random sized batches of
+ *  numbered items. Each item carries a checksum of its number, so a lost,
+ *  repeated, reordered or half-written item shows up in the consumer.
+ */
+
+// keep the two sides' counts out of each other's cache lines.
+#define SPSC_RING_LINE_SIZE 64
+#include "spsc_ring.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define NUM_ITEMS 2000000u
+
+typedef struct
+{
+	uint32_t number;
+	uint32_t check;
+} Item;
+
+static SPSC_RING(Item, 256) s_ring;
+
+static uint32_t get_check(uint32_t number)
+{
+	return ~number * 2654435761u;
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+	*state = *state * 1103515245 + 12345;
+	return *state >> 16;
+}
+
+static void *produce(void *unused __attribute__((unused)))
+{
+	uint32_t state = 1;
+	uint32_t next = 0;
+
+	while (next < NUM_ITEMS)
+	{
+		Item batch[16];
+		uint32_t count = 1 + next_random(&state) % 16;
+		if (count > NUM_ITEMS - next)
+			count = NUM_ITEMS - next;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			batch[i].number = next + i;
+			batch[i].check = get_check(next + i);
+		}
+
+		// what didn't fit is pushed again, so it isn't really dropped.
+		uint32_t pushed = SPSC_RING_PUSH(&s_ring, batch, count);
+		next += pushed;
+		if (pushed == 0)
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+static uint32_t test_threads()
+{
+	pthread_t producer;
+	pthread_create(&producer, NULL, produce, NULL);
+
+	uint32_t state = 7;
+	uint32_t expected = 0;
+	uint32_t errors = 0;
+
+	while (expected < NUM_ITEMS)
+	{
+		Item batch[32];
+		uint32_t count = SPSC_RING_POP(&s_ring, batch, 1 + next_random(&state) % 32);
+		if (count == 0)
+			sched_yield();
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (batch[i].number != expected || batch[i].check != get_check(expected))
+				errors++;
+			expected++;
+		}
+	}
+
+	pthread_join(producer, NULL);
+
+	printf("spsc ring: %u items across threads, %u errors, high water %u of %u.\n",
+			NUM_ITEMS, errors, s_ring.ring.high_water, (uint32_t)SPSC_RING_CAPACITY(&s_ring));
+
+	return errors;
+}
+
+// pushes and pops of every size, from just before the counts wrap to well
+// after, checking what was pushed, dropped and popped each time.
+static uint32_t test_wrap()
+{
+	static SPSC_RING(uint16_t, 8) ring;
+	ring.ring.head = UINT32_MAX - 20;
+	ring.ring.tail = UINT32_MAX - 20;
+
+	uint16_t next = 0;
+	uint16_t expected = 0;
+	uint32_t errors = 0;
+
+	for (uint32_t n = 0; n < 1000; n++)
+	{
+		uint16_t batch[16];
+		uint32_t count = n % 11;
+		for (uint32_t i = 0; i < count; i++)
+			batch[i] = next + i;
+
+		uint32_t space = SPSC_RING_CAPACITY(&ring) - SPSC_RING_COUNT(&ring);
+		uint32_t dropped = ring.ring.dropped;
+
+		uint32_t pushed = SPSC_RING_PUSH(&ring, batch, count);
+		next += pushed;
+		if (pushed != (count < space ? count : space) || ring.ring.dropped - dropped != count - pushed)
+			errors++;
+
+		uint32_t popped = SPSC_RING_POP(&ring, batch, n % 7);
+		for (uint32_t i = 0; i < popped; i++)
+		{
+			if (batch[i] != expected++)
+				errors++;
+		}
+	}
+
+	printf("spsc ring: wrapped at %u, %u errors.\n", UINT32_MAX, errors);
+
+	return errors;
+}
+
+int main()
+{
+	uint32_t errors = test_wrap();
+	errors += test_threads();
+
+	return errors == 0 ? 0 : 1;
+}
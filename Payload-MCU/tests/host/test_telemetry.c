@@ -0,0 +1,256 @@
+/*
+ * test_telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *
+ *  Purpose: Checks the frames Telemetry_Encode produces on the host, and
+ *           times it.
+ *
+ *  A known snapshot is checked byte for byte, including a sequence number
+ *  wrapping. Random snapshots are checked against reports built one SET_ARG
+ *  at a time, as they were before the frame slots, since the wire format
+ *  didn't change. Encoding a full snapshot is timed.
+ */
+
+// the frame slots are static, so the source is included.
+#include "telemetry.c"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_CASES 20000
+#define NUM_TIMED 200000
+
+static uint16_t s_quarantined[NUM_SENSOR_TYPES];
+static uint16_t s_suspect[NUM_SENSOR_TYPES];
+static HeaterBudgetStats s_budget;
+
+static uint32_t s_seed = 0x2545F491;
+
+uint32_t Timebase_Now()
+{
+	return 0;
+}
+
+uint16_t Sensor_Health_Get_Quarantined(SensorType type)
+{
+	return s_quarantined[type];
+}
+
+uint16_t Sensor_Health_Get_Suspect(SensorType type)
+{
+	return s_suspect[type];
+}
+
+void Heater_Budget_Take_Stats(HeaterBudgetStats *out)
+{
+	*out = s_budget;
+}
+
+static uint32_t next_random()
+{
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static uint64_t get_nanos()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static bool is_frame(const CANMessage *frame, uint8_t cmd, const uint8_t data[7])
+{
+	return frame->cmd == cmd && memcmp(frame->data, data, 7) == 0;
+}
+
+/**
+ * @brief Encodes a known snapshot, and compares every byte.
+ *
+ * @return The number of frames that didn't match.
+ */
+static uint32_t test_known()
+{
+	SensorSnapshot snapshot = { .timestamp = 0x12345678 }; // stamp 0xD159.
+	snapshot.valid[SENSOR_THERMISTOR] = 0x8001;
+	snapshot.readings[SENSOR_THERMISTOR][0] = 0x0ABC;
+	snapshot.readings[SENSOR_THERMISTOR][15] = 0x0123;
+	snapshot.valid[SENSOR_PHOTOCELL] = 0x0004;
+	snapshot.readings[SENSOR_PHOTOCELL][2] = 0x0FFF;
+	snapshot.readings[SENSOR_PHOTOCELL][3] = 0x0777; // not valid, so not sent.
+
+	s_quarantined[SENSOR_THERMISTOR] = 0x4000;
+	s_suspect[SENSOR_THERMISTOR] = 0x0002;
+	s_quarantined[SENSOR_PHOTOCELL] = 0x0000;
+	s_suspect[SENSOR_PHOTOCELL] = 0x8000;
+	s_budget = (HeaterBudgetStats){ .utilisation = 42, .peak = 3, .max = 5, .held = 0x0102 };
+
+	const struct
+	{
+		uint8_t cmd;
+		uint8_t data[7];
+	} EXPECTED[] = {
+			{ CMD_CDH_PROCESS_TELEMETRY_REPORT,
+					{ CREATE_TELEMETRY_KEY(TEL_WELL_TEMP, 0), 255, 0, 0xBC, 0x0A, 0x59, 0xD1 } },
+			{ CMD_CDH_PROCESS_TELEMETRY_REPORT,
+					{ CREATE_TELEMETRY_KEY(TEL_WELL_TEMP, 15), 0, 0, 0x23, 0x01, 0x59, 0xD1 } },
+			{ CMD_CDH_PROCESS_SENSOR_HEALTH, { SENSOR_THERMISTOR, 0x00, 0x40, 0x02, 0x00, 0x59, 0xD1 } },
+			{ CMD_CDH_PROCESS_TELEMETRY_REPORT,
+					{ CREATE_TELEMETRY_KEY(TEL_WELL_LUMINOSITY, 2), 7, 0, 0xFF, 0x0F, 0x59, 0xD1 } },
+			{ CMD_CDH_PROCESS_SENSOR_HEALTH, { SENSOR_PHOTOCELL, 0x00, 0x00, 0x00, 0x80, 0x59, 0xD1 } },
+			{ CMD_CDH_PROCESS_HEATER_BUDGET, { 42, 3, 5, 0x02, 0x01, 0x59, 0xD1 } },
+	};
+	const uint32_t num_expected = sizeof(EXPECTED) / sizeof(EXPECTED[0]);
+
+	uint8_t sequences[NUM_SENSOR_TYPES] = { 255, 7 };
+	CANMessage *frames[TELEMETRY_MAX_FRAMES];
+	uint32_t count = Telemetry_Encode(&snapshot, sequences, frames);
+
+	uint32_t mismatches = 0;
+	if (count != num_expected)
+	{
+		printf("telemetry: %u frames for the known snapshot, expected %u.\n", count, num_expected);
+		mismatches++;
+	}
+
+	for (uint32_t i = 0; i < count && i < num_expected; i++)
+	{
+		if (!is_frame(frames[i], EXPECTED[i].cmd, EXPECTED[i].data))
+		{
+			const uint8_t *d = frames[i]->data;
+			printf("telemetry: frame %u is %02X: %02X %02X %02X %02X %02X %02X %02X.\n",
+					i, frames[i]->cmd, d[0], d[1], d[2], d[3], d[4], d[5], d[6]);
+			mismatches++;
+		}
+	}
+
+	if (sequences[SENSOR_THERMISTOR] != 1 || sequences[SENSOR_PHOTOCELL] != 8)
+	{
+		printf("telemetry: sequences ended at %u and %u, expected 1 and 8.\n",
+				sequences[SENSOR_THERMISTOR], sequences[SENSOR_PHOTOCELL]);
+		mismatches++;
+	}
+
+	return mismatches;
+}
+
+/**
+ * @brief Builds a report the way it was before the frame slots.
+ */
+static void build_report(CANMessage *msg, SensorType type, uint32_t well, uint8_t sequence,
+		uint16_t reading, uint32_t timestamp)
+{
+	msg->cmd = CMD_CDH_PROCESS_TELEMETRY_REPORT;
+	SET_ARG(*msg, 0, uint8_t, CREATE_TELEMETRY_KEY(TELEMETRY_TYPES[type], well));
+	SET_ARG(*msg, 1, uint8_t, sequence);
+	SET_ARG(*msg, 2, uint8_t, 0); // packet #
+	SET_ARG(*msg, 3, uint16_t, reading);
+	SET_ARG(*msg, 5, uint16_t, (uint16_t)(timestamp >> STAMP_SHIFT));
+}
+
+static void random_snapshot(SensorSnapshot *snapshot)
+{
+	snapshot->timestamp = next_random();
+	for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+	{
+		snapshot->valid[type] = (uint16_t)next_random();
+		for (int well = 0; well < 16; well++)
+			snapshot->readings[type][well] = (uint16_t)next_random();
+	}
+}
+
+/**
+ * @brief Compares the reports of random snapshots with ones built field by
+ *        field.
+ *
+ * @return The number of snapshots whose reports didn't match.
+ */
+static uint32_t test_random()
+{
+	uint32_t mismatches = 0;
+
+	for (uint32_t n = 0; n < NUM_CASES; n++)
+	{
+		SensorSnapshot snapshot;
+		random_snapshot(&snapshot);
+
+		uint8_t sequences[NUM_SENSOR_TYPES] = { (uint8_t)next_random(), (uint8_t)next_random() };
+		uint8_t expected_sequences[NUM_SENSOR_TYPES];
+		memcpy(expected_sequences, sequences, sizeof(sequences));
+
+		CANMessage *frames[TELEMETRY_MAX_FRAMES];
+		uint32_t count = Telemetry_Encode(&snapshot, sequences, frames);
+
+		bool same = true;
+		uint32_t index = 0;
+		for (int type = 0; type < NUM_SENSOR_TYPES; type++)
+		{
+			for (uint32_t well = 0; well < 16; well++)
+			{
+				if (!(snapshot.valid[type] & (1 << well)))
+					continue;
+
+				CANMessage expected;
+				build_report(&expected, type, well, expected_sequences[type]++,
+						snapshot.readings[type][well], snapshot.timestamp);
+				if (index >= count || !is_frame(frames[index], expected.cmd, expected.data))
+					same = false;
+				index++;
+			}
+
+			// the health frame.
+			index++;
+		}
+
+		// the budget frame.
+		index++;
+
+		if (!same || index != count || memcmp(sequences, expected_sequences, sizeof(sequences)) != 0)
+			mismatches++;
+	}
+
+	return mismatches;
+}
+
+/**
+ * @brief Times encoding a full snapshot.
+ */
+static void time_encode()
+{
+	SensorSnapshot snapshot;
+	random_snapshot(&snapshot);
+	snapshot.valid[SENSOR_THERMISTOR] = 0xFFFF;
+	snapshot.valid[SENSOR_PHOTOCELL] = 0xFFFF;
+
+	uint8_t sequences[NUM_SENSOR_TYPES] = { 0 };
+	CANMessage *frames[TELEMETRY_MAX_FRAMES];
+	volatile uint32_t sink = 0;
+
+	uint64_t start = get_nanos();
+	for (uint32_t n = 0; n < NUM_TIMED; n++)
+	{
+		snapshot.timestamp = n;
+		sink += Telemetry_Encode(&snapshot, sequences, frames);
+	}
+	uint64_t nanos = get_nanos() - start;
+
+	printf("telemetry: a full snapshot of %u frames takes %u ns to encode.\n",
+			sink / NUM_TIMED, (uint32_t)(nanos / NUM_TIMED));
+}
+
+int main()
+{
+	Telemetry_Init();
+
+	uint32_t failures = test_known();
+	uint32_t mismatches = test_random();
+	printf("telemetry: %u random snapshots, %u mismatches.\n", NUM_CASES, mismatches);
+
+	time_encode();
+
+	return failures + mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+Lists the static RAM footprint of each subsystem from the linker map file.
+
+Usage: memory_report.py <Payload-MCU.map>
+
+Each object file counts as a subsystem, except for the HAL, CMSIS and the
+submodules, which are grouped. The budgets from the linker script are
+checked too, and it exits with 1 if one is exceeded. The linker scripts
+already fail the link in that case; the report runs as the post-build step
+of both build configurations, so the sizes are printed on every build.
+"""
+
+import re
+import sys
+from collections import defaultdict
+
+RAM_SECTIONS = ('.data', '.bss', '.noinit', '.ram2_bss')
+
+GROUPS = (
+    ('STM32L4xx_HAL_Driver', 'hal'),
+    ('CMSIS', 'cmsis'),
+    ('can-wrapper-module', 'can-wrapper'),
+    ('tsat-utilities-kit', 'tuk'),
+)
+
+INPUT_RE = re.compile(r'^ (\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)$')
+SYMBOL_RE = re.compile(r'^\s+0x([0-9a-f]+)\s+(__\w+)\s*=')
+OUTPUT_RE = re.compile(r'^(\.\S+)\s+0x[0-9a-f]+\s+0x[0-9a-f]+')
+
+
+def subsystem(path):
+    for marker, group in GROUPS:
+        if marker in path:
+            return group
+    name = path.replace('\\', '/').split('/')[-1]
+    return re.sub(r'\.o(bj)?$', '', name)
+
+
+def parse(lines):
+    sizes = defaultdict(lambda: defaultdict(int))  # subsystem -> section -> bytes
+    symbols = {}
+    section = None
+    pending = None  # input section name whose address is on the next line
+
+    for line in lines:
+        line = line.rstrip('\n')
+
+        match = OUTPUT_RE.match(line)
+        if match:
+            section = match.group(1)
+            pending = None
+            continue
+
+        match = SYMBOL_RE.match(line)
+        if match:
+            symbols[match.group(2)] = int(match.group(1), 16)
+            continue
+
+        if section not in RAM_SECTIONS:
+            continue
+
+        if re.match(r'^ \S+$', line):
+            pending = line.strip()
+            continue
+
+        match = INPUT_RE.match(line)
+        if match and (match.group(1) or pending) and match.group(1) != '*fill*':
+            sizes[subsystem(match.group(4))][section] += int(match.group(3), 16)
+        pending = None
+
+    return sizes, symbols
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__.strip())
+        return 2
+
+    with open(sys.argv[1]) as file:
+        sizes, symbols = parse(file)
+
+    print(f'{"subsystem":<24}' + ''.join(f'{name:>10}' for name in RAM_SECTIONS) + f'{"total":>10}')
+    totals = defaultdict(int)
+    for name in sorted(sizes, key=lambda name: -sum(sizes[name].values())):
+        row = sizes[name]
+        print(f'{name:<24}' + ''.join(f'{row[s]:>10}' for s in RAM_SECTIONS) + f'{sum(row.values()):>10}')
+        for s in RAM_SECTIONS:
+            totals[s] += row[s]
+    print(f'{"total":<24}' + ''.join(f'{totals[s]:>10}' for s in RAM_SECTIONS) + f'{sum(totals.values()):>10}')
+
+    print()
+    over = False
+    budgets = sorted(name[len('__budget_'):] for name in symbols if name.startswith('__budget_'))
+    for name in budgets:
+        budget = symbols['__budget_' + name]
+        if name == 'ram_static':
+            used = totals['.data'] + totals['.bss'] + totals['.noinit']
+        else:
+            start = symbols.get(f'__{name}_start')
+            end = symbols.get(f'__{name}_end')
+            if start is None or end is None:
+                continue
+            used = end - start
+        flag = 'OVER' if used > budget else ''
+        over |= used > budget
+        print(f'{name:<24}{used:>10} / {budget:<10}{flag}')
+
+    return 1 if over else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""
+Fits the thermal model used by the TCS from logged step responses, and
+writes it out as Drivers/HighLevel/Inc/tcs_model.h.
+
+Usage: tcs_sysid.py fit <log.csv> [-o tcs_model.h] [--period 1.0] [--ridge 1e-6]
+       tcs_sysid.py nominal [-o tcs_model.h]
+
+The log is a CSV with a header row and the columns
+    time, ambient, t0 .. t15, h0 .. h15
+time is in seconds, temperatures are in degrees celsius and h0 .. h15 are
+the heater duties, 0 to 1 (or the heater states, 0 or 1). Rows don't need
+to be evenly spaced; they are resampled to the model period. Step responses
+work best: heat one well (or a few) at a time from equilibrium, let it
+settle, then let it cool, so each heater's effect can be told apart.
+
+The model is x[k+1] = A x[k] + B u[k], where x is each well's temperature
+above ambient and u the heater duties. Each row of A and each entry of B is
+fitted by least squares on one-step predictions. The report gives the
+one-step error and the error of the model run open loop over the whole log,
+which is what the controller relies on.
+
+`nominal` writes a model with weak, uniform coupling, for boards that
+haven't been characterised yet.
+"""
+
+import argparse
+import csv
+import math
+import sys
+
+NUM_WELLS = 16
+Q24 = 1 << 24
+B_SCALE = 256 * 100  # B is in 1/256ths of a hundredth of a degree.
+
+NOMINAL_TAU = 600.0        # s. time constant of a well's loss to ambient.
+NOMINAL_COUPLING = 5e-5    # per s. conduction from each other well.
+NOMINAL_RISE = 20.0        # degrees above ambient at full duty, on its own.
+
+
+def load(path):
+    rows = []
+    with open(path, newline='') as f:
+        reader = csv.DictReader(f)
+        for row in reader:
+            rows.append((
+                float(row['time']),
+                float(row['ambient']),
+                [float(row['t%d' % i]) for i in range(NUM_WELLS)],
+                [float(row['h%d' % i]) for i in range(NUM_WELLS)],
+            ))
+    rows.sort(key=lambda r: r[0])
+    if len(rows) < 2:
+        sys.exit('%s: need at least 2 rows' % path)
+    return rows
+
+
+def resample(rows, period):
+    """Interpolates temperatures onto a grid, holding duties from the last row."""
+    samples = []
+    t = rows[0][0]
+    i = 0
+    while t <= rows[-1][0]:
+        while rows[i + 1][0] < t:
+            i += 1
+        t0, amb0, temps0, duty0 = rows[i]
+        t1, amb1, temps1, _ = rows[i + 1]
+        f = (t - t0) / (t1 - t0) if t1 > t0 else 0.0
+        ambient = amb0 + f * (amb1 - amb0)
+        excess = [a + f * (b - a) - ambient for a, b in zip(temps0, temps1)]
+        samples.append((excess, list(duty0)))
+        t += period
+        if i + 1 >= len(rows) - 1 and t > rows[-1][0]:
+            break
+    return samples
+
+
+def solve(m, v):
+    """Solves m x = v by Gaussian elimination with partial pivoting."""
+    n = len(v)
+    a = [row[:] + [v[i]] for i, row in enumerate(m)]
+    for col in range(n):
+        pivot = max(range(col, n), key=lambda r: abs(a[r][col]))
+        if abs(a[pivot][col]) < 1e-12:
+            sys.exit('the log does not excite every well. add a step on each heater.')
+        a[col], a[pivot] = a[pivot], a[col]
+        for r in range(col + 1, n):
+            k = a[r][col] / a[col][col]
+            for c in range(col, n + 1):
+                a[r][c] -= k * a[col][c]
+    x = [0.0] * n
+    for r in reversed(range(n)):
+        x[r] = (a[r][n] - sum(a[r][c] * x[c] for c in range(r + 1, n))) / a[r][r]
+    return x
+
+
+def fit(samples, ridge):
+    """Fits each well's row of A and its entry of B."""
+    a = []
+    b = []
+    for i in range(NUM_WELLS):
+        n = NUM_WELLS + 1
+        normal = [[0.0] * n for _ in range(n)]
+        rhs = [0.0] * n
+        for (x, u), (x_next, _) in zip(samples, samples[1:]):
+            features = x + [u[i]]
+            for r in range(n):
+                rhs[r] += features[r] * x_next[i]
+                for c in range(n):
+                    normal[r][c] += features[r] * features[c]
+        scale = max(normal[r][r] for r in range(n))
+        for r in range(n):
+            normal[r][r] += ridge * scale
+        coefficients = solve(normal, rhs)
+        a.append(coefficients[:NUM_WELLS])
+        b.append(coefficients[NUM_WELLS])
+    return a, b
+
+
+def nominal(period):
+    loss = period / NOMINAL_TAU
+    coupling = NOMINAL_COUPLING * period
+    diagonal = 1.0 - loss - (NUM_WELLS - 1) * coupling
+    a = [[diagonal if i == j else coupling for j in range(NUM_WELLS)] for i in range(NUM_WELLS)]
+    b = [NOMINAL_RISE * loss] * NUM_WELLS
+    return a, b
+
+
+def predict(a, b, x, u):
+    return [sum(a[i][j] * x[j] for j in range(NUM_WELLS)) + b[i] * u[i] for i in range(NUM_WELLS)]
+
+
+def report(a, b, samples):
+    one_step = [0.0] * NUM_WELLS
+    open_loop = [0.0] * NUM_WELLS
+    simulated = samples[0][0]
+    for (x, u), (x_next, _) in zip(samples, samples[1:]):
+        predicted = predict(a, b, x, u)
+        simulated = predict(a, b, simulated, u)
+        for i in range(NUM_WELLS):
+            one_step[i] += (predicted[i] - x_next[i]) ** 2
+            open_loop[i] += (simulated[i] - x_next[i]) ** 2
+
+    count = len(samples) - 1
+    print('well  one step rms  open loop rms  (degrees)')
+    for i in range(NUM_WELLS):
+        print('%4d  %12.3f  %13.3f' % (i, math.sqrt(one_step[i] / count), math.sqrt(open_loop[i] / count)))
+
+    worst = max(sum(abs(v) for v in row) for row in a)
+    if worst >= 1.0:
+        print('warning: a row of A sums to %.4f. the model is unstable.' % worst)
+
+
+def q24(value):
+    return int(round(value * Q24))
+
+
+def write_header(path, a, b, period, source):
+    lines = [
+        '/*',
+        ' * tcs_model.h',
+        ' *',
+        ' *  Created on: Oct 18, 2026',
+        ' *',
+        ' *  Purpose: Thermal model of the wells, used by the TCS to predict them.',
+        ' *',
+        ' *  Generated by tools/tcs_sysid.py from %s. Regenerate rather than edit.' % source,
+        ' *',
+        ' *  x[k+1] = A x[k] + B u[k], where x is each well\'s temperature above',
+        ' *  ambient in hundredths of a degree, and u each heater\'s duty, 0 to 1.',
+        ' */',
+        '',
+        '#ifndef HIGHLEVEL_INC_TCS_MODEL_H_',
+        '#define HIGHLEVEL_INC_TCS_MODEL_H_',
+        '',
+        '#define TCS_MODEL_PERIOD %d // in ms. the time step of the model.' % round(period * 1000),
+        '',
+        '// Q24. row i is how each well\'s excess temperature carries over to well i.',
+        '#define TCS_MODEL_A { \\',
+    ]
+    for row in a:
+        lines.append('\t\t{ %s }, \\' % ', '.join('%9d' % q24(v) for v in row))
+    lines += [
+        '}',
+        '',
+        '// rise of each well per step at full duty, in 1/256ths of a hundredth of a degree.',
+        '#define TCS_MODEL_B { %s }' % ', '.join('%d' % round(v * B_SCALE) for v in b),
+        '',
+        '#endif /* HIGHLEVEL_INC_TCS_MODEL_H_ */',
+        '',
+    ]
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Fits the thermal model used by the TCS.')
+    parser.add_argument('mode', choices=('fit', 'nominal'))
+    parser.add_argument('log', nargs='?', help='CSV of logged step responses (fit only)')
+    parser.add_argument('-o', '--output', default='tcs_model.h')
+    parser.add_argument('--period', type=float, default=1.0, help='model time step, in s')
+    parser.add_argument('--ridge', type=float, default=1e-6, help='regularisation, relative to the data')
+    args = parser.parse_args()
+
+    if args.mode == 'nominal':
+        a, b = nominal(args.period)
+        write_header(args.output, a, b, args.period, 'nominal parameters')
+        return 0
+
+    if args.log is None:
+        parser.error('fit needs a log')
+
+    samples = resample(load(args.log), args.period)
+    if len(samples) < 4 * (NUM_WELLS + 1):
+        sys.exit('the log is too short for %d parameters per well.' % (NUM_WELLS + 1))
+
+    a, b = fit(samples, args.ridge)
+    report(a, b, samples)
+    write_header(args.output, a, b, args.period, args.log.replace('\\', '/').split('/')[-1])
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())